@@ -0,0 +1,847 @@
+#include "ChessCore/ChessPosition.hpp"
+#include "ChessCore/ChessAttacks.hpp"
+#include "ChessCore/ChessPerft.hpp"
+#include "ChessCore/ChessMoveGen.hpp"
+#include "ChessCore/ChessNotation.hpp"
+#include "ChessCore/ChessEvaluate.hpp"
+#include "ChessCore/ChessNNUE.hpp"
+#include "ChessCore/ChessSearch.hpp"
+#include "ChessCore/ChessParallelSearch.hpp"
+#include "ChessCore/ChessTimeManager.hpp"
+#include "ChessCore/ChessPolyglotBook.hpp"
+#include "ChessCore/ChessSyzygy.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+//-----------------------------------------------------------------------------------------------
+// Headless benchmark and correctness runner for the chess rules code, no window, renderer or engine systems.
+// Every mode returns non-zero when a result does not match its reference so it can gate a build.
+constexpr int BENCH_TRANSPOSITION_TABLE_MB = 16;
+
+static double GetSecondsSince(std::chrono::steady_clock::time_point startTime)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+static void PrintUsage()
+{
+	printf("Usage:\n");
+	printf("  ChessBench perft                  run the reference perft suite\n");
+	printf("  ChessBench perft <depth> [fen]    divide counts for one position (start position without fen)\n");
+	printf("  ChessBench notation               round trip every move of the perft positions through UCI and SAN\n");
+	printf("  ChessBench eval                   incremental evaluation speed on every node 3 plies into the perft positions, checked against a rescan\n");
+	printf("  ChessBench nnue [network]         network evaluation speed against the handcrafted one, random weights without a file\n");
+	printf("  ChessBench search [depth]         fixed depth search of the perft positions (default depth 5)\n");
+	printf("  ChessBench smp [depth] [threads]  Lazy SMP time to depth for 1, 2, 4.. threads (default depth 7, all hardware threads)\n");
+	printf("  ChessBench time                   stop signal latency and time used against the budget for movetime and clock limits\n");
+	printf("  ChessBench book [book.bin]        Polyglot keys against the published ones, then lookup speed and start position moves of a book\n");
+	printf("  ChessBench syzygy <dirs>          known endgame results from the tablebases in the ';' separated directories, with probe times\n");
+}
+
+static int RunPerftSuite()
+{
+	int numFailed = 0;
+	uint64_t totalNodes = 0;
+	double totalSeconds = 0.0;
+
+	for (int caseIndex = 0; caseIndex < GetNumChessPerftCases(); ++caseIndex)
+	{
+		ChessPerftCase const& perftCase = GetChessPerftCase(caseIndex);
+		ChessPosition position;
+		if (!position.SetFromFen(perftCase.m_fen))
+		{
+			printf("%-10s  bad fen \"%s\"\n", perftCase.m_name, perftCase.m_fen);
+			numFailed++;
+			continue;
+		}
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		uint64_t nodes = RunPerft(position, perftCase.m_depth);
+		double seconds = GetSecondsSince(startTime);
+		totalNodes += nodes;
+		totalSeconds += seconds;
+
+		bool isMatch = (nodes == perftCase.m_expectedNodes);
+		if (!isMatch)
+		{
+			numFailed++;
+		}
+		printf("%-10s  depth %d  %12llu nodes  %7.3fs  %6.1f Mnps  %s\n", perftCase.m_name, perftCase.m_depth, static_cast<unsigned long long>(nodes),
+			seconds, static_cast<double>(nodes) / seconds * 1e-6, isMatch ? "ok" : "MISMATCH");
+		if (!isMatch)
+		{
+			printf("            expected %llu\n", static_cast<unsigned long long>(perftCase.m_expectedNodes));
+		}
+	}
+
+	printf("total %llu nodes in %.3fs, %.1f Mnps, %d failed\n", static_cast<unsigned long long>(totalNodes), totalSeconds,
+		static_cast<double>(totalNodes) / totalSeconds * 1e-6, numFailed);
+	return (numFailed == 0) ? 0 : 1;
+}
+
+static int RunPerftDivideForFen(int depth, std::string const& fen)
+{
+	ChessPosition position;
+	if (!position.SetFromFen(fen))
+	{
+		printf("bad fen \"%s\"\n", fen.c_str());
+		return 1;
+	}
+
+	ChessMoveList rootMoves;
+	uint64_t nodesPerMove[MAX_CHESS_MOVES];
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	uint64_t nodes = RunPerftDivide(position, depth, rootMoves, nodesPerMove);
+	double seconds = GetSecondsSince(startTime);
+
+	char moveText[MAX_UCI_MOVE_LENGTH];
+	for (int moveIndex = 0; moveIndex < rootMoves.GetCount(); ++moveIndex)
+	{
+		WriteUciMove(rootMoves[moveIndex], moveText, MAX_UCI_MOVE_LENGTH);
+		printf("%s: %llu\n", moveText, static_cast<unsigned long long>(nodesPerMove[moveIndex]));
+	}
+	printf("\nmoves %d\nnodes %llu\ntime %.3fs\nnps %.0f\n", rootMoves.GetCount(), static_cast<unsigned long long>(nodes), seconds,
+		(seconds > 0.0) ? static_cast<double>(nodes) / seconds : 0.0);
+	return 0;
+}
+
+static int RunPerftMode(int argc, char** argv)
+{
+	if (argc == 0)
+	{
+		return RunPerftSuite();
+	}
+
+	int depth = atoi(argv[0]);
+	if (depth < 1)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	// the fen may arrive as one quoted argument or split on its spaces
+	std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+	if (argc > 1)
+	{
+		fen = argv[1];
+		for (int argIndex = 2; argIndex < argc; ++argIndex)
+		{
+			fen += " ";
+			fen += argv[argIndex];
+		}
+	}
+	return RunPerftDivideForFen(depth, fen);
+}
+
+// Walks the perft positions a few plies deep and checks every legal move survives text and back in both notations
+static void CountNotationRoundTrips(ChessPosition& position, int depth, uint64_t& out_numConversions, int& out_numFailed)
+{
+	ChessMoveList legalMoves;
+	GenerateLegalMoves(position, legalMoves);
+
+	char uciText[MAX_UCI_MOVE_LENGTH];
+	char sanText[MAX_SAN_MOVE_LENGTH];
+	for (ChessMove const& move : legalMoves)
+	{
+		ChessMove uciMove;
+		ChessMove sanMove;
+		int uciLength = WriteUciMove(move, uciText, MAX_UCI_MOVE_LENGTH);
+		int sanLength = WriteSanMove(position, move, legalMoves, sanText, MAX_SAN_MOVE_LENGTH);
+		bool isUciMatch = ParseUciMove(std::string_view(uciText, uciLength), legalMoves, uciMove) && uciMove == move;
+		bool isSanMatch = ParseSanMove(position, std::string_view(sanText, sanLength), legalMoves, sanMove) && sanMove == move;
+		out_numConversions += 4;
+		if (!isUciMatch || !isSanMatch)
+		{
+			char fen[MAX_FEN_LENGTH];
+			position.WriteFen(fen, MAX_FEN_LENGTH);
+			printf("MISMATCH uci \"%s\" san \"%s\" in %s\n", uciText, sanText, fen);
+			out_numFailed++;
+		}
+	}
+
+	if (depth <= 1)
+	{
+		return;
+	}
+	for (ChessMove const& move : legalMoves)
+	{
+		ChessUndoInfo undo;
+		position.MakeMove(move, undo);
+		CountNotationRoundTrips(position, depth - 1, out_numConversions, out_numFailed);
+		position.UnmakeMove(move, undo);
+	}
+}
+
+static int RunNotationSuite()
+{
+	int numFailed = 0;
+	uint64_t totalConversions = 0;
+	double totalSeconds = 0.0;
+
+	for (int caseIndex = 0; caseIndex < GetNumChessPerftCases(); ++caseIndex)
+	{
+		ChessPerftCase const& perftCase = GetChessPerftCase(caseIndex);
+		ChessPosition position;
+		if (!position.SetFromFen(perftCase.m_fen))
+		{
+			printf("%-10s  bad fen \"%s\"\n", perftCase.m_name, perftCase.m_fen);
+			numFailed++;
+			continue;
+		}
+
+		uint64_t numConversions = 0;
+		int numCaseFailed = 0;
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		CountNotationRoundTrips(position, 3, numConversions, numCaseFailed);
+		double seconds = GetSecondsSince(startTime);
+		totalConversions += numConversions;
+		totalSeconds += seconds;
+		numFailed += numCaseFailed;
+
+		printf("%-10s  %10llu conversions  %7.3fs  %6.2f M/s  %s\n", perftCase.m_name, static_cast<unsigned long long>(numConversions),
+			seconds, static_cast<double>(numConversions) / seconds * 1e-6, (numCaseFailed == 0) ? "ok" : "MISMATCH");
+	}
+
+	printf("total %llu conversions in %.3fs, %.2f M/s, %d failed\n", static_cast<unsigned long long>(totalConversions), totalSeconds,
+		static_cast<double>(totalConversions) / totalSeconds * 1e-6, numFailed);
+	return (numFailed == 0) ? 0 : 1;
+}
+
+static void CollectPositions(ChessPosition& position, int depth, std::vector<ChessPosition>& out_positions)
+{
+	out_positions.push_back(position);
+	if (depth <= 0)
+	{
+		return;
+	}
+
+	ChessMoveList legalMoves;
+	GenerateLegalMoves(position, legalMoves);
+	for (ChessMove const& move : legalMoves)
+	{
+		ChessUndoInfo undo;
+		position.MakeMove(move, undo);
+		CollectPositions(position, depth - 1, out_positions);
+		position.UnmakeMove(move, undo);
+	}
+}
+
+// Positions reached through MakeMove/UnmakeMove, so the incremental sums are the ones the search would see
+static int RunEvalSuite()
+{
+	constexpr int NUM_EVAL_PASSES = 20;
+	int numFailed = 0;
+	uint64_t totalEvals = 0;
+	double totalSeconds = 0.0;
+	double totalRescanSeconds = 0.0;
+	int64_t checksum = 0;
+
+	for (int caseIndex = 0; caseIndex < GetNumChessPerftCases(); ++caseIndex)
+	{
+		ChessPerftCase const& perftCase = GetChessPerftCase(caseIndex);
+		ChessPosition position;
+		if (!position.SetFromFen(perftCase.m_fen))
+		{
+			printf("%-10s  bad fen \"%s\"\n", perftCase.m_name, perftCase.m_fen);
+			numFailed++;
+			continue;
+		}
+		std::vector<ChessPosition> positions;
+		CollectPositions(position, 3, positions);
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		for (int passIndex = 0; passIndex < NUM_EVAL_PASSES; ++passIndex)
+		{
+			for (ChessPosition const& evalPosition : positions)
+			{
+				checksum += EvaluatePosition(evalPosition);
+			}
+		}
+		double seconds = GetSecondsSince(startTime);
+
+		int numCaseFailed = 0;
+		startTime = std::chrono::steady_clock::now();
+		for (ChessPosition const& evalPosition : positions)
+		{
+			ChessEvalBreakdown breakdown;
+			ComputeEvalBreakdown(evalPosition, breakdown);
+			int sideScore = (evalPosition.m_sideToMove == PLAYER_WHITE) ? breakdown.m_whiteScore : -breakdown.m_whiteScore;
+			if (!breakdown.m_isIncrementalInSync || sideScore != EvaluatePosition(evalPosition))
+			{
+				numCaseFailed++;
+			}
+		}
+		double rescanSeconds = GetSecondsSince(startTime);
+
+		uint64_t numEvals = static_cast<uint64_t>(positions.size()) * NUM_EVAL_PASSES;
+		totalEvals += numEvals;
+		totalSeconds += seconds;
+		totalRescanSeconds += rescanSeconds * NUM_EVAL_PASSES;
+		numFailed += numCaseFailed;
+		printf("%-10s  %8llu positions  %8.1f Mevals/s  rescan %6.1f Mevals/s  %s\n", perftCase.m_name, static_cast<unsigned long long>(positions.size()),
+			static_cast<double>(numEvals) / seconds * 1e-6, static_cast<double>(positions.size()) / rescanSeconds * 1e-6, (numCaseFailed == 0) ? "ok" : "MISMATCH");
+	}
+
+	printf("total %llu evals in %.3fs, %.1f Mevals/s (rescan %.1f Mevals/s), checksum %lld, %d failed\n", static_cast<unsigned long long>(totalEvals), totalSeconds,
+		static_cast<double>(totalEvals) / totalSeconds * 1e-6, static_cast<double>(totalEvals) / totalRescanSeconds * 1e-6, static_cast<long long>(checksum), numFailed);
+	return (numFailed == 0) ? 0 : 1;
+}
+
+// Walks the tree with one accumulator per ply like the search does, checking each against a full refresh
+static void WalkNetworkUpdates(ChessNNUENetwork const& network, ChessPosition& position, ChessNNUEAccumulator* accumulators, int ply, int depth,
+	bool isChecking, int64_t& out_checksum, uint64_t& out_numEvals, int& out_numFailed)
+{
+	out_checksum += network.Evaluate(accumulators[ply], position.m_sideToMove);
+	out_numEvals++;
+	if (isChecking)
+	{
+		ChessNNUEAccumulator refreshed;
+		network.RefreshAccumulator(position, refreshed);
+		if (memcmp(&refreshed, &accumulators[ply], sizeof(ChessNNUEAccumulator)) != 0)
+		{
+			out_numFailed++;
+		}
+	}
+	if (ply >= depth)
+	{
+		return;
+	}
+
+	ChessMoveList legalMoves;
+	GenerateLegalMoves(position, legalMoves);
+	for (ChessMove const& move : legalMoves)
+	{
+		ChessUndoInfo undo;
+		network.UpdateAccumulator(accumulators[ply], position, move, accumulators[ply + 1]);
+		position.MakeMove(move, undo);
+		WalkNetworkUpdates(network, position, accumulators, ply + 1, depth, isChecking, out_checksum, out_numEvals, out_numFailed);
+		position.UnmakeMove(move, undo);
+	}
+}
+
+static int RunNetworkSuite(char const* networkPath)
+{
+	ChessNNUENetwork* network = new ChessNNUENetwork();
+	if (networkPath != nullptr)
+	{
+		std::string errorMessage;
+		if (!network->LoadFromFile(networkPath, errorMessage))
+		{
+			printf("%s\n", errorMessage.c_str());
+			delete network;
+			return 1;
+		}
+	}
+	else
+	{
+		network->InitializeRandom(0x4E4E5545ULL);
+	}
+	printf("network %s, simd level %d\n", (networkPath != nullptr) ? networkPath : "random", CHESS_NNUE_SIMD);
+
+	constexpr int NETWORK_WALK_DEPTH = 3;
+	int numFailed = 0;
+	int64_t checksum = 0;
+	double totalHandcraftedRate = 0.0;
+	double totalRefreshRate = 0.0;
+	double totalIncrementalRate = 0.0;
+	ChessNNUEAccumulator accumulators[NETWORK_WALK_DEPTH + 1];
+
+	for (int caseIndex = 0; caseIndex < GetNumChessPerftCases(); ++caseIndex)
+	{
+		ChessPerftCase const& perftCase = GetChessPerftCase(caseIndex);
+		ChessPosition position;
+		if (!position.SetFromFen(perftCase.m_fen))
+		{
+			printf("%-10s  bad fen \"%s\"\n", perftCase.m_name, perftCase.m_fen);
+			numFailed++;
+			continue;
+		}
+		std::vector<ChessPosition> positions;
+		CollectPositions(position, NETWORK_WALK_DEPTH, positions);
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		for (ChessPosition const& evalPosition : positions)
+		{
+			checksum += EvaluatePosition(evalPosition);
+		}
+		double handcraftedSeconds = GetSecondsSince(startTime);
+
+		startTime = std::chrono::steady_clock::now();
+		for (ChessPosition const& evalPosition : positions)
+		{
+			network->RefreshAccumulator(evalPosition, accumulators[0]);
+			checksum += network->Evaluate(accumulators[0], evalPosition.m_sideToMove);
+		}
+		double refreshSeconds = GetSecondsSince(startTime);
+
+		// timed without the refresh check, which would swamp it
+		uint64_t numEvals = 0;
+		int numCaseFailed = 0;
+		network->RefreshAccumulator(position, accumulators[0]);
+		startTime = std::chrono::steady_clock::now();
+		WalkNetworkUpdates(*network, position, accumulators, 0, NETWORK_WALK_DEPTH, false, checksum, numEvals, numCaseFailed);
+		double incrementalSeconds = GetSecondsSince(startTime);
+		numEvals = 0;
+		WalkNetworkUpdates(*network, position, accumulators, 0, NETWORK_WALK_DEPTH, true, checksum, numEvals, numCaseFailed);
+		numFailed += numCaseFailed;
+
+		double numPositions = static_cast<double>(positions.size());
+		double handcraftedRate = numPositions / handcraftedSeconds * 1e-6;
+		double refreshRate = numPositions / refreshSeconds * 1e-6;
+		double incrementalRate = static_cast<double>(numEvals) / incrementalSeconds * 1e-6;
+		totalHandcraftedRate += handcraftedRate;
+		totalRefreshRate += refreshRate;
+		totalIncrementalRate += incrementalRate;
+		printf("%-10s  %8llu positions  handcrafted %7.1f  network refresh %6.2f  incremental %6.2f Mevals/s  %s\n", perftCase.m_name,
+			static_cast<unsigned long long>(positions.size()), handcraftedRate, refreshRate, incrementalRate, (numCaseFailed == 0) ? "ok" : "MISMATCH");
+	}
+
+	double numCases = static_cast<double>(GetNumChessPerftCases());
+	printf("average handcrafted %.1f, network refresh %.2f, incremental %.2f Mevals/s (incremental includes MakeMove), checksum %lld, %d failed\n",
+		totalHandcraftedRate / numCases, totalRefreshRate / numCases, totalIncrementalRate / numCases, static_cast<long long>(checksum), numFailed);
+	delete network;
+	return (numFailed == 0) ? 0 : 1;
+}
+
+static int RunSearchSuite(int depth)
+{
+	static ChessSearch s_search; // too big for the stack on some platforms
+	ChessTranspositionTable table;
+	table.Resize(BENCH_TRANSPOSITION_TABLE_MB);
+	s_search.SetTranspositionTable(&table);
+
+	int numFailed = 0;
+	uint64_t totalNodes = 0;
+	uint64_t totalBetaCutoffs = 0;
+	uint64_t totalFirstMoveCutoffs = 0;
+	double totalSeconds = 0.0;
+
+	for (int caseIndex = 0; caseIndex < GetNumChessPerftCases(); ++caseIndex)
+	{
+		ChessPerftCase const& perftCase = GetChessPerftCase(caseIndex);
+		ChessPosition position;
+		if (!position.SetFromFen(perftCase.m_fen))
+		{
+			printf("%-10s  bad fen \"%s\"\n", perftCase.m_name, perftCase.m_fen);
+			numFailed++;
+			continue;
+		}
+
+		// every position starts cold so node counts don't depend on the order of the cases
+		table.Clear();
+		table.NewSearch();
+		ChessSearchLimits limits;
+		limits.m_maxDepth = depth;
+		ChessSearchResult result = s_search.Search(position, nullptr, 0, limits);
+		totalNodes += result.m_nodes;
+		totalSeconds += result.m_seconds;
+		totalBetaCutoffs += result.m_numBetaCutoffs;
+		totalFirstMoveCutoffs += result.m_numFirstMoveCutoffs;
+
+		ChessMoveList legalMoves;
+		GenerateLegalMoves(position, legalMoves);
+		bool isLegal = legalMoves.Contains(result.m_bestMove) && result.m_depth == depth;
+		if (!isLegal)
+		{
+			numFailed++;
+		}
+
+		char pvText[MAX_SEARCH_PLY * MAX_UCI_MOVE_LENGTH] = {};
+		int pvTextLength = 0;
+		for (int pvIndex = 0; pvIndex < result.m_pvLength; ++pvIndex)
+		{
+			pvTextLength += WriteUciMove(result.m_pv[pvIndex], pvText + pvTextLength, MAX_UCI_MOVE_LENGTH);
+			pvText[pvTextLength++] = ' ';
+		}
+		pvText[(pvTextLength > 0) ? pvTextLength - 1 : 0] = '\0';
+
+		printf("%-10s  depth %d  score %6d  %10llu nodes  %7.3fs  %6.2f Mnps  hashfull %4d  fmc %5.1f%%  %s  pv %s\n", perftCase.m_name, result.m_depth,
+			result.m_score, static_cast<unsigned long long>(result.m_nodes), result.m_seconds, static_cast<double>(result.m_nodes) / result.m_seconds * 1e-6,
+			result.m_hashfullPermille, result.GetFirstMoveCutoffPercent(), isLegal ? "ok" : "BAD MOVE", pvText);
+	}
+
+	printf("total %llu nodes in %.3fs, %.2f Mnps, first move cutoffs %.1f%%, %d failed\n", static_cast<unsigned long long>(totalNodes), totalSeconds,
+		static_cast<double>(totalNodes) / totalSeconds * 1e-6, (totalBetaCutoffs > 0) ? 100.0 * static_cast<double>(totalFirstMoveCutoffs) / static_cast<double>(totalBetaCutoffs) : 0.0,
+		numFailed);
+	return (numFailed == 0) ? 0 : 1;
+}
+
+// Time for the main thread to reach a fixed depth on every perft position, so thread counts compare like for like
+static int RunSmpCase(ChessParallelSearch& search, ChessTranspositionTable& table, int depth, double& out_seconds, uint64_t& out_nodes)
+{
+	int numFailed = 0;
+	out_seconds = 0.0;
+	out_nodes = 0;
+	for (int caseIndex = 0; caseIndex < GetNumChessPerftCases(); ++caseIndex)
+	{
+		ChessPerftCase const& perftCase = GetChessPerftCase(caseIndex);
+		ChessPosition position;
+		position.SetFromFen(perftCase.m_fen);
+
+		table.Clear();
+		table.NewSearch();
+		ChessSearchLimits limits;
+		limits.m_maxDepth = depth;
+		ChessSearchResult result = search.Search(position, nullptr, 0, limits);
+		out_seconds += result.m_seconds;
+		out_nodes += result.m_nodes;
+
+		ChessMoveList legalMoves;
+		GenerateLegalMoves(position, legalMoves);
+		if (!legalMoves.Contains(result.m_bestMove) || result.m_depth < depth)
+		{
+			printf("%-10s  BAD RESULT with %d threads, depth %d\n", perftCase.m_name, search.GetNumThreads(), result.m_depth);
+			numFailed++;
+		}
+	}
+	return numFailed;
+}
+
+static int RunSmpSuite(int depth, int maxThreads)
+{
+	ChessTranspositionTable table;
+	table.Resize(BENCH_TRANSPOSITION_TABLE_MB * 4);
+	ChessParallelSearch search;
+	search.SetTranspositionTable(&table);
+
+	int numFailed = 0;
+	double singleThreadSeconds = 0.0;
+	for (int numThreads = 1; ; numThreads = (numThreads * 2 < maxThreads) ? numThreads * 2 : maxThreads)
+	{
+		search.SetNumThreads(numThreads);
+		double seconds = 0.0;
+		uint64_t nodes = 0;
+		numFailed += RunSmpCase(search, table, depth, seconds, nodes);
+		if (numThreads == 1)
+		{
+			singleThreadSeconds = seconds;
+		}
+		printf("threads %3d  depth %d  %7.3fs  speedup %5.2fx  %12llu nodes  %7.2f Mnps\n", numThreads, depth, seconds, singleThreadSeconds / seconds,
+			static_cast<unsigned long long>(nodes), static_cast<double>(nodes) / seconds * 1e-6);
+		if (numThreads == maxThreads)
+		{
+			break;
+		}
+	}
+
+	printf("%d failed\n", numFailed);
+	return (numFailed == 0) ? 0 : 1;
+}
+
+// Runs until the stop signal, raised from this thread after a while, and returns how long the search took to notice
+static double MeasureStopLatencyMs(ChessSearch& search, ChessPosition const& position)
+{
+	std::atomic<bool> stopSignal = false;
+	ChessSearchLimits limits;
+	limits.m_stopSignal = &stopSignal;
+	std::thread searchThread([&search, &position, &limits]()
+	{
+		search.Search(position, nullptr, 0, limits);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	std::chrono::steady_clock::time_point stopTime = std::chrono::steady_clock::now();
+	stopSignal = true;
+	searchThread.join();
+	return GetSecondsSince(stopTime) * 1000.0;
+}
+
+static double MeasureSearchMs(ChessSearch& search, ChessPosition const& position, ChessSearchLimits const& limits)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	search.Search(position, nullptr, 0, limits);
+	return GetSecondsSince(startTime) * 1000.0;
+}
+
+static int RunTimeSuite()
+{
+	static ChessSearch s_search;
+	ChessTranspositionTable table;
+	table.Resize(BENCH_TRANSPOSITION_TABLE_MB);
+	s_search.SetTranspositionTable(&table);
+
+	// a move is late only once it eats into the overhead the budget keeps back for delivering it
+	constexpr int MOVE_TIME_MS = 200;
+	constexpr int CLOCK_MS = 3000;
+	constexpr int INCREMENT_MS = 50;
+
+	int numFailed = 0;
+	double maxStopLatencyMs = 0.0;
+	double totalStopLatencyMs = 0.0;
+	for (int caseIndex = 0; caseIndex < GetNumChessPerftCases(); ++caseIndex)
+	{
+		ChessPerftCase const& perftCase = GetChessPerftCase(caseIndex);
+		ChessPosition position;
+		position.SetFromFen(perftCase.m_fen);
+		table.Clear();
+
+		double stopLatencyMs = MeasureStopLatencyMs(s_search, position);
+		maxStopLatencyMs = (stopLatencyMs > maxStopLatencyMs) ? stopLatencyMs : maxStopLatencyMs;
+		totalStopLatencyMs += stopLatencyMs;
+
+		ChessSearchLimits moveTimeLimits;
+		moveTimeLimits.m_moveTimeMs = MOVE_TIME_MS;
+		double moveTimeMs = MeasureSearchMs(s_search, position, moveTimeLimits);
+
+		ChessSearchLimits clockLimits;
+		clockLimits.m_timeLeftMs[position.m_sideToMove] = CLOCK_MS;
+		clockLimits.m_incrementMs[position.m_sideToMove] = INCREMENT_MS;
+		ChessTimeBudget clockBudget = GetTimeBudget(clockLimits, position.m_sideToMove);
+		double clockMs = MeasureSearchMs(s_search, position, clockLimits);
+
+		bool isLate = stopLatencyMs > TIME_MOVE_OVERHEAD_MS || moveTimeMs > MOVE_TIME_MS || clockMs > clockBudget.m_hardMs + TIME_MOVE_OVERHEAD_MS;
+		if (isLate)
+		{
+			numFailed++;
+		}
+		printf("%-10s  stop latency %6.3fms  movetime %dms used %7.1fms  clock %dms+%dms budget %d/%dms used %7.1fms  %s\n", perftCase.m_name, stopLatencyMs,
+			MOVE_TIME_MS, moveTimeMs, CLOCK_MS, INCREMENT_MS, clockBudget.m_softMs, clockBudget.m_hardMs, clockMs, isLate ? "LATE" : "ok");
+	}
+
+	printf("stop latency average %.3fms, max %.3fms, %d failed\n", totalStopLatencyMs / GetNumChessPerftCases(), maxStopLatencyMs, numFailed);
+	return (numFailed == 0) ? 0 : 1;
+}
+
+// Keys from the Polyglot format description, the start position then e4 d5 e5 f5 Ke2 Kf7, and a4 b5 h4 b4 c4 bxc3 Ra3
+struct PolyglotKeyCase
+{
+	char const*	m_fen;
+	uint64_t	m_key;
+};
+
+static PolyglotKeyCase const POLYGLOT_KEY_CASES[] =
+{
+	{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",			0x463B96181691FC9CULL },
+	{ "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1",		0x823C9B50FD114196ULL },
+	{ "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2",		0x0756B94461C50FB0ULL },
+	{ "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2",		0x662FAFB965DB29D4ULL },
+	{ "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",		0x22A48B5A8E47FF78ULL },
+	{ "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3",			0x652A607CA3F242C1ULL },
+	{ "rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4",			0x00FDD303C946BDD9ULL },
+	{ "rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3",		0x3C8123EA7B067637ULL },
+	{ "rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4",		0x5C3F9B829B279560ULL },
+};
+
+static int RunBookSuite(char const* bookPath)
+{
+	int numFailed = 0;
+	for (PolyglotKeyCase const& keyCase : POLYGLOT_KEY_CASES)
+	{
+		ChessPosition position;
+		uint64_t key = position.SetFromFen(keyCase.m_fen) ? GetPolyglotKey(position) : 0;
+		if (key != keyCase.m_key)
+		{
+			printf("key %016llx, expected %016llx for %s\n", static_cast<unsigned long long>(key), static_cast<unsigned long long>(keyCase.m_key), keyCase.m_fen);
+			numFailed++;
+		}
+	}
+	printf("%d Polyglot keys checked, %d failed\n", static_cast<int>(sizeof(POLYGLOT_KEY_CASES) / sizeof(POLYGLOT_KEY_CASES[0])), numFailed);
+	if (bookPath == nullptr)
+	{
+		return (numFailed == 0) ? 0 : 1;
+	}
+
+	ChessPolyglotBook book;
+	std::string errorMessage;
+	std::chrono::steady_clock::time_point openTime = std::chrono::steady_clock::now();
+	if (!book.Open(bookPath, errorMessage))
+	{
+		printf("%s\n", errorMessage.c_str());
+		return 1;
+	}
+	printf("%llu entries mapped in %.3fms\n", static_cast<unsigned long long>(book.GetNumEntries()), GetSecondsSince(openTime) * 1000.0);
+
+	ChessPosition startPosition;
+	startPosition.SetToStartingPosition();
+	ChessBookMove bookMoves[MAX_CHESS_BOOK_MOVES];
+	int numBookMoves = book.FindMoves(startPosition, bookMoves, MAX_CHESS_BOOK_MOVES);
+	for (int moveIndex = 0; moveIndex < numBookMoves; ++moveIndex)
+	{
+		char moveText[MAX_UCI_MOVE_LENGTH];
+		WriteUciMove(bookMoves[moveIndex].m_move, moveText, MAX_UCI_MOVE_LENGTH);
+		printf("  %-6s weight %d\n", moveText, bookMoves[moveIndex].m_weight);
+	}
+
+	// lookups of positions a few plies into the perft set, most of them miss so this is the binary search cost
+	std::vector<ChessPosition> positions;
+	for (int caseIndex = 0; caseIndex < GetNumChessPerftCases(); ++caseIndex)
+	{
+		ChessPosition position;
+		position.SetFromFen(GetChessPerftCase(caseIndex).m_fen);
+		CollectPositions(position, 2, positions);
+	}
+	int numHits = 0;
+	std::chrono::steady_clock::time_point lookupTime = std::chrono::steady_clock::now();
+	for (ChessPosition const& position : positions)
+	{
+		numHits += (book.FindMoves(position, bookMoves, MAX_CHESS_BOOK_MOVES) > 0) ? 1 : 0;
+	}
+	double lookupSeconds = GetSecondsSince(lookupTime);
+	printf("%d lookups, %d hits, %.2fus per lookup\n", static_cast<int>(positions.size()), numHits, lookupSeconds * 1e6 / static_cast<double>(positions.size()));
+	return (numFailed == 0) ? 0 : 1;
+}
+
+// Endings whose result is known without tables. Cases whose tables are missing are skipped, not failed.
+struct SyzygyWdlCase
+{
+	char const*	m_fen;
+	ChessWdl	m_wdl;
+};
+
+static SyzygyWdlCase const SYZYGY_WDL_CASES[] =
+{
+	{ "8/8/8/8/8/8/1Q6/K6k w - - 0 1",		WDL_WIN },
+	{ "8/8/8/8/8/8/1Q6/K6k b - - 0 1",		WDL_LOSS },
+	{ "8/8/8/4k3/8/8/8/KR6 w - - 0 1",		WDL_WIN },
+	{ "8/8/8/4k3/8/8/8/KR6 b - - 0 1",		WDL_LOSS },
+	{ "8/8/8/4k3/8/8/8/KB6 w - - 0 1",		WDL_DRAW },
+	{ "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1",	WDL_WIN },
+	{ "4k3/8/4K3/4P3/8/8/8/8 b - - 0 1",	WDL_LOSS },
+	{ "4k3/4P3/4K3/8/8/8/8/8 b - - 0 1",	WDL_DRAW }, // stalemate
+};
+
+static int RunSyzygySuite(char const* directories)
+{
+	ChessSyzygyTablebases tablebases;
+	std::chrono::steady_clock::time_point scanTime = std::chrono::steady_clock::now();
+	int numTables = tablebases.Initialize(directories);
+	printf("%d tables up to %d pieces found in %.3fms\n", numTables, tablebases.GetMaxPieces(), GetSecondsSince(scanTime) * 1000.0);
+	if (numTables == 0)
+	{
+		return 1;
+	}
+
+	int numFailed = 0;
+	int numSkipped = 0;
+	for (SyzygyWdlCase const& wdlCase : SYZYGY_WDL_CASES)
+	{
+		ChessPosition position;
+		if (!position.SetFromFen(wdlCase.m_fen))
+		{
+			printf("%-36s  bad fen\n", wdlCase.m_fen);
+			numFailed++;
+			continue;
+		}
+		ChessWdl wdl = WDL_DRAW;
+		std::chrono::steady_clock::time_point probeTime = std::chrono::steady_clock::now();
+		if (!tablebases.ProbeWdl(position, wdl))
+		{
+			printf("%-36s  no table\n", wdlCase.m_fen);
+			numSkipped++;
+			continue;
+		}
+		double firstProbeMs = GetSecondsSince(probeTime) * 1000.0; // maps the file on first use
+
+		constexpr int NUM_REPEATS = 1000;
+		probeTime = std::chrono::steady_clock::now();
+		for (int repeat = 0; repeat < NUM_REPEATS; ++repeat)
+		{
+			tablebases.ProbeWdl(position, wdl);
+		}
+		double probeUs = GetSecondsSince(probeTime) * 1e6 / NUM_REPEATS;
+
+		bool isCorrect = wdl == wdlCase.m_wdl;
+		numFailed += isCorrect ? 0 : 1;
+		printf("%-36s  wdl %2d expected %2d  first probe %7.3fms, then %6.2fus  %s\n", wdlCase.m_fen, wdl, wdlCase.m_wdl, firstProbeMs, probeUs, isCorrect ? "ok" : "FAILED");
+	}
+
+	// Ra8 is the only mate in one, and the only move with a DTZ of one ply
+	char const* MATE_IN_ONE_FEN = "6k1/8/6K1/8/8/8/8/R7 w - - 0 1";
+	ChessPosition matePosition;
+	ChessMove rootMove = ChessMove::None();
+	ChessWdl rootWdl = WDL_DRAW;
+	int rootDtz = 0;
+	if (!matePosition.SetFromFen(MATE_IN_ONE_FEN))
+	{
+		printf("%-36s  bad fen\n", MATE_IN_ONE_FEN);
+		numFailed++;
+	}
+	else if (tablebases.ProbeRoot(matePosition, rootMove, rootWdl, rootDtz))
+	{
+		char moveText[MAX_UCI_MOVE_LENGTH];
+		WriteUciMove(rootMove, moveText, MAX_UCI_MOVE_LENGTH);
+		bool isCorrect = strcmp(moveText, "a1a8") == 0 && rootWdl == WDL_WIN && rootDtz == 1;
+		numFailed += isCorrect ? 0 : 1;
+		printf("root probe of mate in one: %s wdl %d dtz %d  %s\n", moveText, rootWdl, rootDtz, isCorrect ? "ok" : "FAILED");
+	}
+	else
+	{
+		printf("root probe of mate in one: no table\n");
+		numSkipped++;
+	}
+
+	printf("%d failed, %d skipped\n", numFailed, numSkipped);
+	return (numFailed == 0) ? 0 : 1;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	InitializeChessAttackTables();
+
+	if (strcmp(argv[1], "perft") == 0)
+	{
+		return RunPerftMode(argc - 2, argv + 2);
+	}
+	if (strcmp(argv[1], "notation") == 0)
+	{
+		return RunNotationSuite();
+	}
+	if (strcmp(argv[1], "eval") == 0)
+	{
+		return RunEvalSuite();
+	}
+	if (strcmp(argv[1], "nnue") == 0)
+	{
+		return RunNetworkSuite((argc > 2) ? argv[2] : nullptr);
+	}
+	if (strcmp(argv[1], "search") == 0)
+	{
+		int depth = (argc > 2) ? atoi(argv[2]) : 5;
+		if (depth < 1)
+		{
+			PrintUsage();
+			return 1;
+		}
+		return RunSearchSuite(depth);
+	}
+	if (strcmp(argv[1], "smp") == 0)
+	{
+		int depth = (argc > 2) ? atoi(argv[2]) : 7;
+		int maxThreads = (argc > 3) ? atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency());
+		if (depth < 1)
+		{
+			PrintUsage();
+			return 1;
+		}
+		return RunSmpSuite(depth, (maxThreads > 0) ? maxThreads : 1);
+	}
+	if (strcmp(argv[1], "time") == 0)
+	{
+		return RunTimeSuite();
+	}
+	if (strcmp(argv[1], "book") == 0)
+	{
+		return RunBookSuite((argc > 2) ? argv[2] : nullptr);
+	}
+	if (strcmp(argv[1], "syzygy") == 0 && argc > 2)
+	{
+		return RunSyzygySuite(argv[2]);
+	}
+
+	PrintUsage();
+	return 1;
+}
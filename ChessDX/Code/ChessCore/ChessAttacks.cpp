@@ -0,0 +1,117 @@
+#include "ChessCore/ChessAttacks.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+ChessMagicEntry g_rookMagics[NUM_SQUARES];
+ChessMagicEntry g_bishopMagics[NUM_SQUARES];
+
+// Every square gets 2^(relevant bits) slots, 102400 for rooks and 5248 for bishops in total
+static Bitboard s_rookAttackTable[0x19000];
+static Bitboard s_bishopAttackTable[0x1480];
+
+
+//-----------------------------------------------------------------------------------------------
+static Bitboard GetSlowSliderAttacks(ChessRayDirection const* directions, int square, Bitboard occupied)
+{
+	Bitboard result = 0;
+	for (int directionIndex = 0; directionIndex < 4; ++directionIndex)
+	{
+		result |= GetRayAttacks(directions[directionIndex], square, occupied);
+	}
+	return result;
+}
+
+#if !CHESS_USE_PEXT
+// xorshift64*, fixed seeds so the magics found are the same on every run
+static uint64_t GetNextMagicCandidate(uint64_t& state)
+{
+	uint64_t randomBits[3];
+	for (int index = 0; index < 3; ++index)
+	{
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		randomBits[index] = state * 2685821657736338717ULL;
+	}
+	// magics with few set bits are found much faster
+	return randomBits[0] & randomBits[1] & randomBits[2];
+}
+#endif
+
+static void InitializeSliderTable(ChessMagicEntry* entries, Bitboard* table, ChessRayDirection const* directions)
+{
+	Bitboard occupancies[4096];
+	Bitboard references[4096];
+#if !CHESS_USE_PEXT
+	int epochs[4096] = {}; // attempt that last wrote each slot, saves clearing the slice between attempts
+	int attempt = 0;
+	// per rank seeds that happen to converge quickly, init stays in the millisecond range
+	static uint64_t const MAGIC_SEEDS[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+#endif
+	int tableSize = 0;
+
+	for (int square = 0; square < NUM_SQUARES; ++square)
+	{
+		// the last square of a ray never changes the attack set, so board edges are not relevant blockers
+		int file = GetFileOfSquare(square);
+		int rank = GetRankOfSquare(square);
+		Bitboard edges = ((RANK_1_MASK | RANK_8_MASK) & ~(RANK_1_MASK << (8 * rank))) | ((FILE_A_MASK | FILE_H_MASK) & ~(FILE_A_MASK << file));
+
+		ChessMagicEntry& entry = entries[square];
+		entry.m_mask = GetSlowSliderAttacks(directions, square, 0) & ~edges;
+		entry.m_shift = 64 - GetBitCount(entry.m_mask);
+		entry.m_attacks = table + tableSize;
+
+		// enumerate every subset of the mask (carry-rippler)
+		int numSubsets = 0;
+		Bitboard subset = 0;
+		do
+		{
+			occupancies[numSubsets] = subset;
+			references[numSubsets] = GetSlowSliderAttacks(directions, square, subset);
+			numSubsets++;
+			subset = (subset - entry.m_mask) & entry.m_mask;
+		} while (subset);
+		tableSize += numSubsets;
+
+#if CHESS_USE_PEXT
+		for (int subsetIndex = 0; subsetIndex < numSubsets; ++subsetIndex)
+		{
+			entry.m_attacks[entry.GetIndex(occupancies[subsetIndex])] = references[subsetIndex];
+		}
+#else
+		// Try candidates until one maps every subset without a destructive collision
+		uint64_t randomState = MAGIC_SEEDS[rank];
+		for (int subsetIndex = 0; subsetIndex < numSubsets; )
+		{
+			do
+			{
+				entry.m_magic = GetNextMagicCandidate(randomState);
+			} while (GetBitCount((entry.m_mask * entry.m_magic) >> 56) < 6);
+
+			attempt++;
+			for (subsetIndex = 0; subsetIndex < numSubsets; ++subsetIndex)
+			{
+				unsigned int index = entry.GetIndex(occupancies[subsetIndex]);
+				if (epochs[index] < attempt)
+				{
+					epochs[index] = attempt;
+					entry.m_attacks[index] = references[subsetIndex];
+				}
+				else if (entry.m_attacks[index] != references[subsetIndex])
+				{
+					break;
+				}
+			}
+		}
+#endif
+	}
+}
+
+void InitializeChessAttackTables()
+{
+	static ChessRayDirection const ROOK_DIRECTIONS[4] = { RAY_NORTH, RAY_EAST, RAY_SOUTH, RAY_WEST };
+	static ChessRayDirection const BISHOP_DIRECTIONS[4] = { RAY_NORTH_EAST, RAY_NORTH_WEST, RAY_SOUTH_WEST, RAY_SOUTH_EAST };
+	InitializeSliderTable(g_rookMagics, s_rookAttackTable, ROOK_DIRECTIONS);
+	InitializeSliderTable(g_bishopMagics, s_bishopAttackTable, BISHOP_DIRECTIONS);
+}
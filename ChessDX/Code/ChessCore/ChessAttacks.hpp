@@ -0,0 +1,254 @@
+#pragma once
+#include "ChessCore/ChessTypes.hpp"
+#include "ChessCore/ChessBitboard.hpp"
+
+// Slider lookups index their tables with BMI2 PEXT when the build targets it, magic multiplication otherwise.
+// PEXT is microcoded and slow on AMD before Zen 3, define CHESS_USE_PEXT=0 to force magics there.
+#if !defined(CHESS_USE_PEXT)
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__)) // MSVC has no __BMI2__, /arch:AVX2 targets Haswell and later which all have it
+#define CHESS_USE_PEXT 1
+#else
+#define CHESS_USE_PEXT 0
+#endif
+#endif
+
+#if CHESS_USE_PEXT
+#include <immintrin.h>
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+enum ChessRayDirection
+{
+	RAY_NORTH,
+	RAY_EAST,
+	RAY_NORTH_EAST,
+	RAY_NORTH_WEST,
+	RAY_SOUTH,		// directions from here on walk towards lower square indexes
+	RAY_WEST,
+	RAY_SOUTH_WEST,
+	RAY_SOUTH_EAST,
+	NUM_RAY_DIRECTIONS
+};
+
+// Leaper, ray and geometry masks are built at compile time and live in read-only data
+struct ChessLeaperAttackTables
+{
+	Bitboard m_knight[NUM_SQUARES] = {};
+	Bitboard m_king[NUM_SQUARES] = {};
+	Bitboard m_pawn[PLAYER_SIDE_NUM][NUM_SQUARES] = {}; // squares a pawn of that side standing on the square attacks
+};
+
+struct ChessRayTables
+{
+	Bitboard m_rays[NUM_RAY_DIRECTIONS][NUM_SQUARES] = {}; // excludes the origin square
+};
+
+struct ChessLineTables
+{
+	Bitboard m_between[NUM_SQUARES][NUM_SQUARES] = {}; // squares strictly between two aligned squares, else empty
+	Bitboard m_line[NUM_SQUARES][NUM_SQUARES] = {}; // whole board line through two aligned squares, else empty
+};
+
+struct ChessDistanceTables
+{
+	uint8_t m_distance[NUM_SQUARES][NUM_SQUARES] = {}; // king steps between two squares
+};
+
+constexpr int CHESS_RAY_STEPS[NUM_RAY_DIRECTIONS][2] = { {0, 1}, {1, 0}, {1, 1}, {-1, 1}, {0, -1}, {-1, 0}, {-1, -1}, {1, -1} };
+
+constexpr Bitboard GetMaskForOffsets(int square, int const (*offsets)[2], int numOffsets)
+{
+	Bitboard result = 0;
+	int file = GetFileOfSquare(square);
+	int rank = GetRankOfSquare(square);
+	for (int offsetIndex = 0; offsetIndex < numOffsets; ++offsetIndex)
+	{
+		int targetFile = file + offsets[offsetIndex][0];
+		int targetRank = rank + offsets[offsetIndex][1];
+		if (targetFile >= 0 && targetFile < 8 && targetRank >= 0 && targetRank < 8)
+		{
+			result |= GetSquareMask(GetSquareIndex(targetFile, targetRank));
+		}
+	}
+	return result;
+}
+
+constexpr ChessLeaperAttackTables GenerateChessLeaperAttackTables()
+{
+	constexpr int KNIGHT_OFFSETS[8][2] = { {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} };
+	constexpr int KING_OFFSETS[8][2] = { {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1} };
+	constexpr int WHITE_PAWN_OFFSETS[2][2] = { {-1, 1}, {1, 1} };
+	constexpr int BLACK_PAWN_OFFSETS[2][2] = { {-1, -1}, {1, -1} };
+
+	ChessLeaperAttackTables tables;
+	for (int square = 0; square < NUM_SQUARES; ++square)
+	{
+		tables.m_knight[square] = GetMaskForOffsets(square, KNIGHT_OFFSETS, 8);
+		tables.m_king[square] = GetMaskForOffsets(square, KING_OFFSETS, 8);
+		tables.m_pawn[PLAYER_WHITE][square] = GetMaskForOffsets(square, WHITE_PAWN_OFFSETS, 2);
+		tables.m_pawn[PLAYER_BLACK][square] = GetMaskForOffsets(square, BLACK_PAWN_OFFSETS, 2);
+	}
+	return tables;
+}
+
+constexpr ChessRayTables GenerateChessRayTables()
+{
+	ChessRayTables tables;
+	for (int square = 0; square < NUM_SQUARES; ++square)
+	{
+		for (int direction = 0; direction < NUM_RAY_DIRECTIONS; ++direction)
+		{
+			int file = GetFileOfSquare(square) + CHESS_RAY_STEPS[direction][0];
+			int rank = GetRankOfSquare(square) + CHESS_RAY_STEPS[direction][1];
+			while (file >= 0 && file < 8 && rank >= 0 && rank < 8)
+			{
+				tables.m_rays[direction][square] |= GetSquareMask(GetSquareIndex(file, rank));
+				file += CHESS_RAY_STEPS[direction][0];
+				rank += CHESS_RAY_STEPS[direction][1];
+			}
+		}
+	}
+	return tables;
+}
+
+inline constexpr ChessLeaperAttackTables g_chessLeaperAttacks = GenerateChessLeaperAttackTables();
+inline constexpr ChessRayTables g_chessRays = GenerateChessRayTables();
+
+constexpr ChessLineTables GenerateChessLineTables()
+{
+	// Walk each ray once, everything already passed is between the origin and the current square
+	ChessLineTables tables;
+	for (int square = 0; square < NUM_SQUARES; ++square)
+	{
+		for (int direction = 0; direction < NUM_RAY_DIRECTIONS; ++direction)
+		{
+			int oppositeDirection = (direction + RAY_SOUTH) % NUM_RAY_DIRECTIONS;
+			Bitboard line = g_chessRays.m_rays[direction][square] | g_chessRays.m_rays[oppositeDirection][square] | GetSquareMask(square);
+			Bitboard between = 0;
+			int file = GetFileOfSquare(square) + CHESS_RAY_STEPS[direction][0];
+			int rank = GetRankOfSquare(square) + CHESS_RAY_STEPS[direction][1];
+			while (file >= 0 && file < 8 && rank >= 0 && rank < 8)
+			{
+				int otherSquare = GetSquareIndex(file, rank);
+				tables.m_between[square][otherSquare] = between;
+				tables.m_line[square][otherSquare] = line;
+				between |= GetSquareMask(otherSquare);
+				file += CHESS_RAY_STEPS[direction][0];
+				rank += CHESS_RAY_STEPS[direction][1];
+			}
+		}
+	}
+	return tables;
+}
+
+constexpr ChessDistanceTables GenerateChessDistanceTables()
+{
+	ChessDistanceTables tables;
+	for (int squareA = 0; squareA < NUM_SQUARES; ++squareA)
+	{
+		for (int squareB = 0; squareB < NUM_SQUARES; ++squareB)
+		{
+			int deltaX = GetFileOfSquare(squareA) - GetFileOfSquare(squareB);
+			int deltaY = GetRankOfSquare(squareA) - GetRankOfSquare(squareB);
+			deltaX = (deltaX < 0) ? -deltaX : deltaX;
+			deltaY = (deltaY < 0) ? -deltaY : deltaY;
+			tables.m_distance[squareA][squareB] = static_cast<uint8_t>((deltaX > deltaY) ? deltaX : deltaY);
+		}
+	}
+	return tables;
+}
+
+inline constexpr ChessLineTables g_chessLines = GenerateChessLineTables();
+inline constexpr ChessDistanceTables g_chessDistances = GenerateChessDistanceTables();
+
+
+//-----------------------------------------------------------------------------------------------
+// Slider tables are too large to build at compile time, call InitializeChessAttackTables() once before any slider lookup
+void InitializeChessAttackTables();
+
+struct ChessMagicEntry
+{
+	Bitboard*	m_attacks = nullptr;	// this square's slice of the shared attack table
+	Bitboard	m_mask = 0;				// relevant blockers, board edges excluded
+	Bitboard	m_magic = 0;			// unused on the PEXT path
+	int			m_shift = 0;
+
+	unsigned int GetIndex(Bitboard occupied) const;
+};
+
+extern ChessMagicEntry g_rookMagics[NUM_SQUARES];
+extern ChessMagicEntry g_bishopMagics[NUM_SQUARES];
+
+
+//-----------------------------------------------------------------------------------------------
+constexpr Bitboard GetKnightAttacks(int square)
+{
+	return g_chessLeaperAttacks.m_knight[square];
+}
+
+constexpr Bitboard GetKingAttacks(int square)
+{
+	return g_chessLeaperAttacks.m_king[square];
+}
+
+// squares a pawn of side standing on square attacks
+constexpr Bitboard GetPawnAttacks(PlayerSide side, int square)
+{
+	return g_chessLeaperAttacks.m_pawn[side][square];
+}
+
+// ray up to and including the first blocker, walks the ray so only used to build the slider tables
+inline Bitboard GetRayAttacks(ChessRayDirection direction, int square, Bitboard occupied)
+{
+	Bitboard ray = g_chessRays.m_rays[direction][square];
+	Bitboard blockers = ray & occupied;
+	if (blockers == 0)
+	{
+		return ray;
+	}
+	int blockerSquare = (direction < RAY_SOUTH) ? GetLowestSquare(blockers) : GetHighestSquare(blockers);
+	return ray ^ g_chessRays.m_rays[direction][blockerSquare];
+}
+
+inline unsigned int ChessMagicEntry::GetIndex(Bitboard occupied) const
+{
+#if CHESS_USE_PEXT
+	return static_cast<unsigned int>(_pext_u64(occupied, m_mask));
+#else
+	return static_cast<unsigned int>(((occupied & m_mask) * m_magic) >> m_shift);
+#endif
+}
+
+inline Bitboard GetRookAttacks(int square, Bitboard occupied)
+{
+	ChessMagicEntry const& entry = g_rookMagics[square];
+	return entry.m_attacks[entry.GetIndex(occupied)];
+}
+
+inline Bitboard GetBishopAttacks(int square, Bitboard occupied)
+{
+	ChessMagicEntry const& entry = g_bishopMagics[square];
+	return entry.m_attacks[entry.GetIndex(occupied)];
+}
+
+inline Bitboard GetQueenAttacks(int square, Bitboard occupied)
+{
+	return GetRookAttacks(square, occupied) | GetBishopAttacks(square, occupied);
+}
+
+constexpr Bitboard GetBetweenMask(int squareA, int squareB)
+{
+	return g_chessLines.m_between[squareA][squareB];
+}
+
+constexpr Bitboard GetLineMask(int squareA, int squareB)
+{
+	return g_chessLines.m_line[squareA][squareB];
+}
+
+// king steps, max of the file and rank distance
+constexpr int GetSquareDistance(int squareA, int squareB)
+{
+	return g_chessDistances.m_distance[squareA][squareB];
+}
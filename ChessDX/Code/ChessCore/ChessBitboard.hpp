@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//-----------------------------------------------------------------------------------------------
+// Square index = file + rank * 8, same layout as ChessMatch::GetPieceIndexFromBoardCoords (A1 = 0, H8 = 63)
+typedef uint64_t Bitboard;
+
+constexpr int NUM_SQUARES = 64;
+constexpr int SQUARE_NONE = -1;
+
+constexpr Bitboard BITBOARD_EMPTY	= 0ULL;
+constexpr Bitboard BITBOARD_ALL		= ~0ULL;
+
+constexpr Bitboard FILE_A_MASK = 0x0101010101010101ULL;
+constexpr Bitboard FILE_H_MASK = FILE_A_MASK << 7;
+constexpr Bitboard RANK_1_MASK = 0x00000000000000FFULL;
+constexpr Bitboard RANK_8_MASK = RANK_1_MASK << 56;
+
+//-----------------------------------------------------------------------------------------------
+constexpr Bitboard GetSquareMask(int square)
+{
+	return 1ULL << square;
+}
+
+constexpr int GetSquareIndex(int file, int rank)
+{
+	return file + rank * 8;
+}
+
+constexpr int GetFileOfSquare(int square)
+{
+	return square & 7;
+}
+
+constexpr int GetRankOfSquare(int square)
+{
+	return square >> 3;
+}
+
+constexpr bool IsSquareInMask(Bitboard mask, int square)
+{
+	return (mask & GetSquareMask(square)) != 0;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline int GetBitCount(Bitboard mask)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	return static_cast<int>(__popcnt64(mask));
+#elif defined(_MSC_VER)
+	return static_cast<int>(__popcnt(static_cast<unsigned int>(mask)) + __popcnt(static_cast<unsigned int>(mask >> 32)));
+#else
+	return __builtin_popcountll(mask);
+#endif
+}
+
+// mask must not be empty
+inline int GetLowestSquare(Bitboard mask)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return static_cast<int>(index);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanForward(&index, static_cast<unsigned long>(mask)))
+	{
+		return static_cast<int>(index);
+	}
+	_BitScanForward(&index, static_cast<unsigned long>(mask >> 32));
+	return static_cast<int>(index) + 32;
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
+
+// mask must not be empty
+inline int GetHighestSquare(Bitboard mask)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanReverse64(&index, mask);
+	return static_cast<int>(index);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanReverse(&index, static_cast<unsigned long>(mask >> 32)))
+	{
+		return static_cast<int>(index) + 32;
+	}
+	_BitScanReverse(&index, static_cast<unsigned long>(mask));
+	return static_cast<int>(index);
+#else
+	return 63 - __builtin_clzll(mask);
+#endif
+}
+
+// mask must not be empty
+inline int PopLowestSquare(Bitboard& mask)
+{
+	int square = GetLowestSquare(mask);
+	mask &= mask - 1;
+	return square;
+}
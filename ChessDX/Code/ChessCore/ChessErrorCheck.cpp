@@ -1,4 +1,4 @@
-#include "Game/ChessErrorCheck.hpp"
+#include "ChessCore/ChessErrorCheck.hpp"
 
 
 bool IsValid(ChessMoveResult result)
@@ -29,10 +29,11 @@ bool IsValid(ChessMoveResult result)
 		case ChessMoveResult::INVALID_CASTLE_PATH_BLOCKED:
 		case ChessMoveResult::INVALID_CASTLE_THROUGH_CHECK:
 		case ChessMoveResult::INVALID_CASTLE_OUT_OF_CHECK:
+		case ChessMoveResult::INVALID_TELEPORT_PAWN_TO_END_RANK:
 			return false;
 
 		default:
-			ERROR_AND_DIE("Unhandled ChessMoveResult enum value");
+			return false;
 	}
 }
 
@@ -63,7 +64,8 @@ const char* GetMoveResultString(ChessMoveResult result)
 	case ChessMoveResult::INVALID_CASTLE_PATH_BLOCKED:		return "Invalid castle; pieces in-between king and rook";
 	case ChessMoveResult::INVALID_CASTLE_THROUGH_CHECK:		return "Invalid castle; king can't move through check";
 	case ChessMoveResult::INVALID_CASTLE_OUT_OF_CHECK:		return "Invalid castle; king can't castle out of check";
+	case ChessMoveResult::INVALID_TELEPORT_PAWN_TO_END_RANK:	return "Invalid teleport; pawns can't be placed on the first or last rank";
 
-	default: ERROR_AND_DIE(Stringf("Unhandled ChessMoveResult enum value #%d", (int)result));;
+	default:												return "Unhandled ChessMoveResult!";
 	}
 }
\ No newline at end of file
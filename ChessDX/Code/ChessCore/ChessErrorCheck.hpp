@@ -1,5 +1,5 @@
 #pragma once
-#include "Game/GameCommon.hpp"
+#include "ChessCore/ChessTypes.hpp"
 
 enum class ChessMoveResult
 {
@@ -28,6 +28,7 @@ enum class ChessMoveResult
 	INVALID_CASTLE_PATH_BLOCKED,
 	INVALID_CASTLE_THROUGH_CHECK,
 	INVALID_CASTLE_OUT_OF_CHECK,
+	INVALID_TELEPORT_PAWN_TO_END_RANK,
 
 };
 
@@ -0,0 +1,55 @@
+#include "ChessCore/ChessEvaluate.hpp"
+#include "ChessCore/ChessPosition.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+int EvaluatePosition(ChessPosition const& position)
+{
+	int whiteScore = GetTaperedScore(position.m_pieceSquareScore, position.m_gamePhase);
+	return (position.m_sideToMove == PLAYER_WHITE) ? whiteScore : -whiteScore;
+}
+
+int GetTaperedScore(ChessTaperedScore const& score, int gamePhase)
+{
+	if (gamePhase > MAX_GAME_PHASE)
+	{
+		gamePhase = MAX_GAME_PHASE;
+	}
+	return (score.m_midgame * gamePhase + score.m_endgame * (MAX_GAME_PHASE - gamePhase)) / MAX_GAME_PHASE;
+}
+
+void ComputeEvalBreakdown(ChessPosition const& position, ChessEvalBreakdown& out_breakdown)
+{
+	out_breakdown = ChessEvalBreakdown();
+	ChessTaperedScore total;
+	for (int square = 0; square < NUM_SQUARES; ++square)
+	{
+		PieceType type = position.GetPieceTypeAt(square);
+		if (type == PieceType::UNKNOWN)
+		{
+			continue;
+		}
+
+		// the tables hold material plus bonus signed by side, split them back apart per side
+		PlayerSide side = position.GetPlayerSideAt(square);
+		ChessTaperedScore const& score = GetPieceSquareScore(side, type, square);
+		int sign = (side == PLAYER_WHITE) ? 1 : -1;
+		ChessTaperedScore& material = out_breakdown.m_material[side];
+		ChessTaperedScore& pieceSquare = out_breakdown.m_pieceSquare[side];
+		material.m_midgame += CHESS_PIECE_VALUES[(int)type];
+		material.m_endgame += CHESS_PIECE_VALUES_ENDGAME[(int)type];
+		pieceSquare.m_midgame += sign * score.m_midgame - CHESS_PIECE_VALUES[(int)type];
+		pieceSquare.m_endgame += sign * score.m_endgame - CHESS_PIECE_VALUES_ENDGAME[(int)type];
+		total.m_midgame += score.m_midgame;
+		total.m_endgame += score.m_endgame;
+		out_breakdown.m_gamePhase += CHESS_PHASE_WEIGHTS[(int)type];
+	}
+
+	out_breakdown.m_whiteScore = GetTaperedScore(total, out_breakdown.m_gamePhase);
+	out_breakdown.m_isIncrementalInSync = total.m_midgame == position.m_pieceSquareScore.m_midgame && total.m_endgame == position.m_pieceSquareScore.m_endgame
+		&& out_breakdown.m_gamePhase == position.m_gamePhase;
+	if (out_breakdown.m_gamePhase > MAX_GAME_PHASE)
+	{
+		out_breakdown.m_gamePhase = MAX_GAME_PHASE;
+	}
+}
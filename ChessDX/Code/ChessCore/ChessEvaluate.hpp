@@ -0,0 +1,28 @@
+#pragma once
+#include "ChessCore/ChessTypes.hpp"
+#include "ChessCore/ChessPieceSquareTables.hpp"
+
+struct ChessPosition;
+
+
+//-----------------------------------------------------------------------------------------------
+// Every term EvaluatePosition adds up, split by side, for debug displays. Rebuilt from scratch so
+// it also shows whether the incrementally kept sums in ChessPosition have drifted.
+struct ChessEvalBreakdown
+{
+	ChessTaperedScore	m_material[PLAYER_SIDE_NUM];
+	ChessTaperedScore	m_pieceSquare[PLAYER_SIDE_NUM];
+	int					m_gamePhase = 0; // 0 (endgame) to MAX_GAME_PHASE (middlegame)
+	int					m_whiteScore = 0; // tapered total from white's point of view
+	bool				m_isIncrementalInSync = true;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Static score in centipawns from the side to move's point of view: material and piece-square
+// bonuses blended between their middlegame and endgame values by how much material is left.
+// Reads the sums ChessPosition keeps up to date in MakeMove, so it costs the same on any board.
+int EvaluatePosition(ChessPosition const& position);
+int GetTaperedScore(ChessTaperedScore const& score, int gamePhase);
+
+void ComputeEvalBreakdown(ChessPosition const& position, ChessEvalBreakdown& out_breakdown);
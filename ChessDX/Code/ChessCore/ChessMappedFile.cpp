@@ -0,0 +1,100 @@
+#include "ChessCore/ChessMappedFile.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+ChessMappedFile::~ChessMappedFile()
+{
+	Close();
+}
+
+bool ChessMappedFile::Open(std::string const& filePath, std::string& out_errorMessage)
+{
+	Close();
+
+	uint64_t fileSize = 0;
+	void const* view = nullptr;
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		out_errorMessage = "cannot open " + filePath;
+		return false;
+	}
+	LARGE_INTEGER size = {};
+	GetFileSizeEx(file, &size);
+	fileSize = static_cast<uint64_t>(size.QuadPart);
+	if (fileSize > 0)
+	{
+		// the view keeps the mapping alive, neither handle is needed once it exists
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping != nullptr)
+		{
+			view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+#else
+	int file = open(filePath.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		out_errorMessage = "cannot open " + filePath;
+		return false;
+	}
+	struct stat fileStats = {};
+	fstat(file, &fileStats);
+	fileSize = static_cast<uint64_t>(fileStats.st_size);
+	if (fileSize > 0)
+	{
+		void* mapped = mmap(nullptr, static_cast<size_t>(fileSize), PROT_READ, MAP_SHARED, file, 0);
+		if (mapped != MAP_FAILED)
+		{
+			// every user looks things up at scattered offsets, reading ahead would only pull in pages nobody asks for
+			madvise(mapped, static_cast<size_t>(fileSize), MADV_RANDOM);
+			view = mapped;
+		}
+	}
+	close(file);
+#endif
+
+	if (fileSize == 0)
+	{
+		out_errorMessage = filePath + " is empty";
+		return false;
+	}
+	if (view == nullptr)
+	{
+		out_errorMessage = "cannot map " + filePath + " into memory";
+		return false;
+	}
+
+	m_data = static_cast<unsigned char const*>(view);
+	m_size = fileSize;
+	return true;
+}
+
+void ChessMappedFile::Close()
+{
+	if (m_data == nullptr)
+	{
+		return;
+	}
+#if defined(_WIN32)
+	UnmapViewOfFile(m_data);
+#else
+	munmap(const_cast<unsigned char*>(m_data), static_cast<size_t>(m_size));
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
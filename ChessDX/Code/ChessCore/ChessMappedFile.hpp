@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+
+//-----------------------------------------------------------------------------------------------
+// Whole file mapped read only. It costs address space rather than heap, pages come in from disk
+// the first time they are touched, and every mapping of the same file in the process, or in other
+// processes, shares the same physical pages. Read only once open, one instance can serve every thread.
+class ChessMappedFile
+{
+public:
+	ChessMappedFile() = default;
+	ChessMappedFile(ChessMappedFile const& copy) = delete;
+	~ChessMappedFile();
+
+	bool					Open(std::string const& filePath, std::string& out_errorMessage); // closes any file already open
+	void					Close();
+	bool					IsOpen() const { return m_data != nullptr; }
+	unsigned char const*	GetData() const { return m_data; }
+	uint64_t				GetSize() const { return m_size; }
+
+private:
+	unsigned char const*	m_data = nullptr;
+	uint64_t				m_size = 0;
+};
@@ -0,0 +1,119 @@
+#pragma once
+#include "ChessCore/ChessTypes.hpp"
+#include <cstdint>
+
+
+//-----------------------------------------------------------------------------------------------
+// Low two bits pick the promotion piece, bit 2 marks a capture, bit 3 marks a promotion
+enum ChessMoveFlag : uint8_t
+{
+	MOVE_FLAG_QUIET					= 0,
+	MOVE_FLAG_DOUBLE_PAWN_PUSH		= 1,
+	MOVE_FLAG_CASTLE_KINGSIDE		= 2,
+	MOVE_FLAG_CASTLE_QUEENSIDE		= 3,
+	MOVE_FLAG_CAPTURE				= 4,
+	MOVE_FLAG_EN_PASSANT			= 5,
+	MOVE_FLAG_PROMOTE_KNIGHT		= 8,
+	MOVE_FLAG_PROMOTE_BISHOP		= 9,
+	MOVE_FLAG_PROMOTE_ROOK			= 10,
+	MOVE_FLAG_PROMOTE_QUEEN			= 11,
+	MOVE_FLAG_PROMOTE_KNIGHT_CAPTURE	= 12,
+	MOVE_FLAG_PROMOTE_BISHOP_CAPTURE	= 13,
+	MOVE_FLAG_PROMOTE_ROOK_CAPTURE		= 14,
+	MOVE_FLAG_PROMOTE_QUEEN_CAPTURE		= 15,
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Packed into 16 bits: from square in bits 0-5, to square in bits 6-11, ChessMoveFlag in bits 12-15.
+// The raw value is what goes over the network, and comparing two moves is one integer compare.
+struct ChessMove
+{
+public:
+	ChessMove() = default;
+	ChessMove(int fromSquare, int toSquare, ChessMoveFlag flag);
+	static ChessMove FromRawData(uint16_t rawData);
+	static ChessMove None() { return FromRawData(0); }
+
+	int				GetFromSquare() const { return m_data & 0x3F; }
+	int				GetToSquare() const { return (m_data >> 6) & 0x3F; }
+	ChessMoveFlag	GetFlag() const { return static_cast<ChessMoveFlag>(m_data >> 12); }
+	uint16_t		GetRawData() const { return m_data; }
+
+	bool		IsCapture() const { return (m_data & (MOVE_FLAG_CAPTURE << 12)) != 0; }
+	bool		IsPromotion() const { return (m_data & (MOVE_FLAG_PROMOTE_KNIGHT << 12)) != 0; }
+	bool		IsEnPassant() const { return GetFlag() == MOVE_FLAG_EN_PASSANT; }
+	bool		IsCastle() const { return GetFlag() == MOVE_FLAG_CASTLE_KINGSIDE || GetFlag() == MOVE_FLAG_CASTLE_QUEENSIDE; }
+	bool		IsNone() const { return m_data == 0; } // a1a1 quiet, never a real move
+	PieceType	GetPromotionType() const;
+
+	bool operator==(ChessMove const& other) const { return m_data == other.m_data; }
+	bool operator!=(ChessMove const& other) const { return m_data != other.m_data; }
+
+public:
+	// no initializer on purpose, so a ChessMoveList costs nothing to put on the stack
+	uint16_t	m_data;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Fixed capacity so generation never touches the heap, 218 is the most legal moves any position has
+constexpr int MAX_CHESS_MOVES = 256;
+
+struct ChessMoveList
+{
+public:
+	void		Clear() { m_count = 0; }
+	void		Add(ChessMove const& move) { m_moves[m_count++] = move; }
+	int			GetCount() const { return m_count; }
+	bool		IsEmpty() const { return m_count == 0; }
+	bool		Contains(ChessMove const& move) const;
+
+	ChessMove const&	operator[](int index) const { return m_moves[index]; }
+	ChessMove&			operator[](int index) { return m_moves[index]; }
+
+	ChessMove const*	begin() const { return m_moves; }
+	ChessMove const*	end() const { return m_moves + m_count; }
+	ChessMove*			begin() { return m_moves; }
+	ChessMove*			end() { return m_moves + m_count; }
+
+public:
+	ChessMove	m_moves[MAX_CHESS_MOVES];
+	int			m_count = 0;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline ChessMove::ChessMove(int fromSquare, int toSquare, ChessMoveFlag flag)
+	: m_data(static_cast<uint16_t>(fromSquare | (toSquare << 6) | (flag << 12)))
+{
+}
+
+inline ChessMove ChessMove::FromRawData(uint16_t rawData)
+{
+	ChessMove move;
+	move.m_data = rawData;
+	return move;
+}
+
+inline PieceType ChessMove::GetPromotionType() const
+{
+	if (!IsPromotion())
+	{
+		return PieceType::UNKNOWN;
+	}
+	static PieceType const PROMOTION_TYPES[4] = { PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN };
+	return PROMOTION_TYPES[GetFlag() & 3];
+}
+
+inline bool ChessMoveList::Contains(ChessMove const& move) const
+{
+	for (int moveIndex = 0; moveIndex < m_count; ++moveIndex)
+	{
+		if (m_moves[moveIndex] == move)
+		{
+			return true;
+		}
+	}
+	return false;
+}
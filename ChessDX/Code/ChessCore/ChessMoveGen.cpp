@@ -0,0 +1,325 @@
+#include "ChessCore/ChessMoveGen.hpp"
+#include "ChessCore/ChessPosition.hpp"
+#include "ChessCore/ChessAttacks.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+static void AddMovesToTargets(ChessMoveList& moves, int fromSquare, Bitboard targets, Bitboard enemyPieces)
+{
+	while (targets)
+	{
+		int toSquare = PopLowestSquare(targets);
+		moves.Add(ChessMove(fromSquare, toSquare, IsSquareInMask(enemyPieces, toSquare) ? MOVE_FLAG_CAPTURE : MOVE_FLAG_QUIET));
+	}
+}
+
+static void AddPromotionMoves(ChessMoveList& moves, int fromSquare, int toSquare, bool isCapture)
+{
+	uint8_t captureBit = isCapture ? MOVE_FLAG_CAPTURE : 0;
+	moves.Add(ChessMove(fromSquare, toSquare, static_cast<ChessMoveFlag>(MOVE_FLAG_PROMOTE_QUEEN | captureBit)));
+	moves.Add(ChessMove(fromSquare, toSquare, static_cast<ChessMoveFlag>(MOVE_FLAG_PROMOTE_KNIGHT | captureBit)));
+	moves.Add(ChessMove(fromSquare, toSquare, static_cast<ChessMoveFlag>(MOVE_FLAG_PROMOTE_ROOK | captureBit)));
+	moves.Add(ChessMove(fromSquare, toSquare, static_cast<ChessMoveFlag>(MOVE_FLAG_PROMOTE_BISHOP | captureBit)));
+}
+
+// Bitboard of pieces of side that stand alone between their king and an enemy slider
+static Bitboard GetPinnedPieces(ChessPosition const& position, PlayerSide side, int kingSquare)
+{
+	PlayerSide enemySide = GetOpponentPlayerSide(side);
+	Bitboard occupied = position.GetOccupied();
+	Bitboard enemyPieces = position.GetPieces(enemySide);
+	Bitboard enemyQueens = position.GetPieces(enemySide, PieceType::QUEEN);
+
+	// look through our own pieces from the king, only enemy pieces block
+	Bitboard pinners = (GetRookAttacks(kingSquare, enemyPieces) & (position.GetPieces(enemySide, PieceType::ROOK) | enemyQueens))
+		| (GetBishopAttacks(kingSquare, enemyPieces) & (position.GetPieces(enemySide, PieceType::BISHOP) | enemyQueens));
+
+	Bitboard pinned = 0;
+	while (pinners)
+	{
+		int pinnerSquare = PopLowestSquare(pinners);
+		Bitboard blockers = GetBetweenMask(kingSquare, pinnerSquare) & occupied;
+		if (blockers && (blockers & (blockers - 1)) == 0)
+		{
+			pinned |= blockers & position.GetPieces(side);
+		}
+	}
+	return pinned;
+}
+
+// Returns the pieces giving check; out_checkMask is where a non-king move has to land to answer it
+static Bitboard GetCheckersAndCheckMask(ChessPosition const& position, PlayerSide side, int kingSquare, Bitboard& out_checkMask)
+{
+	Bitboard checkers = position.GetAttackersTo(kingSquare, position.GetOccupied()) & position.GetPieces(GetOpponentPlayerSide(side));
+	out_checkMask = BITBOARD_ALL;
+	if (checkers)
+	{
+		out_checkMask = GetBetweenMask(kingSquare, GetLowestSquare(checkers)) | checkers;
+	}
+	return checkers;
+}
+
+static void GenerateCastlingMoves(ChessPosition const& position, ChessMoveList& moves, int kingSquare)
+{
+	PlayerSide side = position.m_sideToMove;
+	PlayerSide enemySide = GetOpponentPlayerSide(side);
+	int homeRank = (side == PLAYER_WHITE) ? 0 : 7;
+	if (kingSquare != GetSquareIndex(4, homeRank))
+	{
+		return;
+	}
+
+	Bitboard occupied = position.GetOccupied();
+	Bitboard ourRooks = position.GetPieces(side, PieceType::ROOK);
+
+	uint8_t kingsideRights = (side == PLAYER_WHITE) ? CASTLE_WHITE_KINGSIDE : CASTLE_BLACK_KINGSIDE;
+	int kingsideRook = GetSquareIndex(7, homeRank);
+	if (position.HasCastlingRights(kingsideRights) && IsSquareInMask(ourRooks, kingsideRook)
+		&& (GetBetweenMask(kingSquare, kingsideRook) & occupied) == 0
+		&& !position.IsSquareAttacked(kingSquare + 1, enemySide) && !position.IsSquareAttacked(kingSquare + 2, enemySide))
+	{
+		moves.Add(ChessMove(kingSquare, kingSquare + 2, MOVE_FLAG_CASTLE_KINGSIDE));
+	}
+
+	uint8_t queensideRights = (side == PLAYER_WHITE) ? CASTLE_WHITE_QUEENSIDE : CASTLE_BLACK_QUEENSIDE;
+	int queensideRook = GetSquareIndex(0, homeRank);
+	if (position.HasCastlingRights(queensideRights) && IsSquareInMask(ourRooks, queensideRook)
+		&& (GetBetweenMask(kingSquare, queensideRook) & occupied) == 0
+		&& !position.IsSquareAttacked(kingSquare - 1, enemySide) && !position.IsSquareAttacked(kingSquare - 2, enemySide))
+	{
+		moves.Add(ChessMove(kingSquare, kingSquare - 2, MOVE_FLAG_CASTLE_QUEENSIDE));
+	}
+}
+
+static void GeneratePawnMoves(ChessPosition const& position, ChessMoveList& moves, int kingSquare, Bitboard checkMask, Bitboard pinned)
+{
+	PlayerSide side = position.m_sideToMove;
+	PlayerSide enemySide = GetOpponentPlayerSide(side);
+	Bitboard occupied = position.GetOccupied();
+	Bitboard enemyPieces = position.GetPieces(enemySide);
+	int forward = (side == PLAYER_WHITE) ? 8 : -8;
+	int doublePushRank = (side == PLAYER_WHITE) ? 1 : 6;
+	int promotionRank = (side == PLAYER_WHITE) ? 7 : 0;
+
+	// a pawn on the back rank has no push square on the board; legal positions never have one
+	Bitboard pawns = position.GetPieces(side, PieceType::PAWN) & ~(RANK_1_MASK | RANK_8_MASK);
+	while (pawns)
+	{
+		int fromSquare = PopLowestSquare(pawns);
+		Bitboard allowed = checkMask;
+		if (IsSquareInMask(pinned, fromSquare))
+		{
+			allowed &= GetLineMask(kingSquare, fromSquare);
+		}
+
+		// Pushes
+		int pushSquare = fromSquare + forward;
+		if (!IsSquareInMask(occupied, pushSquare))
+		{
+			if (IsSquareInMask(allowed, pushSquare))
+			{
+				if (GetRankOfSquare(pushSquare) == promotionRank)
+				{
+					AddPromotionMoves(moves, fromSquare, pushSquare, false);
+				}
+				else
+				{
+					moves.Add(ChessMove(fromSquare, pushSquare, MOVE_FLAG_QUIET));
+				}
+			}
+
+			int doublePushSquare = pushSquare + forward;
+			if (GetRankOfSquare(fromSquare) == doublePushRank && !IsSquareInMask(occupied, doublePushSquare) && IsSquareInMask(allowed, doublePushSquare))
+			{
+				moves.Add(ChessMove(fromSquare, doublePushSquare, MOVE_FLAG_DOUBLE_PAWN_PUSH));
+			}
+		}
+
+		// Captures
+		Bitboard attacks = GetPawnAttacks(side, fromSquare);
+		Bitboard captures = attacks & enemyPieces & allowed;
+		while (captures)
+		{
+			int toSquare = PopLowestSquare(captures);
+			if (GetRankOfSquare(toSquare) == promotionRank)
+			{
+				AddPromotionMoves(moves, fromSquare, toSquare, true);
+			}
+			else
+			{
+				moves.Add(ChessMove(fromSquare, toSquare, MOVE_FLAG_CAPTURE));
+			}
+		}
+
+		// En passant removes two pieces from one rank, too rare to be worth masks, just check the king afterwards
+		int enPassantSquare = position.m_enPassantSquare;
+		if (enPassantSquare != SQUARE_NONE && IsSquareInMask(attacks, enPassantSquare))
+		{
+			int capturedSquare = enPassantSquare - forward;
+			Bitboard occupiedAfter = (occupied ^ GetSquareMask(fromSquare) ^ GetSquareMask(capturedSquare)) | GetSquareMask(enPassantSquare);
+			if (kingSquare == SQUARE_NONE || !position.IsSquareAttacked(kingSquare, enemySide, occupiedAfter))
+			{
+				moves.Add(ChessMove(fromSquare, enPassantSquare, MOVE_FLAG_EN_PASSANT));
+			}
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void GenerateLegalMoves(ChessPosition const& position, ChessMoveList& moves)
+{
+	moves.Clear();
+
+	PlayerSide side = position.m_sideToMove;
+	PlayerSide enemySide = GetOpponentPlayerSide(side);
+	Bitboard ourPieces = position.GetPieces(side);
+	Bitboard enemyPieces = position.GetPieces(enemySide);
+	Bitboard occupied = ourPieces | enemyPieces;
+	int kingSquare = position.GetKingSquare(side);
+
+	Bitboard checkMask = BITBOARD_ALL;	// squares a non-king move has to land on
+	Bitboard pinned = 0;
+	if (kingSquare != SQUARE_NONE)
+	{
+		// King steps, with the king lifted off the board so it can't hide behind itself on a slider ray
+		Bitboard occupiedWithoutKing = occupied ^ GetSquareMask(kingSquare);
+		Bitboard kingTargets = GetKingAttacks(kingSquare) & ~ourPieces;
+		while (kingTargets)
+		{
+			int toSquare = PopLowestSquare(kingTargets);
+			if (!position.IsSquareAttacked(toSquare, enemySide, occupiedWithoutKing))
+			{
+				moves.Add(ChessMove(kingSquare, toSquare, IsSquareInMask(enemyPieces, toSquare) ? MOVE_FLAG_CAPTURE : MOVE_FLAG_QUIET));
+			}
+		}
+
+		Bitboard checkers = GetCheckersAndCheckMask(position, side, kingSquare, checkMask);
+		if (checkers & (checkers - 1))
+		{
+			// double check, only the king can move
+			return;
+		}
+		if (checkers == 0)
+		{
+			GenerateCastlingMoves(position, moves, kingSquare);
+		}
+
+		pinned = GetPinnedPieces(position, side, kingSquare);
+	}
+
+	GeneratePawnMoves(position, moves, kingSquare, checkMask, pinned);
+
+	Bitboard targetMask = ~ourPieces & checkMask;
+
+	Bitboard knights = position.GetPieces(side, PieceType::KNIGHT) & ~pinned; // a pinned knight can never move
+	while (knights)
+	{
+		int fromSquare = PopLowestSquare(knights);
+		AddMovesToTargets(moves, fromSquare, GetKnightAttacks(fromSquare) & targetMask, enemyPieces);
+	}
+
+	Bitboard queens = position.GetPieces(side, PieceType::QUEEN);
+	Bitboard diagonalSliders = position.GetPieces(side, PieceType::BISHOP) | queens;
+	while (diagonalSliders)
+	{
+		int fromSquare = PopLowestSquare(diagonalSliders);
+		Bitboard targets = GetBishopAttacks(fromSquare, occupied) & targetMask;
+		if (IsSquareInMask(pinned, fromSquare))
+		{
+			targets &= GetLineMask(kingSquare, fromSquare);
+		}
+		AddMovesToTargets(moves, fromSquare, targets, enemyPieces);
+	}
+
+	Bitboard axialSliders = position.GetPieces(side, PieceType::ROOK) | queens;
+	while (axialSliders)
+	{
+		int fromSquare = PopLowestSquare(axialSliders);
+		Bitboard targets = GetRookAttacks(fromSquare, occupied) & targetMask;
+		if (IsSquareInMask(pinned, fromSquare))
+		{
+			targets &= GetLineMask(kingSquare, fromSquare);
+		}
+		AddMovesToTargets(moves, fromSquare, targets, enemyPieces);
+	}
+}
+
+bool HasAnyLegalMove(ChessPosition const& position)
+{
+	PlayerSide side = position.m_sideToMove;
+	PlayerSide enemySide = GetOpponentPlayerSide(side);
+	Bitboard ourPieces = position.GetPieces(side);
+	Bitboard occupied = position.GetOccupied();
+	int kingSquare = position.GetKingSquare(side);
+
+	// Cheapest and most likely answers first; castling never needs a look, it is only legal when a king step is
+	Bitboard checkMask = BITBOARD_ALL;
+	Bitboard pinned = 0;
+	if (kingSquare != SQUARE_NONE)
+	{
+		Bitboard occupiedWithoutKing = occupied ^ GetSquareMask(kingSquare);
+		Bitboard kingTargets = GetKingAttacks(kingSquare) & ~ourPieces;
+		while (kingTargets)
+		{
+			if (!position.IsSquareAttacked(PopLowestSquare(kingTargets), enemySide, occupiedWithoutKing))
+			{
+				return true;
+			}
+		}
+
+		Bitboard checkers = GetCheckersAndCheckMask(position, side, kingSquare, checkMask);
+		if (checkers & (checkers - 1))
+		{
+			return false;
+		}
+		pinned = GetPinnedPieces(position, side, kingSquare);
+	}
+
+	Bitboard targetMask = ~ourPieces & checkMask;
+
+	Bitboard knights = position.GetPieces(side, PieceType::KNIGHT) & ~pinned;
+	while (knights)
+	{
+		if (GetKnightAttacks(PopLowestSquare(knights)) & targetMask)
+		{
+			return true;
+		}
+	}
+
+	Bitboard queens = position.GetPieces(side, PieceType::QUEEN);
+	Bitboard diagonalSliders = position.GetPieces(side, PieceType::BISHOP) | queens;
+	while (diagonalSliders)
+	{
+		int fromSquare = PopLowestSquare(diagonalSliders);
+		Bitboard targets = GetBishopAttacks(fromSquare, occupied) & targetMask;
+		if (IsSquareInMask(pinned, fromSquare))
+		{
+			targets &= GetLineMask(kingSquare, fromSquare);
+		}
+		if (targets)
+		{
+			return true;
+		}
+	}
+
+	Bitboard axialSliders = position.GetPieces(side, PieceType::ROOK) | queens;
+	while (axialSliders)
+	{
+		int fromSquare = PopLowestSquare(axialSliders);
+		Bitboard targets = GetRookAttacks(fromSquare, occupied) & targetMask;
+		if (IsSquareInMask(pinned, fromSquare))
+		{
+			targets &= GetLineMask(kingSquare, fromSquare);
+		}
+		if (targets)
+		{
+			return true;
+		}
+	}
+
+	// pawns last, their rules are the fiddliest so just generate them
+	ChessMoveList pawnMoves;
+	GeneratePawnMoves(position, pawnMoves, kingSquare, checkMask, pinned);
+	return !pawnMoves.IsEmpty();
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "ChessCore/ChessMove.hpp"
+
+struct ChessPosition;
+
+
+//-----------------------------------------------------------------------------------------------
+// Fills moves with every legal move for position.m_sideToMove (clears the list first).
+// Uses check and pin masks so no move has to be tried on a copy of the position.
+void GenerateLegalMoves(ChessPosition const& position, ChessMoveList& moves);
+
+// Stops at the first legal move found, for mate and stalemate detection
+bool HasAnyLegalMove(ChessPosition const& position);
@@ -0,0 +1,220 @@
+#include "ChessCore/ChessMovePicker.hpp"
+#include "ChessCore/ChessPosition.hpp"
+#include "ChessCore/ChessEvaluate.hpp"
+#include "ChessCore/ChessSEE.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+void ChessHistory::Clear()
+{
+	for (int side = 0; side < PLAYER_SIDE_NUM; ++side)
+	{
+		for (int fromSquare = 0; fromSquare < NUM_SQUARES; ++fromSquare)
+		{
+			for (int toSquare = 0; toSquare < NUM_SQUARES; ++toSquare)
+			{
+				m_scores[side][fromSquare][toSquare] = 0;
+			}
+		}
+	}
+}
+
+void ChessHistory::Age()
+{
+	for (int side = 0; side < PLAYER_SIDE_NUM; ++side)
+	{
+		for (int fromSquare = 0; fromSquare < NUM_SQUARES; ++fromSquare)
+		{
+			for (int toSquare = 0; toSquare < NUM_SQUARES; ++toSquare)
+			{
+				m_scores[side][fromSquare][toSquare] /= 2;
+			}
+		}
+	}
+}
+
+int ChessHistory::GetScore(PlayerSide side, ChessMove const& move) const
+{
+	return m_scores[side][move.GetFromSquare()][move.GetToSquare()];
+}
+
+void ChessHistory::Update(PlayerSide side, ChessMove const& move, int bonus)
+{
+	if (bonus > HISTORY_MAX)
+	{
+		bonus = HISTORY_MAX;
+	}
+	else if (bonus < -HISTORY_MAX)
+	{
+		bonus = -HISTORY_MAX;
+	}
+	int16_t& score = m_scores[side][move.GetFromSquare()][move.GetToSquare()];
+	int absBonus = (bonus < 0) ? -bonus : bonus;
+	score = static_cast<int16_t>(score + bonus - score * absBonus / HISTORY_MAX);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ChessMovePicker::ChessMovePicker(ChessPosition const& position, ChessMoveList& moves, ChessMove const& hashMove, ChessMove const& killer1, ChessMove const& killer2,
+	ChessMove const& counterMove, ChessHistory const& history)
+	: m_position(position)
+	, m_moves(moves)
+	, m_history(history)
+	, m_hashMove(hashMove)
+	, m_killers{ killer1, killer2 }
+	, m_counterMove(counterMove)
+{
+}
+
+bool ChessMovePicker::GetNextMove(ChessMove& out_move)
+{
+	switch (m_stage)
+	{
+	case ChessPickStage::HASH_MOVE:
+		m_stage = ChessPickStage::CAPTURES_INIT;
+		if (PickSpecialMove(m_hashMove, out_move))
+		{
+			return true;
+		}
+		[[fallthrough]];
+
+	case ChessPickStage::CAPTURES_INIT:
+	{
+		// Partition captures and promotions to the front, scoring them on the way
+		m_capturesEndIndex = m_nextIndex;
+		for (int moveIndex = m_nextIndex; moveIndex < m_moves.GetCount(); ++moveIndex)
+		{
+			ChessMove move = m_moves[moveIndex];
+			if (!move.IsCapture() && !move.IsPromotion())
+			{
+				continue;
+			}
+			PieceType victimType = move.IsEnPassant() ? PieceType::PAWN : m_position.GetPieceTypeAt(move.GetToSquare());
+			int victimValue = (victimType != PieceType::UNKNOWN) ? CHESS_PIECE_VALUES[(int)victimType] : 0;
+			int attackerValue = CHESS_PIECE_VALUES[(int)m_position.GetPieceTypeAt(move.GetFromSquare())];
+			int promotionValue = move.IsPromotion() ? CHESS_PIECE_VALUES[(int)move.GetPromotionType()] : 0;
+
+			m_moves[moveIndex] = m_moves[m_capturesEndIndex];
+			m_moves[m_capturesEndIndex] = move;
+			m_scores[m_capturesEndIndex] = (victimValue + promotionValue) * 16 - attackerValue;
+			m_capturesEndIndex++;
+		}
+		m_stage = ChessPickStage::CAPTURES;
+		[[fallthrough]];
+	}
+
+	case ChessPickStage::CAPTURES:
+		while (m_nextIndex < m_capturesEndIndex)
+		{
+			ChessMove move = m_moves[SelectBest(m_capturesEndIndex)];
+			m_nextIndex++;
+			if (!IsStaticExchangeAtLeast(m_position, move, 0))
+			{
+				m_badCaptures[m_numBadCaptures++] = move;
+				continue;
+			}
+			out_move = move;
+			return true;
+		}
+		m_stage = ChessPickStage::KILLER_1;
+		[[fallthrough]];
+
+	case ChessPickStage::KILLER_1:
+		m_stage = ChessPickStage::KILLER_2;
+		if (PickSpecialMove(m_killers[0], out_move))
+		{
+			return true;
+		}
+		[[fallthrough]];
+
+	case ChessPickStage::KILLER_2:
+		m_stage = ChessPickStage::COUNTER_MOVE;
+		if (PickSpecialMove(m_killers[1], out_move))
+		{
+			return true;
+		}
+		[[fallthrough]];
+
+	case ChessPickStage::COUNTER_MOVE:
+		m_stage = ChessPickStage::QUIETS_INIT;
+		if (PickSpecialMove(m_counterMove, out_move))
+		{
+			return true;
+		}
+		[[fallthrough]];
+
+	case ChessPickStage::QUIETS_INIT:
+		for (int moveIndex = m_nextIndex; moveIndex < m_moves.GetCount(); ++moveIndex)
+		{
+			m_scores[moveIndex] = m_history.GetScore(m_position.m_sideToMove, m_moves[moveIndex]);
+		}
+		m_stage = ChessPickStage::QUIETS;
+		[[fallthrough]];
+
+	case ChessPickStage::QUIETS:
+		if (m_nextIndex < m_moves.GetCount())
+		{
+			out_move = m_moves[SelectBest(m_moves.GetCount())];
+			m_nextIndex++;
+			return true;
+		}
+		m_stage = ChessPickStage::BAD_CAPTURES;
+		[[fallthrough]];
+
+	case ChessPickStage::BAD_CAPTURES:
+		if (m_nextBadCaptureIndex < m_numBadCaptures)
+		{
+			out_move = m_badCaptures[m_nextBadCaptureIndex++];
+			return true;
+		}
+		m_stage = ChessPickStage::DONE;
+		[[fallthrough]];
+
+	case ChessPickStage::DONE:
+		return false;
+	}
+	return false;
+}
+
+bool ChessMovePicker::PickSpecialMove(ChessMove const& move, ChessMove& out_move)
+{
+	if (move.IsNone())
+	{
+		return false;
+	}
+
+	// Only moves still waiting in the list count, which proves a killer is legal here and
+	// keeps a move already handed out by an earlier stage from coming back
+	for (int moveIndex = m_nextIndex; moveIndex < m_moves.GetCount(); ++moveIndex)
+	{
+		if (m_moves[moveIndex] == move)
+		{
+			m_moves[moveIndex] = m_moves[m_nextIndex];
+			m_moves[m_nextIndex] = move;
+			m_nextIndex++;
+			out_move = move;
+			return true;
+		}
+	}
+	return false;
+}
+
+int ChessMovePicker::SelectBest(int endIndex)
+{
+	int bestIndex = m_nextIndex;
+	for (int moveIndex = m_nextIndex + 1; moveIndex < endIndex; ++moveIndex)
+	{
+		if (m_scores[moveIndex] > m_scores[bestIndex])
+		{
+			bestIndex = moveIndex;
+		}
+	}
+
+	ChessMove bestMove = m_moves[bestIndex];
+	int bestScore = m_scores[bestIndex];
+	m_moves[bestIndex] = m_moves[m_nextIndex];
+	m_scores[bestIndex] = m_scores[m_nextIndex];
+	m_moves[m_nextIndex] = bestMove;
+	m_scores[m_nextIndex] = bestScore;
+	return m_nextIndex;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "ChessCore/ChessMove.hpp"
+#include "ChessCore/ChessBitboard.hpp"
+
+struct ChessPosition;
+
+
+//-----------------------------------------------------------------------------------------------
+// Butterfly history: how often a quiet move from/to caused a cutoff, per side. Bonuses shrink as a
+// score nears the limit so old successes fade instead of saturating.
+constexpr int HISTORY_MAX = 16384;
+
+struct ChessHistory
+{
+public:
+	void	Clear();
+	void	Age(); // halves every score, between searches
+	int		GetScore(PlayerSide side, ChessMove const& move) const;
+	void	Update(PlayerSide side, ChessMove const& move, int bonus); // negative bonus for a quiet that failed to cut
+
+public:
+	int16_t	m_scores[PLAYER_SIDE_NUM][NUM_SQUARES][NUM_SQUARES];
+};
+
+
+//-----------------------------------------------------------------------------------------------
+enum class ChessPickStage
+{
+	HASH_MOVE,
+	CAPTURES_INIT,
+	CAPTURES, // and promotions, most valuable victim first, then least valuable attacker; losing ones are held back
+	KILLER_1,
+	KILLER_2,
+	COUNTER_MOVE,
+	QUIETS_INIT,
+	QUIETS, // by history
+	BAD_CAPTURES, // captures the static exchange says lose material, in the order they were held back
+	DONE,
+};
+
+// Hands out an already generated legal move list one move at a time, best guess first.
+// Each stage only does its work once the stages before it are used up, so a cutoff on the hash
+// move or a capture never pays for scoring the quiet moves.
+class ChessMovePicker
+{
+public:
+	ChessMovePicker(ChessPosition const& position, ChessMoveList& moves, ChessMove const& hashMove, ChessMove const& killer1, ChessMove const& killer2,
+		ChessMove const& counterMove, ChessHistory const& history);
+
+	bool			GetNextMove(ChessMove& out_move);
+	ChessPickStage	GetStage() const { return m_stage; }
+
+private:
+	bool	PickSpecialMove(ChessMove const& move, ChessMove& out_move); // killers, counter move
+	int		SelectBest(int endIndex); // moves the best scored move of [m_nextIndex, endIndex) to m_nextIndex
+
+private:
+	ChessPosition const&	m_position;
+	ChessMoveList&			m_moves;
+	ChessHistory const&		m_history;
+	ChessMove				m_hashMove;
+	ChessMove				m_killers[2];
+	ChessMove				m_counterMove;
+	ChessPickStage			m_stage = ChessPickStage::HASH_MOVE;
+	int						m_nextIndex = 0;
+	int						m_capturesEndIndex = 0;
+	int						m_scores[MAX_CHESS_MOVES];
+	ChessMove				m_badCaptures[MAX_CHESS_MOVES];
+	int						m_numBadCaptures = 0;
+	int						m_nextBadCaptureIndex = 0;
+};
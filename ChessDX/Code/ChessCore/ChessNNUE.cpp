@@ -0,0 +1,267 @@
+#include "ChessCore/ChessNNUE.hpp"
+#include "ChessCore/ChessPosition.hpp"
+#include "ChessCore/ChessZobrist.hpp"
+#include <fstream>
+#if CHESS_NNUE_SIMD > 0
+#include <immintrin.h>
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+// A move adds at most two features and removes at most two (castling, or a capture with promotion)
+constexpr int MAX_NNUE_CHANGED_FEATURES = 2;
+
+struct PieceFeature
+{
+	PlayerSide	m_side;
+	PieceType	m_type;
+	int			m_square;
+};
+
+static int GetFeatureIndex(PlayerSide perspective, PieceFeature const& piece)
+{
+	int relativeSide = (piece.m_side == perspective) ? 0 : 1;
+	int relativeSquare = (perspective == PLAYER_WHITE) ? piece.m_square : (piece.m_square ^ 56);
+	return ((relativeSide * (int)PieceType::NUM) + (int)piece.m_type) * NUM_SQUARES + relativeSquare;
+}
+
+// output = input + every added column - every removed column, for one perspective's hidden layer
+static void ApplyFeatureColumns(int16_t const* input, int16_t* output, int16_t const* const* addedColumns, int numAdded, int16_t const* const* removedColumns, int numRemoved)
+{
+#if CHESS_NNUE_SIMD == 2
+	for (int valueIndex = 0; valueIndex < NNUE_HIDDEN_SIZE; valueIndex += 16)
+	{
+		__m256i values = _mm256_load_si256(reinterpret_cast<__m256i const*>(input + valueIndex));
+		for (int columnIndex = 0; columnIndex < numAdded; ++columnIndex)
+		{
+			values = _mm256_add_epi16(values, _mm256_load_si256(reinterpret_cast<__m256i const*>(addedColumns[columnIndex] + valueIndex)));
+		}
+		for (int columnIndex = 0; columnIndex < numRemoved; ++columnIndex)
+		{
+			values = _mm256_sub_epi16(values, _mm256_load_si256(reinterpret_cast<__m256i const*>(removedColumns[columnIndex] + valueIndex)));
+		}
+		_mm256_store_si256(reinterpret_cast<__m256i*>(output + valueIndex), values);
+	}
+#elif CHESS_NNUE_SIMD == 1
+	for (int valueIndex = 0; valueIndex < NNUE_HIDDEN_SIZE; valueIndex += 8)
+	{
+		__m128i values = _mm_load_si128(reinterpret_cast<__m128i const*>(input + valueIndex));
+		for (int columnIndex = 0; columnIndex < numAdded; ++columnIndex)
+		{
+			values = _mm_add_epi16(values, _mm_load_si128(reinterpret_cast<__m128i const*>(addedColumns[columnIndex] + valueIndex)));
+		}
+		for (int columnIndex = 0; columnIndex < numRemoved; ++columnIndex)
+		{
+			values = _mm_sub_epi16(values, _mm_load_si128(reinterpret_cast<__m128i const*>(removedColumns[columnIndex] + valueIndex)));
+		}
+		_mm_store_si128(reinterpret_cast<__m128i*>(output + valueIndex), values);
+	}
+#else
+	for (int valueIndex = 0; valueIndex < NNUE_HIDDEN_SIZE; ++valueIndex)
+	{
+		int value = input[valueIndex];
+		for (int columnIndex = 0; columnIndex < numAdded; ++columnIndex)
+		{
+			value += addedColumns[columnIndex][valueIndex];
+		}
+		for (int columnIndex = 0; columnIndex < numRemoved; ++columnIndex)
+		{
+			value -= removedColumns[columnIndex][valueIndex];
+		}
+		output[valueIndex] = static_cast<int16_t>(value);
+	}
+#endif
+}
+
+// Sum of clippedReLU(hidden) * weight over one half of the output layer
+static int32_t GetClippedDotProduct(int16_t const* hidden, int8_t const* weights)
+{
+#if CHESS_NNUE_SIMD == 2
+	__m256i const zero = _mm256_setzero_si256();
+	__m256i const ceiling = _mm256_set1_epi16(NNUE_ACTIVATION_MAX);
+	__m256i const ones = _mm256_set1_epi16(1);
+	__m256i sum = _mm256_setzero_si256();
+	for (int valueIndex = 0; valueIndex < NNUE_HIDDEN_SIZE; valueIndex += 32)
+	{
+		__m256i low = _mm256_load_si256(reinterpret_cast<__m256i const*>(hidden + valueIndex));
+		__m256i high = _mm256_load_si256(reinterpret_cast<__m256i const*>(hidden + valueIndex + 16));
+		low = _mm256_min_epi16(_mm256_max_epi16(low, zero), ceiling);
+		high = _mm256_min_epi16(_mm256_max_epi16(high, zero), ceiling);
+		// packing works per 128-bit lane, the permute puts the 32 bytes back in order
+		__m256i activations = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+		__m256i products = _mm256_maddubs_epi16(activations, _mm256_load_si256(reinterpret_cast<__m256i const*>(weights + valueIndex)));
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+	}
+	__m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, 0x4E));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, 0xB1));
+	return _mm_cvtsi128_si32(sum128);
+#elif CHESS_NNUE_SIMD == 1
+	__m128i const zero = _mm_setzero_si128();
+	__m128i const ceiling = _mm_set1_epi16(NNUE_ACTIVATION_MAX);
+	__m128i const ones = _mm_set1_epi16(1);
+	__m128i sum = _mm_setzero_si128();
+	for (int valueIndex = 0; valueIndex < NNUE_HIDDEN_SIZE; valueIndex += 16)
+	{
+		__m128i low = _mm_load_si128(reinterpret_cast<__m128i const*>(hidden + valueIndex));
+		__m128i high = _mm_load_si128(reinterpret_cast<__m128i const*>(hidden + valueIndex + 8));
+		low = _mm_min_epi16(_mm_max_epi16(low, zero), ceiling);
+		high = _mm_min_epi16(_mm_max_epi16(high, zero), ceiling);
+		__m128i activations = _mm_packus_epi16(low, high);
+		__m128i products = _mm_maddubs_epi16(activations, _mm_load_si128(reinterpret_cast<__m128i const*>(weights + valueIndex)));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(products, ones));
+	}
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+	return _mm_cvtsi128_si32(sum);
+#else
+	int32_t sum = 0;
+	for (int valueIndex = 0; valueIndex < NNUE_HIDDEN_SIZE; ++valueIndex)
+	{
+		int activation = hidden[valueIndex];
+		activation = (activation < 0) ? 0 : ((activation > NNUE_ACTIVATION_MAX) ? NNUE_ACTIVATION_MAX : activation);
+		sum += activation * weights[valueIndex];
+	}
+	return sum;
+#endif
+}
+
+template <typename T>
+static bool ReadValues(std::ifstream& file, T* out_values, int count)
+{
+	file.read(reinterpret_cast<char*>(out_values), static_cast<std::streamsize>(sizeof(T)) * count);
+	return file.good();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool ChessNNUENetwork::LoadFromFile(std::string const& filePath, std::string& out_errorMessage)
+{
+	m_isLoaded = false;
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open())
+	{
+		out_errorMessage = "can't open " + filePath;
+		return false;
+	}
+
+	char magic[4] = {};
+	uint32_t header[3] = {};
+	if (!ReadValues(file, magic, 4) || magic[0] != 'C' || magic[1] != 'D' || magic[2] != 'X' || magic[3] != 'N' || !ReadValues(file, header, 3))
+	{
+		out_errorMessage = filePath + " is not a ChessDX network";
+		return false;
+	}
+	if (header[0] != NNUE_FILE_VERSION || header[1] != static_cast<uint32_t>(NNUE_NUM_FEATURES) || header[2] != static_cast<uint32_t>(NNUE_HIDDEN_SIZE))
+	{
+		out_errorMessage = filePath + " has an unsupported version or layer sizes";
+		return false;
+	}
+
+	if (!ReadValues(file, m_hiddenBiases, NNUE_HIDDEN_SIZE) || !ReadValues(file, &m_featureWeights[0][0], NNUE_NUM_FEATURES * NNUE_HIDDEN_SIZE)
+		|| !ReadValues(file, m_outputWeights, PLAYER_SIDE_NUM * NNUE_HIDDEN_SIZE) || !ReadValues(file, &m_outputBias, 1))
+	{
+		out_errorMessage = filePath + " is truncated";
+		return false;
+	}
+
+	m_isLoaded = true;
+	return true;
+}
+
+void ChessNNUENetwork::InitializeRandom(uint64_t seed)
+{
+	// small enough that no accumulator can overflow int16 with 32 pieces on the board
+	uint64_t state = seed;
+	for (int featureIndex = 0; featureIndex < NNUE_NUM_FEATURES; ++featureIndex)
+	{
+		for (int valueIndex = 0; valueIndex < NNUE_HIDDEN_SIZE; ++valueIndex)
+		{
+			m_featureWeights[featureIndex][valueIndex] = static_cast<int16_t>(static_cast<int>(GetNextSplitMix64(state) % 33) - 16);
+		}
+	}
+	for (int valueIndex = 0; valueIndex < NNUE_HIDDEN_SIZE; ++valueIndex)
+	{
+		m_hiddenBiases[valueIndex] = static_cast<int16_t>(static_cast<int>(GetNextSplitMix64(state) % 65) - 32);
+	}
+	for (int weightIndex = 0; weightIndex < PLAYER_SIDE_NUM * NNUE_HIDDEN_SIZE; ++weightIndex)
+	{
+		m_outputWeights[weightIndex] = static_cast<int8_t>(static_cast<int>(GetNextSplitMix64(state) % 255) - 127);
+	}
+	m_outputBias = 0;
+	m_isLoaded = true;
+}
+
+void ChessNNUENetwork::RefreshAccumulator(ChessPosition const& position, ChessNNUEAccumulator& out_accumulator) const
+{
+	for (int perspective = 0; perspective < PLAYER_SIDE_NUM; ++perspective)
+	{
+		int16_t* values = out_accumulator.m_values[perspective];
+		for (int valueIndex = 0; valueIndex < NNUE_HIDDEN_SIZE; ++valueIndex)
+		{
+			values[valueIndex] = m_hiddenBiases[valueIndex];
+		}
+
+		Bitboard occupied = position.GetOccupied();
+		while (occupied != BITBOARD_EMPTY)
+		{
+			int square = PopLowestSquare(occupied);
+			int featureIndex = GetFeatureIndex(static_cast<PlayerSide>(perspective), { position.GetPlayerSideAt(square), position.GetPieceTypeAt(square), square });
+			int16_t const* column = m_featureWeights[featureIndex];
+			ApplyFeatureColumns(values, values, &column, 1, nullptr, 0);
+		}
+	}
+}
+
+void ChessNNUENetwork::UpdateAccumulator(ChessNNUEAccumulator const& parent, ChessPosition const& position, ChessMove const& move, ChessNNUEAccumulator& out_child) const
+{
+	PlayerSide side = position.m_sideToMove;
+	PlayerSide enemySide = GetOpponentPlayerSide(side);
+	int fromSquare = move.GetFromSquare();
+	int toSquare = move.GetToSquare();
+	PieceType movedType = position.GetPieceTypeAt(fromSquare);
+
+	PieceFeature added[MAX_NNUE_CHANGED_FEATURES];
+	PieceFeature removed[MAX_NNUE_CHANGED_FEATURES];
+	int numAdded = 0;
+	int numRemoved = 0;
+	removed[numRemoved++] = { side, movedType, fromSquare };
+	added[numAdded++] = { side, move.IsPromotion() ? move.GetPromotionType() : movedType, toSquare };
+	if (move.IsEnPassant())
+	{
+		removed[numRemoved++] = { enemySide, PieceType::PAWN, (side == PLAYER_WHITE) ? toSquare - 8 : toSquare + 8 };
+	}
+	else if (move.IsCapture())
+	{
+		removed[numRemoved++] = { enemySide, position.GetPieceTypeAt(toSquare), toSquare };
+	}
+	else if (move.IsCastle())
+	{
+		bool isKingside = move.GetFlag() == MOVE_FLAG_CASTLE_KINGSIDE;
+		removed[numRemoved++] = { side, PieceType::ROOK, isKingside ? fromSquare + 3 : fromSquare - 4 };
+		added[numAdded++] = { side, PieceType::ROOK, isKingside ? fromSquare + 1 : fromSquare - 1 };
+	}
+
+	for (int perspective = 0; perspective < PLAYER_SIDE_NUM; ++perspective)
+	{
+		int16_t const* addedColumns[MAX_NNUE_CHANGED_FEATURES];
+		int16_t const* removedColumns[MAX_NNUE_CHANGED_FEATURES];
+		for (int changeIndex = 0; changeIndex < numAdded; ++changeIndex)
+		{
+			addedColumns[changeIndex] = m_featureWeights[GetFeatureIndex(static_cast<PlayerSide>(perspective), added[changeIndex])];
+		}
+		for (int changeIndex = 0; changeIndex < numRemoved; ++changeIndex)
+		{
+			removedColumns[changeIndex] = m_featureWeights[GetFeatureIndex(static_cast<PlayerSide>(perspective), removed[changeIndex])];
+		}
+		ApplyFeatureColumns(parent.m_values[perspective], out_child.m_values[perspective], addedColumns, numAdded, removedColumns, numRemoved);
+	}
+}
+
+int ChessNNUENetwork::Evaluate(ChessNNUEAccumulator const& accumulator, PlayerSide sideToMove) const
+{
+	int64_t output = m_outputBias;
+	output += GetClippedDotProduct(accumulator.m_values[sideToMove], m_outputWeights);
+	output += GetClippedDotProduct(accumulator.m_values[GetOpponentPlayerSide(sideToMove)], m_outputWeights + NNUE_HIDDEN_SIZE);
+	return static_cast<int>(output * NNUE_EVAL_SCALE / (NNUE_ACTIVATION_MAX * NNUE_OUTPUT_WEIGHT_SCALE));
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "ChessCore/ChessTypes.hpp"
+#include "ChessCore/ChessBitboard.hpp"
+#include "ChessCore/ChessMove.hpp"
+#include <string>
+
+// Vector kernels are picked at compile time: 2 for AVX2, 1 for SSSE3/SSE4, 0 for plain C++.
+// Define CHESS_NNUE_SIMD to override, the network file and the results are the same on every path.
+#if !defined(CHESS_NNUE_SIMD)
+#if defined(__AVX2__)
+#define CHESS_NNUE_SIMD 2
+#elif defined(__SSSE3__) || defined(__SSE4_1__)
+#define CHESS_NNUE_SIMD 1
+#else
+#define CHESS_NNUE_SIMD 0
+#endif
+#endif
+
+struct ChessPosition;
+
+
+//-----------------------------------------------------------------------------------------------
+// 768 inputs per perspective, one per (own or enemy, piece type, square) with the board flipped for black,
+// into a 256 wide int16 layer kept up to date move by move. Both halves, side to move first, are clipped
+// to 0..127 and fed as int8 into a single output neuron.
+constexpr int NNUE_NUM_FEATURES			= 2 * (int)PieceType::NUM * NUM_SQUARES;
+constexpr int NNUE_HIDDEN_SIZE			= 256;
+constexpr int NNUE_ACTIVATION_MAX		= 127; // clipped ReLU ceiling, also what 1.0 is in the hidden layer
+constexpr int NNUE_OUTPUT_WEIGHT_SCALE	= 64; // what 1.0 is in the output weights
+constexpr int NNUE_EVAL_SCALE			= 400; // centipawns per unit of network output
+
+// File layout, little-endian: "CDXN", uint32 version, uint32 feature count, uint32 hidden size,
+// int16 hidden biases[hidden], int16 feature weights[features][hidden], int8 output weights[2 * hidden], int32 output bias
+constexpr uint32_t NNUE_FILE_VERSION	= 1;
+
+
+//-----------------------------------------------------------------------------------------------
+// Hidden layer values as seen by each side, one per search ply
+struct alignas(64) ChessNNUEAccumulator
+{
+	int16_t m_values[PLAYER_SIDE_NUM][NNUE_HIDDEN_SIZE];
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Thread-safe once loaded. Large, allocate it with new.
+class alignas(64) ChessNNUENetwork
+{
+public:
+	bool	LoadFromFile(std::string const& filePath, std::string& out_errorMessage);
+	void	InitializeRandom(uint64_t seed); // untrained weights, for benchmarks and checks only
+	bool	IsLoaded() const { return m_isLoaded; }
+
+	void	RefreshAccumulator(ChessPosition const& position, ChessNNUEAccumulator& out_accumulator) const;
+
+	// position is the one before move, out_child gets parent with only the features the move touches changed
+	void	UpdateAccumulator(ChessNNUEAccumulator const& parent, ChessPosition const& position, ChessMove const& move, ChessNNUEAccumulator& out_child) const;
+
+	// Centipawns from sideToMove's point of view
+	int		Evaluate(ChessNNUEAccumulator const& accumulator, PlayerSide sideToMove) const;
+
+private:
+	int16_t	m_featureWeights[NNUE_NUM_FEATURES][NNUE_HIDDEN_SIZE];
+	int16_t	m_hiddenBiases[NNUE_HIDDEN_SIZE];
+	alignas(64) int8_t m_outputWeights[PLAYER_SIDE_NUM * NNUE_HIDDEN_SIZE];
+	int32_t	m_outputBias = 0;
+	bool	m_isLoaded = false;
+};
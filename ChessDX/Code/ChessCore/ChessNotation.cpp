@@ -0,0 +1,299 @@
+#include "ChessCore/ChessNotation.hpp"
+#include "ChessCore/ChessPosition.hpp"
+#include "ChessCore/ChessMoveGen.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+static char const PIECE_LETTERS[(int)PieceType::NUM] = { 'K', 'Q', 'R', 'B', 'N', 'P' };
+
+static PieceType GetPieceTypeFromSanLetter(char letter)
+{
+	switch (letter)
+	{
+	case 'K': return PieceType::KING;
+	case 'Q': return PieceType::QUEEN;
+	case 'R': return PieceType::ROOK;
+	case 'B': return PieceType::BISHOP;
+	case 'N': return PieceType::KNIGHT;
+	default: return PieceType::UNKNOWN;
+	}
+}
+
+static PieceType GetPieceTypeFromUciLetter(char letter)
+{
+	switch (letter | 0x20)
+	{
+	case 'q': return PieceType::QUEEN;
+	case 'r': return PieceType::ROOK;
+	case 'b': return PieceType::BISHOP;
+	case 'n': return PieceType::KNIGHT;
+	default: return PieceType::UNKNOWN;
+	}
+}
+
+static int WriteSquareNameUnchecked(int square, char* out_text)
+{
+	out_text[0] = static_cast<char>('a' + GetFileOfSquare(square));
+	out_text[1] = static_cast<char>('1' + GetRankOfSquare(square));
+	return 2;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int WriteSquareName(int square, char* out_text, int capacity)
+{
+	if (capacity < MAX_SQUARE_NAME_LENGTH || square < 0 || square >= NUM_SQUARES)
+	{
+		return 0;
+	}
+	int length = WriteSquareNameUnchecked(square, out_text);
+	out_text[length] = '\0';
+	return length;
+}
+
+int ParseSquareName(std::string_view text)
+{
+	if (text.size() != 2)
+	{
+		return SQUARE_NONE;
+	}
+	int file = (text[0] | 0x20) - 'a';
+	int rank = text[1] - '1';
+	if (file < 0 || file > 7 || rank < 0 || rank > 7)
+	{
+		return SQUARE_NONE;
+	}
+	return GetSquareIndex(file, rank);
+}
+
+int WriteUciMove(ChessMove const& move, char* out_text, int capacity)
+{
+	if (capacity < MAX_UCI_MOVE_LENGTH)
+	{
+		return 0;
+	}
+	int length = WriteSquareNameUnchecked(move.GetFromSquare(), out_text);
+	length += WriteSquareNameUnchecked(move.GetToSquare(), out_text + length);
+	if (move.IsPromotion())
+	{
+		out_text[length++] = static_cast<char>(PIECE_LETTERS[(int)move.GetPromotionType()] | 0x20);
+	}
+	out_text[length] = '\0';
+	return length;
+}
+
+bool ParseUciMove(std::string_view text, ChessMoveList const& legalMoves, ChessMove& out_move)
+{
+	if (text.size() != 4 && text.size() != 5)
+	{
+		return false;
+	}
+	int fromSquare = ParseSquareName(text.substr(0, 2));
+	int toSquare = ParseSquareName(text.substr(2, 2));
+	PieceType promotionType = (text.size() == 5) ? GetPieceTypeFromUciLetter(text[4]) : PieceType::UNKNOWN;
+	if (fromSquare == SQUARE_NONE || toSquare == SQUARE_NONE || (text.size() == 5 && promotionType == PieceType::UNKNOWN))
+	{
+		return false;
+	}
+
+	// the legal list supplies the flags, so "e1g1" comes back as a castle and "e5d6" as en passant
+	for (ChessMove const& move : legalMoves)
+	{
+		if (move.GetFromSquare() == fromSquare && move.GetToSquare() == toSquare && move.GetPromotionType() == promotionType)
+		{
+			out_move = move;
+			return true;
+		}
+	}
+	return false;
+}
+
+int WriteSanMove(ChessPosition const& position, ChessMove const& move, ChessMoveList const& legalMoves, char* out_text, int capacity)
+{
+	if (capacity < MAX_SAN_MOVE_LENGTH)
+	{
+		return 0;
+	}
+
+	int length = 0;
+	int fromSquare = move.GetFromSquare();
+	int toSquare = move.GetToSquare();
+	PieceType movedType = position.GetPieceTypeAt(fromSquare);
+
+	if (move.IsCastle())
+	{
+		char const* castleText = (move.GetFlag() == MOVE_FLAG_CASTLE_KINGSIDE) ? "O-O" : "O-O-O";
+		for (; castleText[length] != '\0'; ++length)
+		{
+			out_text[length] = castleText[length];
+		}
+	}
+	else
+	{
+		if (movedType == PieceType::PAWN)
+		{
+			if (move.IsCapture())
+			{
+				out_text[length++] = static_cast<char>('a' + GetFileOfSquare(fromSquare));
+			}
+		}
+		else
+		{
+			out_text[length++] = PIECE_LETTERS[(int)movedType];
+
+			// Disambiguate against other pieces of the same type reaching the same square: file first, then rank, then both
+			bool isAmbiguous = false;
+			bool isFileShared = false;
+			bool isRankShared = false;
+			for (ChessMove const& otherMove : legalMoves)
+			{
+				int otherFromSquare = otherMove.GetFromSquare();
+				if (otherMove.GetToSquare() != toSquare || otherFromSquare == fromSquare || position.GetPieceTypeAt(otherFromSquare) != movedType)
+				{
+					continue;
+				}
+				isAmbiguous = true;
+				isFileShared |= GetFileOfSquare(otherFromSquare) == GetFileOfSquare(fromSquare);
+				isRankShared |= GetRankOfSquare(otherFromSquare) == GetRankOfSquare(fromSquare);
+			}
+			if (isAmbiguous && (!isFileShared || isRankShared))
+			{
+				out_text[length++] = static_cast<char>('a' + GetFileOfSquare(fromSquare));
+			}
+			if (isAmbiguous && isFileShared)
+			{
+				out_text[length++] = static_cast<char>('1' + GetRankOfSquare(fromSquare));
+			}
+		}
+
+		if (move.IsCapture())
+		{
+			out_text[length++] = 'x';
+		}
+		length += WriteSquareNameUnchecked(toSquare, out_text + length);
+
+		if (move.IsPromotion())
+		{
+			out_text[length++] = '=';
+			out_text[length++] = PIECE_LETTERS[(int)move.GetPromotionType()];
+		}
+	}
+
+	ChessPosition positionAfterMove = position;
+	positionAfterMove.ApplyMove(move);
+	if (positionAfterMove.IsInCheck(positionAfterMove.m_sideToMove))
+	{
+		out_text[length++] = HasAnyLegalMove(positionAfterMove) ? '+' : '#';
+	}
+
+	out_text[length] = '\0';
+	return length;
+}
+
+bool ParseSanMove(ChessPosition const& position, std::string_view text, ChessMoveList const& legalMoves, ChessMove& out_move)
+{
+	// Check, mate and annotation suffixes carry nothing the move list doesn't already know
+	while (!text.empty() && (text.back() == '+' || text.back() == '#' || text.back() == '!' || text.back() == '?'))
+	{
+		text.remove_suffix(1);
+	}
+	if (text.size() < 2)
+	{
+		return false;
+	}
+
+	if (text == "O-O" || text == "0-0" || text == "O-O-O" || text == "0-0-0")
+	{
+		ChessMoveFlag castleFlag = (text.size() == 3) ? MOVE_FLAG_CASTLE_KINGSIDE : MOVE_FLAG_CASTLE_QUEENSIDE;
+		for (ChessMove const& move : legalMoves)
+		{
+			if (move.GetFlag() == castleFlag)
+			{
+				out_move = move;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	PieceType movedType = GetPieceTypeFromSanLetter(text[0]);
+	if (movedType == PieceType::UNKNOWN)
+	{
+		movedType = PieceType::PAWN;
+	}
+	else
+	{
+		text.remove_prefix(1);
+	}
+
+	// "e8=Q" and the older "e8Q" both name a promotion
+	PieceType promotionType = PieceType::UNKNOWN;
+	if (movedType == PieceType::PAWN && text.size() >= 3)
+	{
+		promotionType = GetPieceTypeFromSanLetter(text.back());
+		if (promotionType != PieceType::UNKNOWN)
+		{
+			text.remove_suffix(1);
+			if (text.back() == '=')
+			{
+				text.remove_suffix(1);
+			}
+		}
+	}
+
+	if (text.size() < 2)
+	{
+		return false;
+	}
+	int toSquare = ParseSquareName(text.substr(text.size() - 2));
+	if (toSquare == SQUARE_NONE)
+	{
+		return false;
+	}
+	text.remove_suffix(2);
+	if (!text.empty() && (text.back() == 'x' || text.back() == ':'))
+	{
+		text.remove_suffix(1);
+	}
+
+	// whatever is left is the disambiguation: a file, a rank or both
+	int fromFile = -1;
+	int fromRank = -1;
+	for (char glyph : text)
+	{
+		if (glyph >= 'a' && glyph <= 'h' && fromFile < 0)
+		{
+			fromFile = glyph - 'a';
+		}
+		else if (glyph >= '1' && glyph <= '8' && fromRank < 0)
+		{
+			fromRank = glyph - '1';
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	bool isFound = false;
+	for (ChessMove const& move : legalMoves)
+	{
+		int fromSquare = move.GetFromSquare();
+		if (move.GetToSquare() != toSquare || position.GetPieceTypeAt(fromSquare) != movedType || move.GetPromotionType() != promotionType || move.IsCastle())
+		{
+			continue;
+		}
+		if ((fromFile >= 0 && GetFileOfSquare(fromSquare) != fromFile) || (fromRank >= 0 && GetRankOfSquare(fromSquare) != fromRank))
+		{
+			continue;
+		}
+		if (isFound)
+		{
+			// ambiguous
+			return false;
+		}
+		out_move = move;
+		isFound = true;
+	}
+	return isFound;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "ChessCore/ChessMove.hpp"
+#include <string_view>
+
+struct ChessPosition;
+
+
+//-----------------------------------------------------------------------------------------------
+// Text <-> ChessMove conversion for the console, network logs, engine I/O and PGN.
+// Nothing here allocates: writers fill a caller buffer and return the length written (0 when the
+// buffer is too small), parsers match the text against a legal move list the caller generated once.
+constexpr int MAX_SQUARE_NAME_LENGTH	= 3;	// "e4" and terminator
+constexpr int MAX_UCI_MOVE_LENGTH		= 6;	// "e7e8q" and terminator
+constexpr int MAX_SAN_MOVE_LENGTH		= 8;	// "exd8=Q+" or "Qh4xe1#" and terminator
+
+int		WriteSquareName(int square, char* out_text, int capacity);
+int		ParseSquareName(std::string_view text); // case insensitive, SQUARE_NONE when malformed
+
+// Coordinate notation, "e2e4", "e1g1" for castling, "e7e8q" for promotions
+int		WriteUciMove(ChessMove const& move, char* out_text, int capacity);
+bool	ParseUciMove(std::string_view text, ChessMoveList const& legalMoves, ChessMove& out_move);
+
+// Standard algebraic notation with check and mate suffixes, position is the one before the move
+int		WriteSanMove(ChessPosition const& position, ChessMove const& move, ChessMoveList const& legalMoves, char* out_text, int capacity);
+bool	ParseSanMove(ChessPosition const& position, std::string_view text, ChessMoveList const& legalMoves, ChessMove& out_move);
@@ -0,0 +1,139 @@
+#include "ChessCore/ChessParallelSearch.hpp"
+#include <thread>
+
+
+//-----------------------------------------------------------------------------------------------
+ChessParallelSearch::ChessParallelSearch()
+{
+	SetNumThreads(1);
+}
+
+ChessParallelSearch::~ChessParallelSearch()
+{
+	for (ChessSearch* search : m_searches)
+	{
+		delete search;
+	}
+	m_searches.clear();
+}
+
+void ChessParallelSearch::SetNumThreads(int numThreads)
+{
+	if (numThreads <= 0)
+	{
+		unsigned int numHardwareThreads = std::thread::hardware_concurrency();
+		numThreads = (numHardwareThreads > 0) ? static_cast<int>(numHardwareThreads) : 1;
+	}
+
+	while (static_cast<int>(m_searches.size()) > numThreads)
+	{
+		delete m_searches.back();
+		m_searches.pop_back();
+	}
+	while (static_cast<int>(m_searches.size()) < numThreads)
+	{
+		ChessSearch* search = new ChessSearch();
+		search->SetHelperIndex(static_cast<int>(m_searches.size()));
+		search->SetTranspositionTable(m_table);
+		search->SetEvalNetwork(m_network);
+		search->SetTablebases(m_tablebases);
+		m_searches.push_back(search);
+	}
+	m_helperResults.resize(m_searches.size());
+}
+
+int ChessParallelSearch::GetNumThreads() const
+{
+	return static_cast<int>(m_searches.size());
+}
+
+void ChessParallelSearch::SetTranspositionTable(ChessTranspositionTable* table)
+{
+	m_table = table;
+	for (ChessSearch* search : m_searches)
+	{
+		search->SetTranspositionTable(table);
+	}
+}
+
+void ChessParallelSearch::SetEvalNetwork(ChessNNUENetwork const* network)
+{
+	m_network = network;
+	for (ChessSearch* search : m_searches)
+	{
+		search->SetEvalNetwork(network);
+	}
+}
+
+void ChessParallelSearch::SetTablebases(ChessSyzygyTablebases const* tablebases)
+{
+	m_tablebases = tablebases;
+	for (ChessSearch* search : m_searches)
+	{
+		search->SetTablebases(tablebases);
+	}
+}
+
+ChessSearchResult ChessParallelSearch::Search(ChessPosition const& position, uint64_t const* gameKeys, int numGameKeys, ChessSearchLimits const& limits)
+{
+	int numThreads = GetNumThreads();
+	if (numThreads == 1)
+	{
+		return m_searches[0]->Search(position, gameKeys, numGameKeys, limits);
+	}
+
+	// Helpers keep deepening until the main thread is done, whatever ended it
+	ChessSearchLimits helperLimits;
+	helperLimits.m_stopSignal = &m_helperStopSignal;
+	m_helperStopSignal = false;
+
+	std::vector<std::thread> helperThreads;
+	helperThreads.reserve(numThreads - 1);
+	for (int threadIndex = 1; threadIndex < numThreads; ++threadIndex)
+	{
+		helperThreads.emplace_back([this, threadIndex, &position, gameKeys, numGameKeys, &helperLimits]()
+		{
+			m_helperResults[threadIndex] = m_searches[threadIndex]->Search(position, gameKeys, numGameKeys, helperLimits);
+		});
+	}
+
+	ChessSearchResult result = m_searches[0]->Search(position, gameKeys, numGameKeys, limits);
+	m_helperStopSignal = true;
+	for (std::thread& helperThread : helperThreads)
+	{
+		helperThread.join();
+	}
+
+	// A helper that finished a deeper iteration than the main thread knows more, otherwise the main line stands
+	uint64_t totalNodes = result.m_nodes;
+	uint64_t totalBetaCutoffs = result.m_numBetaCutoffs;
+	uint64_t totalFirstMoveCutoffs = result.m_numFirstMoveCutoffs;
+	uint64_t totalTablebaseHits = result.m_tablebaseHits;
+	int bestThreadIndex = 0;
+	for (int threadIndex = 1; threadIndex < numThreads; ++threadIndex)
+	{
+		ChessSearchResult const& helperResult = m_helperResults[threadIndex];
+		totalNodes += helperResult.m_nodes;
+		totalBetaCutoffs += helperResult.m_numBetaCutoffs;
+		totalFirstMoveCutoffs += helperResult.m_numFirstMoveCutoffs;
+		totalTablebaseHits += helperResult.m_tablebaseHits;
+		int bestDepth = (bestThreadIndex == 0) ? result.m_depth : m_helperResults[bestThreadIndex].m_depth;
+		if (helperResult.m_depth > bestDepth && !helperResult.m_bestMove.IsNone())
+		{
+			bestThreadIndex = threadIndex;
+		}
+	}
+	if (bestThreadIndex != 0)
+	{
+		double seconds = result.m_seconds;
+		int hashfullPermille = result.m_hashfullPermille;
+		result = m_helperResults[bestThreadIndex];
+		result.m_seconds = seconds;
+		result.m_hashfullPermille = hashfullPermille;
+	}
+	result.m_nodes = totalNodes;
+	result.m_numBetaCutoffs = totalBetaCutoffs;
+	result.m_numFirstMoveCutoffs = totalFirstMoveCutoffs;
+	result.m_tablebaseHits = totalTablebaseHits;
+	return result;
+}
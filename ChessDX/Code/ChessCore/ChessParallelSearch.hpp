@@ -0,0 +1,34 @@
+#pragma once
+#include "ChessCore/ChessSearch.hpp"
+#include <atomic>
+#include <vector>
+
+
+//-----------------------------------------------------------------------------------------------
+// Lazy SMP: every thread searches the same root through the shared transposition table, helpers at
+// staggered depths. Nothing is split or synchronised beyond the table, the helpers only make it
+// fill faster, so the main thread reaches each depth sooner.
+class ChessParallelSearch
+{
+public:
+	ChessParallelSearch();
+	ChessParallelSearch(ChessParallelSearch const& copy) = delete;
+	~ChessParallelSearch();
+
+	void	SetNumThreads(int numThreads); // calling thread included, 0 for one per hardware thread
+	int		GetNumThreads() const;
+	void	SetTranspositionTable(ChessTranspositionTable* table); // required for helpers to do any good
+	void	SetEvalNetwork(ChessNNUENetwork const* network); // shared read only by every thread
+	void	SetTablebases(ChessSyzygyTablebases const* tablebases); // probed by every thread
+
+	// Blocks the calling thread, which runs the main search while the helpers run beside it
+	ChessSearchResult Search(ChessPosition const& position, uint64_t const* gameKeys, int numGameKeys, ChessSearchLimits const& limits);
+
+private:
+	std::vector<ChessSearch*>		m_searches; // [0] runs on the calling thread
+	std::vector<ChessSearchResult>	m_helperResults;
+	ChessTranspositionTable*		m_table = nullptr;
+	ChessNNUENetwork const*			m_network = nullptr;
+	ChessSyzygyTablebases const*	m_tablebases = nullptr;
+	std::atomic<bool>				m_helperStopSignal = false;
+};
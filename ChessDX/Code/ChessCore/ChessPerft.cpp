@@ -0,0 +1,78 @@
+#include "ChessCore/ChessPerft.hpp"
+#include "ChessCore/ChessPosition.hpp"
+#include "ChessCore/ChessMoveGen.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Depths are picked so the whole suite runs in a few seconds on a release build
+static ChessPerftCase const s_perftCases[] =
+{
+	{ "Start",		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",				6, 119060324ULL },
+	{ "Kiwipete",	"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",	5, 193690690ULL },
+	{ "Position3",	"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",							6, 11030083ULL },
+	{ "Position4",	"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",		5, 15833292ULL },
+	{ "Position5",	"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",				5, 89941194ULL },
+	{ "Position6",	"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",	5, 164075551ULL },
+};
+
+
+//-----------------------------------------------------------------------------------------------
+static uint64_t CountPerftNodes(ChessPosition& position, int depth)
+{
+	ChessMoveList moves;
+	GenerateLegalMoves(position, moves);
+	if (depth == 1)
+	{
+		return static_cast<uint64_t>(moves.GetCount());
+	}
+
+	uint64_t nodes = 0;
+	ChessUndoInfo undo;
+	for (ChessMove const& move : moves)
+	{
+		position.MakeMove(move, undo);
+		nodes += CountPerftNodes(position, depth - 1);
+		position.UnmakeMove(move, undo);
+	}
+	return nodes;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+uint64_t RunPerft(ChessPosition const& position, int depth)
+{
+	if (depth <= 0)
+	{
+		return 1;
+	}
+	ChessPosition workingPosition = position;
+	return CountPerftNodes(workingPosition, depth);
+}
+
+uint64_t RunPerftDivide(ChessPosition const& position, int depth, ChessMoveList& out_rootMoves, uint64_t* out_nodesPerMove)
+{
+	ChessPosition workingPosition = position;
+	GenerateLegalMoves(workingPosition, out_rootMoves);
+
+	uint64_t nodes = 0;
+	ChessUndoInfo undo;
+	for (int moveIndex = 0; moveIndex < out_rootMoves.GetCount(); ++moveIndex)
+	{
+		ChessMove const& move = out_rootMoves[moveIndex];
+		workingPosition.MakeMove(move, undo);
+		out_nodesPerMove[moveIndex] = (depth > 1) ? CountPerftNodes(workingPosition, depth - 1) : 1;
+		workingPosition.UnmakeMove(move, undo);
+		nodes += out_nodesPerMove[moveIndex];
+	}
+	return nodes;
+}
+
+int GetNumChessPerftCases()
+{
+	return static_cast<int>(sizeof(s_perftCases) / sizeof(s_perftCases[0]));
+}
+
+ChessPerftCase const& GetChessPerftCase(int caseIndex)
+{
+	return s_perftCases[caseIndex];
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "ChessCore/ChessMove.hpp"
+#include <cstdint>
+
+struct ChessPosition;
+
+
+//-----------------------------------------------------------------------------------------------
+// Counts leaf nodes of the legal move tree, the last ply is counted straight from the move list
+uint64_t RunPerft(ChessPosition const& position, int depth);
+
+// Same as RunPerft but also reports the count under each root move, out_nodesPerMove needs MAX_CHESS_MOVES slots
+uint64_t RunPerftDivide(ChessPosition const& position, int depth, ChessMoveList& out_rootMoves, uint64_t* out_nodesPerMove);
+
+
+//-----------------------------------------------------------------------------------------------
+// Reference positions with known node counts, used as the correctness gate for rules changes
+struct ChessPerftCase
+{
+	char const*	m_name;
+	char const*	m_fen;
+	int			m_depth;
+	uint64_t	m_expectedNodes;
+};
+
+int						GetNumChessPerftCases();
+ChessPerftCase const&	GetChessPerftCase(int caseIndex);
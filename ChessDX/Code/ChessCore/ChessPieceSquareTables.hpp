@@ -0,0 +1,188 @@
+#pragma once
+#include "ChessCore/ChessTypes.hpp"
+#include "ChessCore/ChessBitboard.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Centipawn values indexed by PieceType, the king is never traded so it counts nothing.
+// These are the middlegame values, move ordering and static exchange use them too.
+constexpr int CHESS_PIECE_VALUES[(int)PieceType::NUM] = { 0, 900, 500, 330, 320, 100 };
+constexpr int CHESS_PIECE_VALUES_ENDGAME[(int)PieceType::NUM] = { 0, 940, 530, 330, 300, 120 };
+
+// Game phase runs from MAX_GAME_PHASE with every piece on the board down to 0 with only kings and pawns
+constexpr int CHESS_PHASE_WEIGHTS[(int)PieceType::NUM] = { 0, 4, 2, 1, 1, 0 };
+constexpr int MAX_GAME_PHASE = 24;
+
+
+//-----------------------------------------------------------------------------------------------
+// Bonuses from white's point of view, laid out as the board is printed: a8 first, h1 last
+constexpr int PIECE_SQUARE_BONUSES_MIDGAME[(int)PieceType::NUM][NUM_SQUARES] =
+{
+	{ // KING, tucked away behind its pawns
+		-30,-40,-40,-50,-50,-40,-40,-30,
+		-30,-40,-40,-50,-50,-40,-40,-30,
+		-30,-40,-40,-50,-50,-40,-40,-30,
+		-30,-40,-40,-50,-50,-40,-40,-30,
+		-20,-30,-30,-40,-40,-30,-30,-20,
+		-10,-20,-20,-20,-20,-20,-20,-10,
+		 20, 20,  0,  0,  0,  0, 20, 20,
+		 20, 30, 10,  0,  0, 10, 30, 20,
+	},
+	{ // QUEEN
+		-20,-10,-10, -5, -5,-10,-10,-20,
+		-10,  0,  0,  0,  0,  0,  0,-10,
+		-10,  0,  5,  5,  5,  5,  0,-10,
+		 -5,  0,  5,  5,  5,  5,  0, -5,
+		  0,  0,  5,  5,  5,  5,  0, -5,
+		-10,  5,  5,  5,  5,  5,  0,-10,
+		-10,  0,  5,  0,  0,  0,  0,-10,
+		-20,-10,-10, -5, -5,-10,-10,-20,
+	},
+	{ // ROOK
+		  0,  0,  0,  0,  0,  0,  0,  0,
+		  5, 10, 10, 10, 10, 10, 10,  5,
+		 -5,  0,  0,  0,  0,  0,  0, -5,
+		 -5,  0,  0,  0,  0,  0,  0, -5,
+		 -5,  0,  0,  0,  0,  0,  0, -5,
+		 -5,  0,  0,  0,  0,  0,  0, -5,
+		 -5,  0,  0,  0,  0,  0,  0, -5,
+		  0,  0,  0,  5,  5,  0,  0,  0,
+	},
+	{ // BISHOP
+		-20,-10,-10,-10,-10,-10,-10,-20,
+		-10,  0,  0,  0,  0,  0,  0,-10,
+		-10,  0,  5, 10, 10,  5,  0,-10,
+		-10,  5,  5, 10, 10,  5,  5,-10,
+		-10,  0, 10, 10, 10, 10,  0,-10,
+		-10, 10, 10, 10, 10, 10, 10,-10,
+		-10,  5,  0,  0,  0,  0,  5,-10,
+		-20,-10,-10,-10,-10,-10,-10,-20,
+	},
+	{ // KNIGHT
+		-50,-40,-30,-30,-30,-30,-40,-50,
+		-40,-20,  0,  0,  0,  0,-20,-40,
+		-30,  0, 10, 15, 15, 10,  0,-30,
+		-30,  5, 15, 20, 20, 15,  5,-30,
+		-30,  0, 15, 20, 20, 15,  0,-30,
+		-30,  5, 10, 15, 15, 10,  5,-30,
+		-40,-20,  0,  5,  5,  0,-20,-40,
+		-50,-40,-30,-30,-30,-30,-40,-50,
+	},
+	{ // PAWN
+		  0,  0,  0,  0,  0,  0,  0,  0,
+		 50, 50, 50, 50, 50, 50, 50, 50,
+		 10, 10, 20, 30, 30, 20, 10, 10,
+		  5,  5, 10, 25, 25, 10,  5,  5,
+		  0,  0,  0, 20, 20,  0,  0,  0,
+		  5, -5,-10,  0,  0,-10, -5,  5,
+		  5, 10, 10,-20,-20, 10, 10,  5,
+		  0,  0,  0,  0,  0,  0,  0,  0,
+	},
+};
+
+constexpr int PIECE_SQUARE_BONUSES_ENDGAME[(int)PieceType::NUM][NUM_SQUARES] =
+{
+	{ // KING, walks to the centre once the queens are off
+		-50,-40,-30,-20,-20,-30,-40,-50,
+		-30,-20,-10,  0,  0,-10,-20,-30,
+		-30,-10, 20, 30, 30, 20,-10,-30,
+		-30,-10, 30, 40, 40, 30,-10,-30,
+		-30,-10, 30, 40, 40, 30,-10,-30,
+		-30,-10, 20, 30, 30, 20,-10,-30,
+		-30,-30,  0,  0,  0,  0,-30,-30,
+		-50,-30,-30,-30,-30,-30,-30,-50,
+	},
+	{ // QUEEN
+		-20,-10,-10, -5, -5,-10,-10,-20,
+		-10,  0,  0,  0,  0,  0,  0,-10,
+		-10,  0,  5,  5,  5,  5,  0,-10,
+		 -5,  0,  5,  5,  5,  5,  0, -5,
+		 -5,  0,  5,  5,  5,  5,  0, -5,
+		-10,  0,  5,  5,  5,  5,  0,-10,
+		-10,  0,  0,  0,  0,  0,  0,-10,
+		-20,-10,-10, -5, -5,-10,-10,-20,
+	},
+	{ // ROOK
+		  0,  0,  0,  0,  0,  0,  0,  0,
+		 10, 10, 10, 10, 10, 10, 10, 10,
+		  0,  0,  0,  0,  0,  0,  0,  0,
+		  0,  0,  0,  0,  0,  0,  0,  0,
+		  0,  0,  0,  0,  0,  0,  0,  0,
+		  0,  0,  0,  0,  0,  0,  0,  0,
+		  0,  0,  0,  0,  0,  0,  0,  0,
+		  0,  0,  0,  0,  0,  0,  0,  0,
+	},
+	{ // BISHOP
+		-20,-10,-10,-10,-10,-10,-10,-20,
+		-10,  0,  0,  0,  0,  0,  0,-10,
+		-10,  0,  5, 10, 10,  5,  0,-10,
+		-10,  0, 10, 15, 15, 10,  0,-10,
+		-10,  0, 10, 15, 15, 10,  0,-10,
+		-10,  0,  5, 10, 10,  5,  0,-10,
+		-10,  0,  0,  0,  0,  0,  0,-10,
+		-20,-10,-10,-10,-10,-10,-10,-20,
+	},
+	{ // KNIGHT
+		-50,-40,-30,-30,-30,-30,-40,-50,
+		-40,-20,  0,  0,  0,  0,-20,-40,
+		-30,  0, 10, 15, 15, 10,  0,-30,
+		-30,  0, 15, 20, 20, 15,  0,-30,
+		-30,  0, 15, 20, 20, 15,  0,-30,
+		-30,  0, 10, 15, 15, 10,  0,-30,
+		-40,-20,  0,  0,  0,  0,-20,-40,
+		-50,-40,-30,-30,-30,-30,-40,-50,
+	},
+	{ // PAWN, the closer to promotion the more it is worth
+		  0,  0,  0,  0,  0,  0,  0,  0,
+		 80, 80, 80, 80, 80, 80, 80, 80,
+		 50, 50, 50, 50, 50, 50, 50, 50,
+		 30, 30, 30, 30, 30, 30, 30, 30,
+		 15, 15, 15, 15, 15, 15, 15, 15,
+		  5,  5,  5,  5,  5,  5,  5,  5,
+		  0,  0,  0,  0,  0,  0,  0,  0,
+		  0,  0,  0,  0,  0,  0,  0,  0,
+	},
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Material plus square bonus for a piece, signed so white pieces count up and black pieces count
+// down; ChessPosition keeps the running sums of these up to date as pieces move
+struct ChessTaperedScore
+{
+	int m_midgame = 0;
+	int m_endgame = 0;
+};
+
+struct ChessPieceSquareTables
+{
+	ChessTaperedScore m_scores[PLAYER_SIDE_NUM][(int)PieceType::NUM][NUM_SQUARES] = {};
+};
+
+constexpr ChessPieceSquareTables GenerateChessPieceSquareTables()
+{
+	ChessPieceSquareTables tables;
+	for (int type = 0; type < (int)PieceType::NUM; ++type)
+	{
+		for (int square = 0; square < NUM_SQUARES; ++square)
+		{
+			// black reads the printed table from its own side of the board
+			int whiteIndex = square ^ 56;
+			int blackIndex = square;
+			tables.m_scores[PLAYER_WHITE][type][square].m_midgame = CHESS_PIECE_VALUES[type] + PIECE_SQUARE_BONUSES_MIDGAME[type][whiteIndex];
+			tables.m_scores[PLAYER_WHITE][type][square].m_endgame = CHESS_PIECE_VALUES_ENDGAME[type] + PIECE_SQUARE_BONUSES_ENDGAME[type][whiteIndex];
+			tables.m_scores[PLAYER_BLACK][type][square].m_midgame = -(CHESS_PIECE_VALUES[type] + PIECE_SQUARE_BONUSES_MIDGAME[type][blackIndex]);
+			tables.m_scores[PLAYER_BLACK][type][square].m_endgame = -(CHESS_PIECE_VALUES_ENDGAME[type] + PIECE_SQUARE_BONUSES_ENDGAME[type][blackIndex]);
+		}
+	}
+	return tables;
+}
+
+inline constexpr ChessPieceSquareTables g_chessPieceSquareTables = GenerateChessPieceSquareTables();
+
+
+//-----------------------------------------------------------------------------------------------
+inline ChessTaperedScore const& GetPieceSquareScore(PlayerSide side, PieceType type, int square)
+{
+	return g_chessPieceSquareTables.m_scores[side][(int)type][square];
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "ChessCore/ChessPosition.hpp"
+#include "ChessCore/ChessMappedFile.hpp"
+#include <string>
+
+
+//-----------------------------------------------------------------------------------------------
+// Polyglot hashes positions with its own fixed keys, not the ones ChessPosition keeps up to date
+uint64_t GetPolyglotKey(ChessPosition const& position);
+
+
+//-----------------------------------------------------------------------------------------------
+struct ChessBookMove
+{
+	ChessMove	m_move = ChessMove::None();
+	int			m_weight = 0; // relative, a move is picked with probability weight / total weight
+};
+
+constexpr int MAX_CHESS_BOOK_MOVES = 32;
+
+
+//-----------------------------------------------------------------------------------------------
+// Polyglot .bin opening book: 16 byte big-endian entries sorted by key, looked up with a binary search.
+// Memory-mapped through ChessMappedFile, thread-safe once open.
+class ChessPolyglotBook
+{
+public:
+	ChessPolyglotBook() = default;
+	ChessPolyglotBook(ChessPolyglotBook const& copy) = delete;
+	~ChessPolyglotBook();
+
+	bool		Open(std::string const& filePath, std::string& out_errorMessage); // closes any book already open
+	void		Close();
+	bool		IsOpen() const { return m_entries != nullptr; }
+	uint64_t	GetNumEntries() const { return m_numEntries; }
+
+	// Legal moves the book has for position, highest weight first. Entries that don't match a legal move are skipped.
+	int			FindMoves(ChessPosition const& position, ChessBookMove* out_moves, int capacity) const;
+
+	// Weighted random pick, randomValue is any uniformly random number. None when the position is not in the book.
+	ChessMove	PickMove(ChessPosition const& position, uint64_t randomValue) const;
+
+private:
+	ChessMappedFile			m_file;
+	unsigned char const*	m_entries = nullptr;
+	uint64_t				m_numEntries = 0;
+};
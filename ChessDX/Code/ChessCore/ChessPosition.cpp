@@ -0,0 +1,781 @@
+#include "ChessCore/ChessPosition.hpp"
+#include "ChessCore/ChessAttacks.hpp"
+#include "ChessCore/ChessZobrist.hpp"
+#include <cstdlib>
+#include <cstring>
+
+
+//-----------------------------------------------------------------------------------------------
+ChessPosition::ChessPosition()
+{
+	memset(m_pieceTypeOnSquare, static_cast<int8_t>(PieceType::UNKNOWN), sizeof(m_pieceTypeOnSquare));
+}
+
+void ChessPosition::Clear()
+{
+	*this = ChessPosition();
+}
+
+void ChessPosition::SetToStartingPosition()
+{
+	Clear();
+
+	PieceType backRank[8] = { PieceType::ROOK, PieceType::KNIGHT, PieceType::BISHOP, PieceType::QUEEN, PieceType::KING, PieceType::BISHOP, PieceType::KNIGHT, PieceType::ROOK };
+	for (int file = 0; file < 8; ++file)
+	{
+		PutPiece(GetSquareIndex(file, 0), backRank[file], PLAYER_WHITE);
+		PutPiece(GetSquareIndex(file, 1), PieceType::PAWN, PLAYER_WHITE);
+		PutPiece(GetSquareIndex(file, 6), PieceType::PAWN, PLAYER_BLACK);
+		PutPiece(GetSquareIndex(file, 7), backRank[file], PLAYER_BLACK);
+	}
+
+	m_sideToMove = PLAYER_WHITE;
+	m_castlingRights = CASTLE_ALL;
+	m_enPassantSquare = SQUARE_NONE;
+	m_halfmoveClock = 0;
+	m_fullmoveNumber = 1;
+	m_key = ComputeKey();
+}
+
+//-----------------------------------------------------------------------------------------------
+// Reads fields straight out of the caller's text, nothing is copied or allocated
+struct ChessFenReader
+{
+public:
+	explicit ChessFenReader(std::string_view text) : m_text(text) {}
+
+	bool IsAtEnd() const { return m_index >= m_text.size(); }
+	char Peek() const { return IsAtEnd() ? '\0' : m_text[m_index]; }
+	char Next() { return IsAtEnd() ? '\0' : m_text[m_index++]; }
+
+	// underscores are accepted as well, so a whole fen fits in one console argument
+	bool SkipSeparator()
+	{
+		if (Peek() != ' ' && Peek() != '_')
+		{
+			return false;
+		}
+		while (Peek() == ' ' || Peek() == '_')
+		{
+			m_index++;
+		}
+		return true;
+	}
+
+	bool ReadNumber(int maxValue, int& out_value)
+	{
+		if (Peek() < '0' || Peek() > '9')
+		{
+			return false;
+		}
+		out_value = 0;
+		while (Peek() >= '0' && Peek() <= '9')
+		{
+			out_value = out_value * 10 + (Next() - '0');
+			if (out_value > maxValue)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+public:
+	std::string_view	m_text;
+	size_t				m_index = 0;
+};
+
+static PieceType GetPieceTypeFromFenGlyph(char glyph)
+{
+	switch (glyph | 0x20)
+	{
+	case 'k': return PieceType::KING;
+	case 'q': return PieceType::QUEEN;
+	case 'r': return PieceType::ROOK;
+	case 'b': return PieceType::BISHOP;
+	case 'n': return PieceType::KNIGHT;
+	case 'p': return PieceType::PAWN;
+	default: return PieceType::UNKNOWN;
+	}
+}
+
+static char GetFenGlyphFromPieceType(PieceType type, PlayerSide side)
+{
+	static char const GLYPHS[(int)PieceType::NUM] = { 'K', 'Q', 'R', 'B', 'N', 'P' };
+	char glyph = GLYPHS[(int)type];
+	return (side == PLAYER_BLACK) ? static_cast<char>(glyph | 0x20) : glyph;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool ChessPosition::SetFromFen(std::string_view fen)
+{
+	if (!ParseFen(fen))
+	{
+		Clear();
+		return false;
+	}
+	return true;
+}
+
+bool ChessPosition::ParseFen(std::string_view fen)
+{
+	Clear();
+	ChessFenReader reader(fen);
+	while (reader.Peek() == ' ')
+	{
+		reader.Next();
+	}
+
+	// Piece placement, rank 8 first, every rank must add up to exactly 8 files
+	int file = 0;
+	int rank = 7;
+	while (!reader.IsAtEnd() && reader.Peek() != ' ' && reader.Peek() != '_')
+	{
+		char glyph = reader.Next();
+		if (glyph == '/')
+		{
+			if (file != 8 || rank == 0)
+			{
+				return false;
+			}
+			file = 0;
+			rank--;
+		}
+		else if (glyph >= '1' && glyph <= '8')
+		{
+			file += glyph - '0';
+			if (file > 8)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			PieceType type = GetPieceTypeFromFenGlyph(glyph);
+			if (type == PieceType::UNKNOWN || file > 7)
+			{
+				return false;
+			}
+			PutPiece(GetSquareIndex(file, rank), type, (glyph >= 'a') ? PLAYER_BLACK : PLAYER_WHITE);
+			file++;
+		}
+	}
+	if (file != 8 || rank != 0)
+	{
+		return false;
+	}
+
+	// Side to move
+	if (!reader.SkipSeparator())
+	{
+		return false;
+	}
+	char sideGlyph = reader.Next();
+	if (sideGlyph != 'w' && sideGlyph != 'b')
+	{
+		return false;
+	}
+	m_sideToMove = (sideGlyph == 'w') ? PLAYER_WHITE : PLAYER_BLACK;
+
+	// Castling rights, en passant and clocks may be left out
+	m_castlingRights = CASTLE_NONE;
+	if (reader.SkipSeparator() && reader.Peek() != '\0')
+	{
+		if (reader.Peek() == '-')
+		{
+			reader.Next();
+		}
+		else
+		{
+			while (!reader.IsAtEnd() && reader.Peek() != ' ' && reader.Peek() != '_')
+			{
+				switch (reader.Next())
+				{
+				case 'K': m_castlingRights |= CASTLE_WHITE_KINGSIDE;	break;
+				case 'Q': m_castlingRights |= CASTLE_WHITE_QUEENSIDE;	break;
+				case 'k': m_castlingRights |= CASTLE_BLACK_KINGSIDE;	break;
+				case 'q': m_castlingRights |= CASTLE_BLACK_QUEENSIDE;	break;
+				default: return false;
+				}
+			}
+		}
+
+		if (reader.SkipSeparator() && reader.Peek() != '\0')
+		{
+			if (reader.Peek() == '-')
+			{
+				reader.Next();
+			}
+			else
+			{
+				char fileGlyph = reader.Next();
+				char rankGlyph = reader.Next();
+				char expectedRank = (m_sideToMove == PLAYER_WHITE) ? '6' : '3';
+				if (fileGlyph < 'a' || fileGlyph > 'h' || rankGlyph != expectedRank)
+				{
+					return false;
+				}
+				m_enPassantSquare = static_cast<int8_t>(GetSquareIndex(fileGlyph - 'a', rankGlyph - '1'));
+			}
+
+			int halfmoveClock = 0;
+			int fullmoveNumber = 1;
+			if (reader.SkipSeparator() && reader.Peek() != '\0')
+			{
+				if (!reader.ReadNumber(255, halfmoveClock))
+				{
+					return false;
+				}
+				if (reader.SkipSeparator() && reader.Peek() != '\0' && !reader.ReadNumber(65535, fullmoveNumber))
+				{
+					return false;
+				}
+			}
+			m_halfmoveClock = static_cast<uint8_t>(halfmoveClock);
+			m_fullmoveNumber = static_cast<uint16_t>((fullmoveNumber > 0) ? fullmoveNumber : 1);
+		}
+	}
+	reader.SkipSeparator();
+	if (!reader.IsAtEnd())
+	{
+		return false;
+	}
+
+	// One king each, no pawns on the back ranks, and the side that just moved can't be left in check
+	if (GetBitCount(GetPieces(PLAYER_WHITE, PieceType::KING)) != 1 || GetBitCount(GetPieces(PLAYER_BLACK, PieceType::KING)) != 1)
+	{
+		return false;
+	}
+	if (GetPieces(PieceType::PAWN) & (RANK_1_MASK | RANK_8_MASK))
+	{
+		return false;
+	}
+	if (IsInCheck(GetOpponentPlayerSide(m_sideToMove)))
+	{
+		return false;
+	}
+
+	// rights whose king or rook is not at home could never be used, drop them so movegen can trust the rest
+	static int const RIGHTS_KING_SQUARES[4] = { 4, 4, 60, 60 };
+	static int const RIGHTS_ROOK_SQUARES[4] = { 7, 0, 63, 56 };
+	for (int rightIndex = 0; rightIndex < 4; ++rightIndex)
+	{
+		PlayerSide side = (rightIndex < 2) ? PLAYER_WHITE : PLAYER_BLACK;
+		bool isKingHome = IsSquareInMask(GetPieces(side, PieceType::KING), RIGHTS_KING_SQUARES[rightIndex]);
+		bool isRookHome = IsSquareInMask(GetPieces(side, PieceType::ROOK), RIGHTS_ROOK_SQUARES[rightIndex]);
+		if (!isKingHome || !isRookHome)
+		{
+			m_castlingRights &= static_cast<uint8_t>(~(1 << rightIndex));
+		}
+	}
+
+	// keep the en passant square only when it can really be taken, same as MakeMove, so equal positions hash equal
+	if (m_enPassantSquare != SQUARE_NONE)
+	{
+		int pushedPawnSquare = (m_sideToMove == PLAYER_WHITE) ? m_enPassantSquare - 8 : m_enPassantSquare + 8;
+		int pawnStartSquare = (m_sideToMove == PLAYER_WHITE) ? m_enPassantSquare + 8 : m_enPassantSquare - 8;
+		if (GetPieceTypeAt(pushedPawnSquare) != PieceType::PAWN || GetPlayerSideAt(pushedPawnSquare) == m_sideToMove || IsOccupied(m_enPassantSquare) || IsOccupied(pawnStartSquare))
+		{
+			return false;
+		}
+		m_enPassantSquare = static_cast<int8_t>(GetEnPassantSquareAfterDoublePush(pawnStartSquare, pushedPawnSquare, GetOpponentPlayerSide(m_sideToMove)));
+	}
+	m_key = ComputeKey();
+	return true;
+}
+
+int ChessPosition::WriteFen(char* out_fen, int capacity) const
+{
+	if (capacity < MAX_FEN_LENGTH)
+	{
+		return 0;
+	}
+
+	int length = 0;
+	for (int rank = 7; rank >= 0; --rank)
+	{
+		int emptyCount = 0;
+		for (int file = 0; file < 8; ++file)
+		{
+			int square = GetSquareIndex(file, rank);
+			PieceType type = GetPieceTypeAt(square);
+			if (type == PieceType::UNKNOWN)
+			{
+				emptyCount++;
+				continue;
+			}
+			if (emptyCount > 0)
+			{
+				out_fen[length++] = static_cast<char>('0' + emptyCount);
+				emptyCount = 0;
+			}
+			out_fen[length++] = GetFenGlyphFromPieceType(type, GetPlayerSideAt(square));
+		}
+		if (emptyCount > 0)
+		{
+			out_fen[length++] = static_cast<char>('0' + emptyCount);
+		}
+		if (rank > 0)
+		{
+			out_fen[length++] = '/';
+		}
+	}
+
+	out_fen[length++] = ' ';
+	out_fen[length++] = (m_sideToMove == PLAYER_WHITE) ? 'w' : 'b';
+
+	out_fen[length++] = ' ';
+	if (m_castlingRights == CASTLE_NONE)
+	{
+		out_fen[length++] = '-';
+	}
+	else
+	{
+		static char const RIGHTS_GLYPHS[4] = { 'K', 'Q', 'k', 'q' };
+		for (int rightIndex = 0; rightIndex < 4; ++rightIndex)
+		{
+			if (HasCastlingRights(static_cast<uint8_t>(1 << rightIndex)))
+			{
+				out_fen[length++] = RIGHTS_GLYPHS[rightIndex];
+			}
+		}
+	}
+
+	out_fen[length++] = ' ';
+	if (m_enPassantSquare == SQUARE_NONE)
+	{
+		out_fen[length++] = '-';
+	}
+	else
+	{
+		out_fen[length++] = static_cast<char>('a' + GetFileOfSquare(m_enPassantSquare));
+		out_fen[length++] = static_cast<char>('1' + GetRankOfSquare(m_enPassantSquare));
+	}
+
+	int clocks[2] = { m_halfmoveClock, m_fullmoveNumber };
+	for (int clock : clocks)
+	{
+		out_fen[length++] = ' ';
+		char digits[5];
+		int numDigits = 0;
+		do
+		{
+			digits[numDigits++] = static_cast<char>('0' + clock % 10);
+			clock /= 10;
+		} while (clock > 0);
+		while (numDigits > 0)
+		{
+			out_fen[length++] = digits[--numDigits];
+		}
+	}
+
+	out_fen[length] = '\0';
+	return length;
+}
+
+void ChessPosition::PutPiece(int square, PieceType type, PlayerSide side)
+{
+	Bitboard mask = GetSquareMask(square);
+	m_piecesByType[(int)type] |= mask;
+	m_piecesBySide[side] |= mask;
+	m_pieceTypeOnSquare[square] = static_cast<int8_t>(type);
+	m_key ^= GetZobristPieceKey(side, type, square);
+	AddPieceSquareScore(side, type, square);
+}
+
+void ChessPosition::RemovePiece(int square)
+{
+	PieceType type = GetPieceTypeAt(square);
+	if (type == PieceType::UNKNOWN)
+	{
+		return;
+	}
+	PlayerSide side = GetPlayerSideAt(square);
+	m_key ^= GetZobristPieceKey(side, type, square);
+	SubtractPieceSquareScore(side, type, square);
+	Bitboard keepMask = ~GetSquareMask(square);
+	m_piecesByType[(int)type] &= keepMask;
+	m_piecesBySide[PLAYER_WHITE] &= keepMask;
+	m_piecesBySide[PLAYER_BLACK] &= keepMask;
+	m_pieceTypeOnSquare[square] = static_cast<int8_t>(PieceType::UNKNOWN);
+}
+
+void ChessPosition::MovePiece(int fromSquare, int toSquare)
+{
+	MovePieceOfType(fromSquare, toSquare, GetPieceTypeAt(fromSquare), GetPlayerSideAt(fromSquare));
+}
+
+void ChessPosition::MovePieceOfType(int fromSquare, int toSquare, PieceType type, PlayerSide side)
+{
+	Bitboard fromToMask = GetSquareMask(fromSquare) | GetSquareMask(toSquare);
+	m_piecesByType[(int)type] ^= fromToMask;
+	m_piecesBySide[side] ^= fromToMask;
+	m_pieceTypeOnSquare[fromSquare] = static_cast<int8_t>(PieceType::UNKNOWN);
+	m_pieceTypeOnSquare[toSquare] = static_cast<int8_t>(type);
+	m_key ^= GetZobristPieceKey(side, type, fromSquare) ^ GetZobristPieceKey(side, type, toSquare);
+	ChessTaperedScore const& fromScore = GetPieceSquareScore(side, type, fromSquare);
+	ChessTaperedScore const& toScore = GetPieceSquareScore(side, type, toSquare);
+	m_pieceSquareScore.m_midgame += toScore.m_midgame - fromScore.m_midgame;
+	m_pieceSquareScore.m_endgame += toScore.m_endgame - fromScore.m_endgame;
+}
+
+void ChessPosition::AddPieceSquareScore(PlayerSide side, PieceType type, int square)
+{
+	ChessTaperedScore const& score = GetPieceSquareScore(side, type, square);
+	m_pieceSquareScore.m_midgame += score.m_midgame;
+	m_pieceSquareScore.m_endgame += score.m_endgame;
+	m_gamePhase = static_cast<uint8_t>(m_gamePhase + CHESS_PHASE_WEIGHTS[(int)type]);
+}
+
+void ChessPosition::SubtractPieceSquareScore(PlayerSide side, PieceType type, int square)
+{
+	ChessTaperedScore const& score = GetPieceSquareScore(side, type, square);
+	m_pieceSquareScore.m_midgame -= score.m_midgame;
+	m_pieceSquareScore.m_endgame -= score.m_endgame;
+	m_gamePhase = static_cast<uint8_t>(m_gamePhase - CHESS_PHASE_WEIGHTS[(int)type]);
+}
+
+int ChessPosition::GetEnPassantSquareAfterDoublePush(int fromSquare, int toSquare, PlayerSide pushingSide) const
+{
+	int skippedSquare = (fromSquare + toSquare) / 2;
+	if (GetPawnAttacks(pushingSide, skippedSquare) & GetPieces(GetOpponentPlayerSide(pushingSide), PieceType::PAWN))
+	{
+		return skippedSquare;
+	}
+	return SQUARE_NONE;
+}
+
+void ChessPosition::MakeMove(ChessMove const& move, ChessUndoInfo& out_undo)
+{
+	int fromSquare = move.GetFromSquare();
+	int toSquare = move.GetToSquare();
+	PlayerSide side = m_sideToMove;
+	PlayerSide enemySide = GetOpponentPlayerSide(side);
+	PieceType movedType = GetPieceTypeAt(fromSquare);
+	ChessMoveFlag flag = move.GetFlag();
+
+	out_undo.m_key = m_key;
+	out_undo.m_capturedType = static_cast<int8_t>(PieceType::UNKNOWN);
+	out_undo.m_castlingRights = m_castlingRights;
+	out_undo.m_enPassantSquare = m_enPassantSquare;
+	out_undo.m_halfmoveClock = m_halfmoveClock;
+
+	if (flag == MOVE_FLAG_EN_PASSANT)
+	{
+		// the captured pawn sits behind the skipped square
+		int capturedSquare = (side == PLAYER_WHITE) ? toSquare - 8 : toSquare + 8;
+		Bitboard capturedMask = GetSquareMask(capturedSquare);
+		m_piecesByType[(int)PieceType::PAWN] ^= capturedMask;
+		m_piecesBySide[enemySide] ^= capturedMask;
+		m_pieceTypeOnSquare[capturedSquare] = static_cast<int8_t>(PieceType::UNKNOWN);
+		m_key ^= GetZobristPieceKey(enemySide, PieceType::PAWN, capturedSquare);
+		SubtractPieceSquareScore(enemySide, PieceType::PAWN, capturedSquare);
+		out_undo.m_capturedType = static_cast<int8_t>(PieceType::PAWN);
+	}
+	else if (move.IsCapture())
+	{
+		PieceType capturedType = GetPieceTypeAt(toSquare);
+		Bitboard capturedMask = GetSquareMask(toSquare);
+		m_piecesByType[(int)capturedType] ^= capturedMask;
+		m_piecesBySide[enemySide] ^= capturedMask;
+		m_key ^= GetZobristPieceKey(enemySide, capturedType, toSquare);
+		SubtractPieceSquareScore(enemySide, capturedType, toSquare);
+		out_undo.m_capturedType = static_cast<int8_t>(capturedType);
+	}
+	else if (flag == MOVE_FLAG_CASTLE_KINGSIDE)
+	{
+		MovePieceOfType(fromSquare + 3, fromSquare + 1, PieceType::ROOK, side);
+	}
+	else if (flag == MOVE_FLAG_CASTLE_QUEENSIDE)
+	{
+		MovePieceOfType(fromSquare - 4, fromSquare - 1, PieceType::ROOK, side);
+	}
+
+	MovePieceOfType(fromSquare, toSquare, movedType, side);
+
+	if (move.IsPromotion())
+	{
+		PieceType promotionType = move.GetPromotionType();
+		Bitboard toMask = GetSquareMask(toSquare);
+		m_piecesByType[(int)PieceType::PAWN] ^= toMask;
+		m_piecesByType[(int)promotionType] ^= toMask;
+		m_pieceTypeOnSquare[toSquare] = static_cast<int8_t>(promotionType);
+		m_key ^= GetZobristPieceKey(side, PieceType::PAWN, toSquare) ^ GetZobristPieceKey(side, promotionType, toSquare);
+		SubtractPieceSquareScore(side, PieceType::PAWN, toSquare);
+		AddPieceSquareScore(side, promotionType, toSquare);
+	}
+
+	m_key ^= GetZobristEnPassantKey(m_enPassantSquare);
+	m_enPassantSquare = static_cast<int8_t>((flag == MOVE_FLAG_DOUBLE_PAWN_PUSH) ? GetEnPassantSquareAfterDoublePush(fromSquare, toSquare, side) : SQUARE_NONE);
+	m_key ^= GetZobristEnPassantKey(m_enPassantSquare);
+
+	if (m_castlingRights != CASTLE_NONE)
+	{
+		m_key ^= GetZobristCastlingKey(m_castlingRights);
+		UpdateCastlingRightsForSquare(fromSquare);
+		UpdateCastlingRightsForSquare(toSquare);
+		m_key ^= GetZobristCastlingKey(m_castlingRights);
+	}
+
+	if (movedType == PieceType::PAWN || out_undo.m_capturedType != static_cast<int8_t>(PieceType::UNKNOWN))
+	{
+		m_halfmoveClock = 0;
+	}
+	else if (m_halfmoveClock < 255)
+	{
+		m_halfmoveClock++;
+	}
+
+	if (side == PLAYER_BLACK)
+	{
+		m_fullmoveNumber++;
+	}
+	m_sideToMove = enemySide;
+	m_key ^= GetZobristSideKey();
+}
+
+void ChessPosition::UnmakeMove(ChessMove const& move, ChessUndoInfo const& undo)
+{
+	int fromSquare = move.GetFromSquare();
+	int toSquare = move.GetToSquare();
+	PlayerSide enemySide = m_sideToMove;
+	PlayerSide side = GetOpponentPlayerSide(enemySide);
+	ChessMoveFlag flag = move.GetFlag();
+
+	m_sideToMove = side;
+	if (side == PLAYER_BLACK)
+	{
+		m_fullmoveNumber--;
+	}
+	m_castlingRights = undo.m_castlingRights;
+	m_enPassantSquare = undo.m_enPassantSquare;
+	m_halfmoveClock = undo.m_halfmoveClock;
+
+	if (move.IsPromotion())
+	{
+		Bitboard toMask = GetSquareMask(toSquare);
+		m_piecesByType[(int)move.GetPromotionType()] ^= toMask;
+		m_piecesByType[(int)PieceType::PAWN] ^= toMask;
+		m_pieceTypeOnSquare[toSquare] = static_cast<int8_t>(PieceType::PAWN);
+		SubtractPieceSquareScore(side, move.GetPromotionType(), toSquare);
+		AddPieceSquareScore(side, PieceType::PAWN, toSquare);
+	}
+
+	MovePieceOfType(toSquare, fromSquare, GetPieceTypeAt(toSquare), side);
+
+	if (flag == MOVE_FLAG_EN_PASSANT)
+	{
+		int capturedSquare = (side == PLAYER_WHITE) ? toSquare - 8 : toSquare + 8;
+		PutPiece(capturedSquare, PieceType::PAWN, enemySide);
+	}
+	else if (move.IsCapture())
+	{
+		PutPiece(toSquare, static_cast<PieceType>(undo.m_capturedType), enemySide);
+	}
+	else if (flag == MOVE_FLAG_CASTLE_KINGSIDE)
+	{
+		MovePieceOfType(fromSquare + 1, fromSquare + 3, PieceType::ROOK, side);
+	}
+	else if (flag == MOVE_FLAG_CASTLE_QUEENSIDE)
+	{
+		MovePieceOfType(fromSquare - 1, fromSquare - 4, PieceType::ROOK, side);
+	}
+
+	// the piece helpers above toggled the key along the way, the saved one is exact
+	m_key = undo.m_key;
+}
+
+ChessMove ChessPosition::CreateMove(int fromSquare, int toSquare, PieceType promotionType /*= PieceType::UNKNOWN*/) const
+{
+	PieceType movedType = GetPieceTypeAt(fromSquare);
+	bool isCapture = IsOccupied(toSquare);
+	int deltaFile = GetFileOfSquare(toSquare) - GetFileOfSquare(fromSquare);
+
+	if (movedType == PieceType::KING && (deltaFile == 2 || deltaFile == -2))
+	{
+		return ChessMove(fromSquare, toSquare, (deltaFile > 0) ? MOVE_FLAG_CASTLE_KINGSIDE : MOVE_FLAG_CASTLE_QUEENSIDE);
+	}
+
+	if (movedType == PieceType::PAWN)
+	{
+		if (toSquare == m_enPassantSquare && deltaFile != 0)
+		{
+			return ChessMove(fromSquare, toSquare, MOVE_FLAG_EN_PASSANT);
+		}
+		int toRank = GetRankOfSquare(toSquare);
+		if ((toRank == 0 || toRank == 7) && promotionType != PieceType::UNKNOWN)
+		{
+			uint8_t promotionBits = 0;
+			switch (promotionType)
+			{
+			case PieceType::BISHOP:	promotionBits = 1; break;
+			case PieceType::ROOK:	promotionBits = 2; break;
+			case PieceType::QUEEN:	promotionBits = 3; break;
+			default: break;
+			}
+			return ChessMove(fromSquare, toSquare, static_cast<ChessMoveFlag>(MOVE_FLAG_PROMOTE_KNIGHT | promotionBits | (isCapture ? MOVE_FLAG_CAPTURE : 0)));
+		}
+		if (toSquare - fromSquare == 16 || fromSquare - toSquare == 16)
+		{
+			return ChessMove(fromSquare, toSquare, MOVE_FLAG_DOUBLE_PAWN_PUSH);
+		}
+	}
+
+	return ChessMove(fromSquare, toSquare, isCapture ? MOVE_FLAG_CAPTURE : MOVE_FLAG_QUIET);
+}
+
+void ChessPosition::ApplyTeleport(int fromSquare, int toSquare)
+{
+	PlayerSide movedSide = GetPlayerSideAt(fromSquare);
+
+	RemovePiece(toSquare);
+	MovePiece(fromSquare, toSquare);
+
+	m_enPassantSquare = SQUARE_NONE;
+	UpdateCastlingRightsForSquare(fromSquare);
+	UpdateCastlingRightsForSquare(toSquare);
+	m_halfmoveClock = 0;
+
+	if (movedSide == PLAYER_BLACK)
+	{
+		m_fullmoveNumber++;
+	}
+	m_sideToMove = GetOpponentPlayerSide(movedSide);
+	m_key = ComputeKey();
+}
+
+PlayerSide ChessPosition::GetPlayerSideAt(int square) const
+{
+	Bitboard mask = GetSquareMask(square);
+	if (m_piecesBySide[PLAYER_WHITE] & mask)
+	{
+		return PLAYER_WHITE;
+	}
+	if (m_piecesBySide[PLAYER_BLACK] & mask)
+	{
+		return PLAYER_BLACK;
+	}
+	return PLAYER_UNKNOWN;
+}
+
+int ChessPosition::GetKingSquare(PlayerSide side) const
+{
+	Bitboard kingMask = GetPieces(side, PieceType::KING);
+	if (kingMask == 0)
+	{
+		return SQUARE_NONE;
+	}
+	return GetLowestSquare(kingMask);
+}
+
+bool ChessPosition::IsSquareAttacked(int square, PlayerSide attackerSide) const
+{
+	return IsSquareAttacked(square, attackerSide, GetOccupied());
+}
+
+bool ChessPosition::IsSquareAttacked(int square, PlayerSide attackerSide, Bitboard occupied) const
+{
+	// Look outwards from the square with each piece's move pattern, cheapest tests first
+	Bitboard attackers = m_piecesBySide[attackerSide] & occupied;
+	if (GetPawnAttacks(GetOpponentPlayerSide(attackerSide), square) & attackers & GetPieces(PieceType::PAWN))
+	{
+		return true;
+	}
+	if (GetKnightAttacks(square) & attackers & GetPieces(PieceType::KNIGHT))
+	{
+		return true;
+	}
+	if (GetKingAttacks(square) & attackers & GetPieces(PieceType::KING))
+	{
+		return true;
+	}
+
+	Bitboard queens = GetPieces(PieceType::QUEEN);
+	Bitboard diagonalSliders = attackers & (GetPieces(PieceType::BISHOP) | queens);
+	if (diagonalSliders && (GetBishopAttacks(square, occupied) & diagonalSliders))
+	{
+		return true;
+	}
+	Bitboard axialSliders = attackers & (GetPieces(PieceType::ROOK) | queens);
+	if (axialSliders && (GetRookAttacks(square, occupied) & axialSliders))
+	{
+		return true;
+	}
+	return false;
+}
+
+bool ChessPosition::IsInCheck(PlayerSide side) const
+{
+	int kingSquare = GetKingSquare(side);
+	if (kingSquare == SQUARE_NONE)
+	{
+		return false;
+	}
+	return IsSquareAttacked(kingSquare, GetOpponentPlayerSide(side));
+}
+
+bool ChessPosition::IsInsufficientMaterial() const
+{
+	if (GetPieces(PieceType::PAWN) | GetPieces(PieceType::ROOK) | GetPieces(PieceType::QUEEN))
+	{
+		return false;
+	}
+
+	// K v K and K+minor v K; otherwise only bishops that all stand on one square color
+	Bitboard knights = GetPieces(PieceType::KNIGHT);
+	Bitboard bishops = GetPieces(PieceType::BISHOP);
+	if (GetBitCount(knights | bishops) <= 1)
+	{
+		return true;
+	}
+	constexpr Bitboard DARK_SQUARES = 0xAA55AA55AA55AA55ULL;
+	return knights == 0 && ((bishops & DARK_SQUARES) == 0 || (bishops & ~DARK_SQUARES) == 0);
+}
+
+Bitboard ChessPosition::GetAttackersTo(int square, Bitboard occupied) const
+{
+	Bitboard queens = GetPieces(PieceType::QUEEN);
+	Bitboard attackers = (GetPawnAttacks(PLAYER_BLACK, square) & GetPieces(PLAYER_WHITE, PieceType::PAWN))
+		| (GetPawnAttacks(PLAYER_WHITE, square) & GetPieces(PLAYER_BLACK, PieceType::PAWN))
+		| (GetKnightAttacks(square) & GetPieces(PieceType::KNIGHT))
+		| (GetKingAttacks(square) & GetPieces(PieceType::KING))
+		| (GetBishopAttacks(square, occupied) & (GetPieces(PieceType::BISHOP) | queens))
+		| (GetRookAttacks(square, occupied) & (GetPieces(PieceType::ROOK) | queens));
+	return attackers & occupied;
+}
+
+uint64_t ChessPosition::ComputeKey() const
+{
+	uint64_t key = 0;
+	for (int square = 0; square < NUM_SQUARES; ++square)
+	{
+		PieceType type = GetPieceTypeAt(square);
+		if (type != PieceType::UNKNOWN)
+		{
+			key ^= GetZobristPieceKey(GetPlayerSideAt(square), type, square);
+		}
+	}
+	key ^= GetZobristCastlingKey(m_castlingRights);
+	key ^= GetZobristEnPassantKey(m_enPassantSquare);
+	if (m_sideToMove == PLAYER_BLACK)
+	{
+		key ^= GetZobristSideKey();
+	}
+	return key;
+}
+
+void ChessPosition::UpdateCastlingRightsForSquare(int square)
+{
+	// Anything moving from or onto a king/rook home square drops the rights tied to it
+	switch (square)
+	{
+	case GetSquareIndex(4, 0): m_castlingRights &= ~CASTLE_WHITE_ANY;		break;
+	case GetSquareIndex(7, 0): m_castlingRights &= ~CASTLE_WHITE_KINGSIDE;	break;
+	case GetSquareIndex(0, 0): m_castlingRights &= ~CASTLE_WHITE_QUEENSIDE;	break;
+	case GetSquareIndex(4, 7): m_castlingRights &= ~CASTLE_BLACK_ANY;		break;
+	case GetSquareIndex(7, 7): m_castlingRights &= ~CASTLE_BLACK_KINGSIDE;	break;
+	case GetSquareIndex(0, 7): m_castlingRights &= ~CASTLE_BLACK_QUEENSIDE;	break;
+	default: break;
+	}
+}
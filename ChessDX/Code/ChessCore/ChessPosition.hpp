@@ -0,0 +1,156 @@
+#pragma once
+#include "ChessCore/ChessTypes.hpp"
+#include "ChessCore/ChessBitboard.hpp"
+#include "ChessCore/ChessMove.hpp"
+#include "ChessCore/ChessPieceSquareTables.hpp"
+#include <string_view>
+
+
+//-----------------------------------------------------------------------------------------------
+enum ChessCastlingRights : uint8_t
+{
+	CASTLE_NONE				= 0,
+	CASTLE_WHITE_KINGSIDE	= 1 << 0,
+	CASTLE_WHITE_QUEENSIDE	= 1 << 1,
+	CASTLE_BLACK_KINGSIDE	= 1 << 2,
+	CASTLE_BLACK_QUEENSIDE	= 1 << 3,
+	CASTLE_WHITE_ANY		= CASTLE_WHITE_KINGSIDE | CASTLE_WHITE_QUEENSIDE,
+	CASTLE_BLACK_ANY		= CASTLE_BLACK_KINGSIDE | CASTLE_BLACK_QUEENSIDE,
+	CASTLE_ALL				= CASTLE_WHITE_ANY | CASTLE_BLACK_ANY,
+};
+
+// Longest fen WriteFen can produce, terminator included
+constexpr int MAX_FEN_LENGTH = 92;
+
+
+//-----------------------------------------------------------------------------------------------
+// Everything MakeMove overwrites that can't be worked out from the move itself
+struct ChessUndoInfo
+{
+	uint64_t	m_key;
+	int8_t		m_capturedType;
+	uint8_t		m_castlingRights;
+	int8_t		m_enPassantSquare;
+	uint8_t		m_halfmoveClock;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Authoritative rules state of a match, the ChessPiece objects only mirror it for rendering.
+// Bitboards for set-wise queries plus a mailbox for piece-on-square lookups, both kept in sync.
+// Kept small and flat so it can be copied around freely by move validation.
+struct ChessPosition
+{
+public:
+	ChessPosition();
+
+	void Clear();
+	void SetToStartingPosition();
+	bool SetFromFen(std::string_view fen); // position is cleared when the fen is malformed or illegal
+	int  WriteFen(char* out_fen, int capacity) const; // returns the length, 0 when capacity is below MAX_FEN_LENGTH
+
+	void PutPiece(int square, PieceType type, PlayerSide side);
+	void RemovePiece(int square);
+	void MovePiece(int fromSquare, int toSquare); // destination must be empty
+
+	// Move must be legal (see ChessRules / ChessMoveGen), updates castling/en passant/clocks and switches side.
+	// No allocation or logging, UnmakeMove with the same undo record restores the position exactly.
+	void MakeMove(ChessMove const& move, ChessUndoInfo& out_undo);
+	void UnmakeMove(ChessMove const& move, ChessUndoInfo const& undo);
+
+	// Builds the flagged move for a from/to pair by looking at the board, the move is not validated
+	ChessMove CreateMove(int fromSquare, int toSquare, PieceType promotionType = PieceType::UNKNOWN) const;
+
+	// Same as MakeMove when the move will never be taken back
+	void ApplyMove(int fromSquare, int toSquare, PieceType promotionType = PieceType::UNKNOWN);
+	void ApplyMove(ChessMove const& move);
+	void ApplyTeleport(int fromSquare, int toSquare);
+
+	PieceType	GetPieceTypeAt(int square) const;
+	PlayerSide	GetPlayerSideAt(int square) const;
+	bool		IsOccupied(int square) const;
+	int			GetKingSquare(PlayerSide side) const;
+	bool		HasCastlingRights(uint8_t rights) const;
+	uint64_t	ComputeKey() const; // full rescan, m_key is kept up to date incrementally
+
+	bool		IsSquareAttacked(int square, PlayerSide attackerSide) const;
+	bool		IsSquareAttacked(int square, PlayerSide attackerSide, Bitboard occupied) const;
+	bool		IsInCheck(PlayerSide side) const;
+	bool		IsInsufficientMaterial() const; // neither side can possibly mate
+	Bitboard	GetAttackersTo(int square, Bitboard occupied) const; // both sides
+
+	Bitboard GetOccupied() const;
+	Bitboard GetPieces(PlayerSide side) const;
+	Bitboard GetPieces(PieceType type) const;
+	Bitboard GetPieces(PlayerSide side, PieceType type) const;
+
+public:
+	Bitboard	m_piecesByType[(int)PieceType::NUM] = {};
+	Bitboard	m_piecesBySide[PLAYER_SIDE_NUM] = {};
+	int8_t		m_pieceTypeOnSquare[NUM_SQUARES]; // PieceType, UNKNOWN when empty
+
+	PlayerSide	m_sideToMove = PLAYER_WHITE;
+	uint8_t		m_castlingRights = CASTLE_NONE;
+	int8_t		m_enPassantSquare = SQUARE_NONE; // square a pawn skipped over last move, only set when an enemy pawn can take it
+	uint8_t		m_halfmoveClock = 0;
+	uint16_t	m_fullmoveNumber = 1;
+	uint64_t	m_key = 0; // zobrist hash of pieces, side to move, castling rights and en passant file
+	ChessTaperedScore m_pieceSquareScore; // material and square bonuses, white minus black, see ComputeEvalBreakdown for a rescan
+	uint8_t		m_gamePhase = 0; // sum of CHESS_PHASE_WEIGHTS, can pass MAX_GAME_PHASE after promotions
+
+private:
+	void UpdateCastlingRightsForSquare(int square);
+	void MovePieceOfType(int fromSquare, int toSquare, PieceType type, PlayerSide side);
+	void AddPieceSquareScore(PlayerSide side, PieceType type, int square);
+	void SubtractPieceSquareScore(PlayerSide side, PieceType type, int square);
+	int  GetEnPassantSquareAfterDoublePush(int fromSquare, int toSquare, PlayerSide pushingSide) const;
+	bool ParseFen(std::string_view fen);
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool ChessPosition::IsOccupied(int square) const
+{
+	return IsSquareInMask(GetOccupied(), square);
+}
+
+inline void ChessPosition::ApplyMove(ChessMove const& move)
+{
+	ChessUndoInfo undo;
+	MakeMove(move, undo);
+}
+
+inline void ChessPosition::ApplyMove(int fromSquare, int toSquare, PieceType promotionType /*= PieceType::UNKNOWN*/)
+{
+	ApplyMove(CreateMove(fromSquare, toSquare, promotionType));
+}
+
+inline PieceType ChessPosition::GetPieceTypeAt(int square) const
+{
+	return static_cast<PieceType>(m_pieceTypeOnSquare[square]);
+}
+
+inline bool ChessPosition::HasCastlingRights(uint8_t rights) const
+{
+	return (m_castlingRights & rights) != 0;
+}
+
+inline Bitboard ChessPosition::GetOccupied() const
+{
+	return m_piecesBySide[PLAYER_WHITE] | m_piecesBySide[PLAYER_BLACK];
+}
+
+inline Bitboard ChessPosition::GetPieces(PlayerSide side) const
+{
+	return m_piecesBySide[side];
+}
+
+inline Bitboard ChessPosition::GetPieces(PieceType type) const
+{
+	return m_piecesByType[(int)type];
+}
+
+inline Bitboard ChessPosition::GetPieces(PlayerSide side, PieceType type) const
+{
+	return m_piecesBySide[side] & m_piecesByType[(int)type];
+}
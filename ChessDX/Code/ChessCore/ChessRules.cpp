@@ -0,0 +1,274 @@
+#include "ChessCore/ChessRules.hpp"
+#include "ChessCore/ChessPosition.hpp"
+#include "ChessCore/ChessAttacks.hpp"
+#include "ChessCore/ChessErrorCheck.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+static ChessMoveResult ValidateKingMove(ChessPosition const& position, int fromSquare, int toSquare)
+{
+	PlayerSide side = position.m_sideToMove;
+	int deltaX = GetFileOfSquare(toSquare) - GetFileOfSquare(fromSquare);
+	int deltaY = GetRankOfSquare(toSquare) - GetRankOfSquare(fromSquare);
+
+	if (IsSquareInMask(GetKingAttacks(fromSquare), toSquare))
+	{
+		return position.IsOccupied(toSquare) ? ChessMoveResult::VALID_CAPTURE_NORMAL : ChessMoveResult::VALID_MOVE_NORMAL;
+	}
+
+	// Check castling
+	uint8_t sideRights = (side == PLAYER_WHITE) ? CASTLE_WHITE_ANY : CASTLE_BLACK_ANY;
+	int startRank = (side == PLAYER_WHITE) ? 0 : 7;
+	if (!position.HasCastlingRights(sideRights) || GetRankOfSquare(fromSquare) != startRank)
+	{
+		return ChessMoveResult::INVALID_CASTLE_KING_HAS_MOVED;
+	}
+	if (deltaY != 0 || GetSquareDistance(fromSquare, toSquare) != 2)
+	{
+		return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
+	}
+
+	PlayerSide opponentSide = GetOpponentPlayerSide(side);
+	if (position.IsSquareAttacked(fromSquare, opponentSide))
+	{
+		return ChessMoveResult::INVALID_CASTLE_OUT_OF_CHECK;
+	}
+
+	bool isKingside = deltaX > 0;
+	uint8_t rights = (side == PLAYER_WHITE) ? (isKingside ? CASTLE_WHITE_KINGSIDE : CASTLE_WHITE_QUEENSIDE) : (isKingside ? CASTLE_BLACK_KINGSIDE : CASTLE_BLACK_QUEENSIDE);
+	int rookSquare = GetSquareIndex(isKingside ? 7 : 0, startRank);
+	if (!position.HasCastlingRights(rights) || position.GetPieceTypeAt(rookSquare) != PieceType::ROOK || position.GetPlayerSideAt(rookSquare) != side)
+	{
+		return ChessMoveResult::INVALID_CASTLE_ROOK_HAS_MOVED;
+	}
+	if (GetBetweenMask(fromSquare, rookSquare) & position.GetOccupied())
+	{
+		return ChessMoveResult::INVALID_CASTLE_PATH_BLOCKED;
+	}
+
+	int step = isKingside ? 1 : -1;
+	if (position.IsSquareAttacked(fromSquare + step, opponentSide) || position.IsSquareAttacked(fromSquare + step + step, opponentSide))
+	{
+		return ChessMoveResult::INVALID_CASTLE_THROUGH_CHECK;
+	}
+
+	return isKingside ? ChessMoveResult::VALID_CASTLE_KINGSIDE : ChessMoveResult::VALID_CASTLE_QUEENSIDE;
+}
+
+static ChessMoveResult ValidatePawnMove(ChessPosition const& position, int fromSquare, int toSquare, PieceType promotionType)
+{
+	PlayerSide side = position.m_sideToMove;
+	int forwardDirection = (side == PLAYER_WHITE) ? 1 : -1;
+	int startRank = (side == PLAYER_WHITE) ? 1 : 6;
+	int endRank = (side == PLAYER_WHITE) ? 7 : 0;
+	int deltaX = GetFileOfSquare(toSquare) - GetFileOfSquare(fromSquare);
+	int deltaY = GetRankOfSquare(toSquare) - GetRankOfSquare(fromSquare);
+
+	// pawn must go forward
+	if (deltaY * forwardDirection <= 0)
+	{
+		return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
+	}
+
+	ChessMoveResult validResult = ChessMoveResult::VALID_MOVE_NORMAL;
+	if (deltaX == 0)
+	{
+		// Move Forward
+		int forwardY = GetSquareDistance(fromSquare, toSquare);
+		if (forwardY > 2)
+		{
+			return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
+		}
+		if (forwardY == 2)
+		{
+			if (GetRankOfSquare(fromSquare) != startRank)
+			{
+				return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
+			}
+			if (position.IsOccupied(fromSquare + 8 * forwardDirection))
+			{
+				return ChessMoveResult::INVALID_MOVE_PATH_BLOCKED;
+			}
+		}
+		if (position.IsOccupied(toSquare))
+		{
+			return ChessMoveResult::INVALID_MOVE_DESTINATION_BLOCKED;
+		}
+	}
+	else
+	{
+		// Move Diagonal
+		if (!IsSquareInMask(GetPawnAttacks(side, fromSquare), toSquare))
+		{
+			return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
+		}
+		if (position.IsOccupied(toSquare))
+		{
+			validResult = ChessMoveResult::VALID_CAPTURE_NORMAL;
+		}
+		else
+		{
+			// Check en passant
+			int capturedSquare = GetSquareIndex(GetFileOfSquare(toSquare), GetRankOfSquare(fromSquare));
+			if (position.GetPieceTypeAt(capturedSquare) != PieceType::PAWN || position.GetPlayerSideAt(capturedSquare) == side)
+			{
+				// not pawn, not opponent
+				return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
+			}
+			if (toSquare != position.m_enPassantSquare)
+			{
+				return ChessMoveResult::INVALID_ENPASSANT_STALE;
+			}
+			validResult = ChessMoveResult::VALID_CAPTURE_ENPASSANT;
+		}
+	}
+
+	// Check Promotion type
+	if (GetRankOfSquare(toSquare) == endRank)
+	{
+		if (promotionType != PieceType::QUEEN && promotionType != PieceType::BISHOP && promotionType != PieceType::ROOK && promotionType != PieceType::KNIGHT)
+		{
+			return ChessMoveResult::INVALID_MOVE_PAWN_WRONG_PROMOTION;
+		}
+		validResult = ChessMoveResult::VALID_MOVE_PROMOTION;
+	}
+
+	return validResult;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ChessMoveResult ValidateChessMoveBasics(ChessPosition const& position, int fromSquare, int toSquare)
+{
+	PlayerSide sideAtFrom = position.GetPlayerSideAt(fromSquare);
+	if (sideAtFrom == PLAYER_UNKNOWN)
+	{
+		return ChessMoveResult::INVALID_MOVE_NO_PIECE;
+	}
+
+	if (sideAtFrom != position.m_sideToMove)
+	{
+		return ChessMoveResult::INVALID_MOVE_NOT_YOUR_PIECE;
+	}
+
+	if (fromSquare == toSquare)
+	{
+		return ChessMoveResult::INVALID_MOVE_ZERO_DISTANCE;
+	}
+
+	if (position.GetPlayerSideAt(toSquare) == sideAtFrom)
+	{
+		return ChessMoveResult::INVALID_MOVE_DESTINATION_BLOCKED;
+	}
+
+	return ChessMoveResult::VALID_MOVE_NORMAL;
+}
+
+ChessMoveResult ValidateChessTeleport(ChessPosition const& position, int fromSquare, int toSquare)
+{
+	ChessMoveResult basicResult = ValidateChessMoveBasics(position, fromSquare, toSquare);
+	if (!IsValid(basicResult))
+	{
+		return basicResult;
+	}
+
+	int toRank = GetRankOfSquare(toSquare);
+	if (position.GetPieceTypeAt(fromSquare) == PieceType::PAWN && (toRank == 0 || toRank == 7))
+	{
+		return ChessMoveResult::INVALID_TELEPORT_PAWN_TO_END_RANK;
+	}
+
+	return basicResult;
+}
+
+static bool DoesMoveLeaveKingInCheck(ChessPosition const& position, int fromSquare, int toSquare, PieceType promotionType)
+{
+	ChessPosition positionAfterMove = position;
+	positionAfterMove.ApplyMove(fromSquare, toSquare, promotionType);
+	return positionAfterMove.IsInCheck(position.m_sideToMove);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ChessMoveResult ValidateChessMove(ChessPosition const& position, int fromSquare, int toSquare, PieceType promotionType /*= PieceType::UNKNOWN*/)
+{
+	ChessMoveResult shapeResult = ValidateChessMoveShape(position, fromSquare, toSquare, promotionType);
+	if (!IsValid(shapeResult))
+	{
+		return shapeResult;
+	}
+
+	if (DoesMoveLeaveKingInCheck(position, fromSquare, toSquare, promotionType))
+	{
+		return ChessMoveResult::INVALID_MOVE_ENDS_IN_CHECK;
+	}
+
+	return shapeResult;
+}
+
+ChessMoveResult ValidateChessMoveShape(ChessPosition const& position, int fromSquare, int toSquare, PieceType promotionType)
+{
+	ChessMoveResult basicResult = ValidateChessMoveBasics(position, fromSquare, toSquare);
+	if (!IsValid(basicResult))
+	{
+		return basicResult;
+	}
+
+	// empty board attacks give the move shape, the occupied lookups below give the path
+	bool isAxial = IsSquareInMask(GetRookAttacks(fromSquare, BITBOARD_EMPTY), toSquare);
+	bool isDiagonal = IsSquareInMask(GetBishopAttacks(fromSquare, BITBOARD_EMPTY), toSquare);
+	ChessMoveResult validResult = position.IsOccupied(toSquare) ? ChessMoveResult::VALID_CAPTURE_NORMAL : ChessMoveResult::VALID_MOVE_NORMAL;
+
+	PieceType type = position.GetPieceTypeAt(fromSquare);
+	switch (type)
+	{
+	case PieceType::KING:
+		return ValidateKingMove(position, fromSquare, toSquare);
+
+	case PieceType::QUEEN:
+		if (!isAxial && !isDiagonal)
+		{
+			return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
+		}
+		if (!IsSquareInMask(GetQueenAttacks(fromSquare, position.GetOccupied()), toSquare))
+		{
+			return ChessMoveResult::INVALID_MOVE_PATH_BLOCKED;
+		}
+		return validResult;
+
+	case PieceType::ROOK:
+		if (!isAxial)
+		{
+			return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
+		}
+		if (!IsSquareInMask(GetRookAttacks(fromSquare, position.GetOccupied()), toSquare))
+		{
+			return ChessMoveResult::INVALID_MOVE_PATH_BLOCKED;
+		}
+		return validResult;
+
+	case PieceType::BISHOP:
+		if (!isDiagonal)
+		{
+			return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
+		}
+		if (!IsSquareInMask(GetBishopAttacks(fromSquare, position.GetOccupied()), toSquare))
+		{
+			return ChessMoveResult::INVALID_MOVE_PATH_BLOCKED;
+		}
+		return validResult;
+
+	case PieceType::KNIGHT:
+		if (!IsSquareInMask(GetKnightAttacks(fromSquare), toSquare))
+		{
+			return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
+		}
+		return validResult;
+
+	case PieceType::PAWN:
+		return ValidatePawnMove(position, fromSquare, toSquare, promotionType);
+
+	default:
+		return ChessMoveResult::UNKNOWN;
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "ChessCore/ChessTypes.hpp"
+
+struct ChessPosition;
+enum class ChessMoveResult;
+
+
+//-----------------------------------------------------------------------------------------------
+// Rule checks run against the ChessPosition only, nothing here touches the render objects.
+// All assume the piece on fromSquare belongs to position.m_sideToMove.
+
+// Checks shared by normal moves and teleporting: piece exists, belongs to the mover, target not own piece
+ChessMoveResult ValidateChessMoveBasics(ChessPosition const& position, int fromSquare, int toSquare);
+
+// Basic checks plus keeping pawns off the first and last rank, since teleports never promote
+ChessMoveResult ValidateChessTeleport(ChessPosition const& position, int fromSquare, int toSquare);
+
+// Full move shape, path, castling, en passant, promotion and king safety checks; returns which kind of valid move it is
+ChessMoveResult ValidateChessMove(ChessPosition const& position, int fromSquare, int toSquare, PieceType promotionType = PieceType::UNKNOWN);
+
+// Same as ValidateChessMove but ignores whether the mover's own king ends up in check
+ChessMoveResult ValidateChessMoveShape(ChessPosition const& position, int fromSquare, int toSquare, PieceType promotionType = PieceType::UNKNOWN);
@@ -0,0 +1,115 @@
+#include "ChessCore/ChessSEE.hpp"
+#include "ChessCore/ChessPosition.hpp"
+#include "ChessCore/ChessAttacks.hpp"
+#include "ChessCore/ChessEvaluate.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// The king is worth more than anything it could win, so walking it into a defended square never pays
+constexpr int SEE_KING_VALUE = 20000;
+
+// At most every piece on the board joins an exchange, plus the move itself
+constexpr int MAX_SEE_SWAPS = 34;
+
+static int GetSeePieceValue(PieceType type)
+{
+	return (type == PieceType::KING) ? SEE_KING_VALUE : CHESS_PIECE_VALUES[(int)type];
+}
+
+// Cheapest piece of that side in attackers, checked pawn up to king
+static PieceType GetLeastValuableAttacker(ChessPosition const& position, Bitboard attackers, PlayerSide side, int& out_square)
+{
+	static PieceType const CHEAPEST_FIRST[(int)PieceType::NUM] = { PieceType::PAWN, PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN, PieceType::KING };
+	for (PieceType type : CHEAPEST_FIRST)
+	{
+		Bitboard pieces = attackers & position.GetPieces(side, type);
+		if (pieces != BITBOARD_EMPTY)
+		{
+			out_square = GetLowestSquare(pieces);
+			return type;
+		}
+	}
+	return PieceType::UNKNOWN;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int GetStaticExchangeScore(ChessPosition const& position, ChessMove const& move)
+{
+	int fromSquare = move.GetFromSquare();
+	int toSquare = move.GetToSquare();
+	if (move.IsCastle())
+	{
+		return 0;
+	}
+
+	Bitboard occupied = position.GetOccupied() & ~GetSquareMask(fromSquare);
+	int swapGains[MAX_SEE_SWAPS];
+	if (move.IsEnPassant())
+	{
+		int capturedSquare = (position.m_sideToMove == PLAYER_WHITE) ? toSquare - 8 : toSquare + 8;
+		occupied &= ~GetSquareMask(capturedSquare);
+		swapGains[0] = CHESS_PIECE_VALUES[(int)PieceType::PAWN];
+	}
+	else
+	{
+		PieceType victimType = position.GetPieceTypeAt(toSquare);
+		swapGains[0] = (victimType != PieceType::UNKNOWN) ? GetSeePieceValue(victimType) : 0;
+	}
+
+	// The piece standing on the square is what the next capture wins
+	int pieceOnSquareValue = GetSeePieceValue(position.GetPieceTypeAt(fromSquare));
+	if (move.IsPromotion())
+	{
+		int promotionValue = CHESS_PIECE_VALUES[(int)move.GetPromotionType()];
+		swapGains[0] += promotionValue - CHESS_PIECE_VALUES[(int)PieceType::PAWN];
+		pieceOnSquareValue = promotionValue;
+	}
+
+	Bitboard diagonalSliders = position.GetPieces(PieceType::BISHOP) | position.GetPieces(PieceType::QUEEN);
+	Bitboard straightSliders = position.GetPieces(PieceType::ROOK) | position.GetPieces(PieceType::QUEEN);
+	Bitboard attackers = position.GetAttackersTo(toSquare, occupied);
+	PlayerSide side = GetOpponentPlayerSide(position.m_sideToMove);
+
+	int numSwaps = 1;
+	while (numSwaps < MAX_SEE_SWAPS)
+	{
+		int attackerSquare = SQUARE_NONE;
+		PieceType attackerType = GetLeastValuableAttacker(position, attackers, side, attackerSquare);
+		if (attackerType == PieceType::UNKNOWN)
+		{
+			break;
+		}
+
+		// Speculative score if this side captures and the exchange then stops
+		swapGains[numSwaps] = pieceOnSquareValue - swapGains[numSwaps - 1];
+		pieceOnSquareValue = GetSeePieceValue(attackerType);
+		numSwaps++;
+
+		// Sliders lined up behind the piece that just left can now join in
+		occupied &= ~GetSquareMask(attackerSquare);
+		if (attackerType != PieceType::KNIGHT)
+		{
+			attackers |= (GetBishopAttacks(toSquare, occupied) & diagonalSliders) | (GetRookAttacks(toSquare, occupied) & straightSliders);
+		}
+		attackers &= occupied;
+		side = GetOpponentPlayerSide(side);
+	}
+
+	// Either side may decline to recapture, so fold the list back from the end
+	while (--numSwaps > 0)
+	{
+		int standScore = -swapGains[numSwaps - 1];
+		if (swapGains[numSwaps] > standScore)
+		{
+			standScore = swapGains[numSwaps];
+		}
+		swapGains[numSwaps - 1] = -standScore;
+	}
+	return swapGains[0];
+}
+
+bool IsStaticExchangeAtLeast(ChessPosition const& position, ChessMove const& move, int threshold)
+{
+	return GetStaticExchangeScore(position, move) >= threshold;
+}
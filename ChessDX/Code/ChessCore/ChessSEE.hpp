@@ -0,0 +1,13 @@
+#pragma once
+#include "ChessCore/ChessMove.hpp"
+
+struct ChessPosition;
+
+
+//-----------------------------------------------------------------------------------------------
+// Static exchange evaluation: the material the side to move comes out with, in centipawns, if both
+// sides keep recapturing on the move's target square with their cheapest piece and either may stop
+// when carrying on would lose. Works for quiet moves too ("does the piece survive there?").
+// Pins are not looked at, so a pinned recapturer still counts.
+int		GetStaticExchangeScore(ChessPosition const& position, ChessMove const& move);
+bool	IsStaticExchangeAtLeast(ChessPosition const& position, ChessMove const& move, int threshold);
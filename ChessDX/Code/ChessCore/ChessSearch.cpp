@@ -0,0 +1,552 @@
+#include "ChessCore/ChessSearch.hpp"
+#include "ChessCore/ChessMoveGen.hpp"
+#include "ChessCore/ChessEvaluate.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// How many nodes pass between looks at the clock and the stop signal, small enough that a stop
+// lands well inside a millisecond even with the network evaluation
+constexpr uint64_t SEARCH_POLL_INTERVAL_MASK = 255;
+
+
+// Lazy SMP helper n skips depth d when ((d + phase) / size) is odd, so neighbouring helpers work on
+// different iterations and fill the shared table ahead of the main thread
+constexpr int NUM_HELPER_SKIP_PATTERNS = 20;
+static int const HELPER_SKIP_SIZES[NUM_HELPER_SKIP_PATTERNS]	= { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+static int const HELPER_SKIP_PHASES[NUM_HELPER_SKIP_PATTERNS]	= { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+// Mate and tablebase scores count plies from the root, the table stores them counted from the node so they stay true at any depth
+static int GetScoreForTable(int score, int ply)
+{
+	if (score >= SCORE_TABLEBASE_WIN_IN_MAX_PLY)
+	{
+		return score + ply;
+	}
+	if (score <= -SCORE_TABLEBASE_WIN_IN_MAX_PLY)
+	{
+		return score - ply;
+	}
+	return score;
+}
+
+static int GetScoreFromTable(int score, int ply)
+{
+	if (score >= SCORE_TABLEBASE_WIN_IN_MAX_PLY)
+	{
+		return score - ply;
+	}
+	if (score <= -SCORE_TABLEBASE_WIN_IN_MAX_PLY)
+	{
+		return score + ply;
+	}
+	return score;
+}
+
+// Wins the fifty-move rule spoils are draws, as they would be in the game
+static int GetTablebaseScore(ChessWdl wdl, int ply)
+{
+	if (wdl == WDL_WIN)
+	{
+		return SCORE_TABLEBASE_WIN - ply;
+	}
+	if (wdl == WDL_LOSS)
+	{
+		return -SCORE_TABLEBASE_WIN + ply;
+	}
+	return SCORE_DRAW;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ChessSearch::ChessSearch()
+{
+	m_history.Clear();
+	for (int fromSquare = 0; fromSquare < NUM_SQUARES; ++fromSquare)
+	{
+		for (int toSquare = 0; toSquare < NUM_SQUARES; ++toSquare)
+		{
+			m_counterMoves[fromSquare][toSquare] = ChessMove::None();
+		}
+	}
+}
+
+void ChessSearch::SetTranspositionTable(ChessTranspositionTable* table)
+{
+	m_table = table;
+}
+
+void ChessSearch::SetHelperIndex(int helperIndex)
+{
+	m_helperIndex = helperIndex;
+}
+
+void ChessSearch::SetEvalNetwork(ChessNNUENetwork const* network)
+{
+	m_network = network;
+}
+
+void ChessSearch::SetTablebases(ChessSyzygyTablebases const* tablebases)
+{
+	m_tablebases = tablebases;
+}
+
+ChessSearchResult ChessSearch::Search(ChessPosition const& position, uint64_t const* gameKeys, int numGameKeys, ChessSearchLimits const& limits)
+{
+	m_position = position;
+	m_limits = limits;
+	m_startTime = (limits.m_startTime != std::chrono::steady_clock::time_point()) ? limits.m_startTime : std::chrono::steady_clock::now();
+	m_timeBudget = GetTimeBudget(limits, position.m_sideToMove);
+	m_nodes = 0;
+	m_tablebaseHits = 0;
+	m_isStopped = false;
+	m_previousPvLength = 0;
+	m_numBetaCutoffs = 0;
+	m_numFirstMoveCutoffs = 0;
+
+	// killers only mean something at the same distance from the same root, history carries over at half weight
+	for (int ply = 0; ply < MAX_SEARCH_PLY; ++ply)
+	{
+		m_killers[ply][0] = ChessMove::None();
+		m_killers[ply][1] = ChessMove::None();
+	}
+	m_history.Age();
+
+	int firstGameKey = (numGameKeys > MAX_SEARCH_GAME_KEYS) ? numGameKeys - MAX_SEARCH_GAME_KEYS : 0;
+	m_numKeys = 0;
+	for (int keyIndex = firstGameKey; keyIndex < numGameKeys; ++keyIndex)
+	{
+		m_keyStack[m_numKeys++] = gameKeys[keyIndex];
+	}
+
+	if (m_network != nullptr)
+	{
+		m_network->RefreshAccumulator(m_position, m_accumulators[0]);
+	}
+
+	ChessSearchResult result;
+	result.m_rootKey = position.m_key;
+
+	ChessMoveList rootMoves;
+	GenerateLegalMoves(m_position, rootMoves);
+	if (rootMoves.IsEmpty())
+	{
+		return result;
+	}
+
+	// A tablebase ending needs no search, the root probe also handles the fifty-move rule the tree probes ignore
+	ChessMove tablebaseMove = ChessMove::None();
+	ChessWdl tablebaseWdl = WDL_DRAW;
+	int tablebaseDtz = 0;
+	if (m_tablebases != nullptr && m_tablebases->ProbeRoot(m_position, tablebaseMove, tablebaseWdl, tablebaseDtz))
+	{
+		result.m_bestMove = tablebaseMove;
+		result.m_pv[0] = tablebaseMove;
+		result.m_pvLength = 1;
+		result.m_score = GetTablebaseScore(tablebaseWdl, 0);
+		result.m_isTablebaseMove = true;
+		result.m_tablebaseHits = 1;
+		result.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+		return result;
+	}
+
+	// Something to play even if the first iteration never finishes
+	result.m_bestMove = rootMoves[0];
+	result.m_pv[0] = rootMoves[0];
+	result.m_pvLength = 1;
+
+	int maxDepth = (m_limits.m_maxDepth < MAX_SEARCH_DEPTH) ? m_limits.m_maxDepth : MAX_SEARCH_DEPTH;
+	for (int depth = 1; depth <= maxDepth; ++depth)
+	{
+		if (m_helperIndex > 0 && depth > 1)
+		{
+			int patternIndex = (m_helperIndex - 1) % NUM_HELPER_SKIP_PATTERNS;
+			if (((depth + HELPER_SKIP_PHASES[patternIndex]) / HELPER_SKIP_SIZES[patternIndex]) % 2 != 0)
+			{
+				continue;
+			}
+		}
+
+		m_isFollowingPv = true;
+		int score = SearchNode(depth, 0, -SCORE_INFINITE, SCORE_INFINITE);
+		if (m_isStopped || m_pvLength[0] == 0)
+		{
+			break;
+		}
+
+		result.m_score = score;
+		result.m_depth = depth;
+		result.m_pvLength = m_pvLength[0];
+		for (int pvIndex = 0; pvIndex < m_pvLength[0]; ++pvIndex)
+		{
+			result.m_pv[pvIndex] = m_pvTable[0][pvIndex];
+			m_previousPv[pvIndex] = m_pvTable[0][pvIndex];
+		}
+		m_previousPvLength = m_pvLength[0];
+		result.m_bestMove = result.m_pv[0];
+
+		// a deeper search can't find a shorter mate than one already inside the horizon
+		int absScore = (score < 0) ? -score : score;
+		if (absScore >= SCORE_MATE_IN_MAX_PLY && SCORE_MATE - absScore <= depth)
+		{
+			break;
+		}
+
+		// an iteration started this late would most likely be cut off and thrown away
+		if (m_timeBudget.m_softMs > 0 && GetElapsedMs() >= m_timeBudget.m_softMs)
+		{
+			break;
+		}
+	}
+
+	result.m_nodes = m_nodes;
+	result.m_tablebaseHits = m_tablebaseHits;
+	result.m_numBetaCutoffs = m_numBetaCutoffs;
+	result.m_numFirstMoveCutoffs = m_numFirstMoveCutoffs;
+	result.m_hashfullPermille = (m_table != nullptr) ? m_table->GetHashfullPermille() : 0;
+	result.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+	return result;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int ChessSearch::SearchNode(int depth, int ply, int alpha, int beta)
+{
+	if (depth <= 0)
+	{
+		return SearchQuiescence(ply, alpha, beta);
+	}
+
+	m_pvLength[ply] = 0;
+	m_nodes++;
+	if ((m_nodes & SEARCH_POLL_INTERVAL_MASK) == 0 && IsOutOfLimits())
+	{
+		m_isStopped = true;
+	}
+	if (m_isStopped)
+	{
+		return 0;
+	}
+
+	if (ply > 0 && IsDrawByRule())
+	{
+		return SCORE_DRAW;
+	}
+
+	ChessMove firstMove = ChessMove::None();
+	ChessTTData ttData;
+	if (m_table != nullptr && m_table->Probe(m_position.m_key, ttData))
+	{
+		firstMove = ttData.m_move;
+		if (ply > 0 && ttData.m_depth >= depth)
+		{
+			int ttScore = GetScoreFromTable(ttData.m_score, ply);
+			if (ttData.m_bound == BOUND_EXACT || (ttData.m_bound == BOUND_LOWER && ttScore >= beta) || (ttData.m_bound == BOUND_UPPER && ttScore <= alpha))
+			{
+				return ttScore;
+			}
+		}
+	}
+
+	// Right after a capture or pawn move the clock can't turn the table's result, before that it might
+	if (ply > 0 && m_tablebases != nullptr && m_position.m_halfmoveClock == 0 && m_tablebases->CanProbe(m_position))
+	{
+		ChessWdl wdl = WDL_DRAW;
+		if (m_tablebases->ProbeWdl(m_position, wdl))
+		{
+			m_tablebaseHits++;
+			int score = GetTablebaseScore(wdl, ply);
+			ChessBound bound = (wdl == WDL_WIN) ? BOUND_LOWER : ((wdl == WDL_LOSS) ? BOUND_UPPER : BOUND_EXACT);
+			if (bound == BOUND_EXACT || (bound == BOUND_LOWER && score >= beta) || (bound == BOUND_UPPER && score <= alpha))
+			{
+				if (m_table != nullptr)
+				{
+					int tableDepth = (depth + 6 < MAX_SEARCH_DEPTH) ? depth + 6 : MAX_SEARCH_DEPTH;
+					m_table->Store(m_position.m_key, ChessMove::None(), GetScoreForTable(score, ply), tableDepth, bound);
+				}
+				return score;
+			}
+		}
+	}
+
+	if (m_isFollowingPv && ply < m_previousPvLength)
+	{
+		firstMove = m_previousPv[ply];
+	}
+	else
+	{
+		m_isFollowingPv = false;
+	}
+
+	if (ply >= MAX_SEARCH_PLY - 1)
+	{
+		return Evaluate(ply);
+	}
+
+	ChessMoveList moves;
+	GenerateLegalMoves(m_position, moves);
+	if (moves.IsEmpty())
+	{
+		return m_position.IsInCheck(m_position.m_sideToMove) ? -SCORE_MATE + ply : SCORE_DRAW;
+	}
+
+	ChessMove counterMove = ChessMove::None();
+	if (ply > 0)
+	{
+		counterMove = m_counterMoves[m_movesMade[ply - 1].GetFromSquare()][m_movesMade[ply - 1].GetToSquare()];
+	}
+	ChessMovePicker picker(m_position, moves, firstMove, m_killers[ply][0], m_killers[ply][1], counterMove, m_history);
+
+	int originalAlpha = alpha;
+	int bestScore = -SCORE_INFINITE;
+	ChessMove bestMove = ChessMove::None();
+	int numMovesSearched = 0;
+	ChessMove failedQuiets[MAX_CHESS_MOVES];
+	int numFailedQuiets = 0;
+
+	ChessMove move;
+	while (picker.GetNextMove(move))
+	{
+		ChessUndoInfo undo;
+		MakeSearchMove(ply, move, undo);
+		int score = -SearchNode(depth - 1, ply + 1, -beta, -alpha);
+		UnmakeSearchMove(move, undo);
+		numMovesSearched++;
+
+		// only the first child can continue the previous line
+		m_isFollowingPv = false;
+		if (m_isStopped)
+		{
+			return 0;
+		}
+
+		bool isQuiet = !move.IsCapture() && !move.IsPromotion();
+		if (score > bestScore)
+		{
+			bestScore = score;
+			if (score > alpha)
+			{
+				alpha = score;
+				bestMove = move;
+				m_pvTable[ply][0] = move;
+				for (int childIndex = 0; childIndex < m_pvLength[ply + 1]; ++childIndex)
+				{
+					m_pvTable[ply][childIndex + 1] = m_pvTable[ply + 1][childIndex];
+				}
+				m_pvLength[ply] = m_pvLength[ply + 1] + 1;
+				if (score >= beta)
+				{
+					m_numBetaCutoffs++;
+					if (numMovesSearched == 1)
+					{
+						m_numFirstMoveCutoffs++;
+					}
+					if (isQuiet)
+					{
+						UpdateQuietMoveStats(depth, ply, move, failedQuiets, numFailedQuiets);
+					}
+					break;
+				}
+			}
+		}
+		if (isQuiet)
+		{
+			failedQuiets[numFailedQuiets++] = move;
+		}
+	}
+
+	if (m_table != nullptr)
+	{
+		ChessBound bound = (bestScore >= beta) ? BOUND_LOWER : ((bestScore > originalAlpha) ? BOUND_EXACT : BOUND_UPPER);
+		m_table->Store(m_position.m_key, bestMove, GetScoreForTable(bestScore, ply), depth, bound);
+	}
+	return bestScore;
+}
+
+int ChessSearch::SearchQuiescence(int ply, int alpha, int beta)
+{
+	m_pvLength[ply] = 0;
+	m_nodes++;
+	if ((m_nodes & SEARCH_POLL_INTERVAL_MASK) == 0 && IsOutOfLimits())
+	{
+		m_isStopped = true;
+	}
+	if (m_isStopped)
+	{
+		return 0;
+	}
+
+	if (ply > 0 && IsDrawByRule())
+	{
+		return SCORE_DRAW;
+	}
+	if (ply >= MAX_SEARCH_PLY - 1)
+	{
+		return Evaluate(ply);
+	}
+
+	// Out of check the side to move can stand pat on the static score, in check every evasion is tried
+	bool isInCheck = m_position.IsInCheck(m_position.m_sideToMove);
+	int bestScore = -SCORE_INFINITE;
+	if (!isInCheck)
+	{
+		bestScore = Evaluate(ply);
+		if (bestScore >= beta)
+		{
+			return bestScore;
+		}
+		if (bestScore > alpha)
+		{
+			alpha = bestScore;
+		}
+	}
+
+	ChessMoveList moves;
+	GenerateLegalMoves(m_position, moves);
+	if (moves.IsEmpty())
+	{
+		return isInCheck ? -SCORE_MATE + ply : SCORE_DRAW;
+	}
+	if (!isInCheck)
+	{
+		int numTacticalMoves = 0;
+		for (int moveIndex = 0; moveIndex < moves.GetCount(); ++moveIndex)
+		{
+			if (moves[moveIndex].IsCapture() || moves[moveIndex].IsPromotion())
+			{
+				moves[numTacticalMoves++] = moves[moveIndex];
+			}
+		}
+		moves.m_count = numTacticalMoves;
+	}
+
+	ChessMove none = ChessMove::None();
+	ChessMovePicker picker(m_position, moves, none, none, none, none, m_history);
+	ChessMove move;
+	while (picker.GetNextMove(move))
+	{
+		if (!isInCheck && picker.GetStage() == ChessPickStage::BAD_CAPTURES)
+		{
+			break;
+		}
+
+		ChessUndoInfo undo;
+		MakeSearchMove(ply, move, undo);
+		int score = -SearchQuiescence(ply + 1, -beta, -alpha);
+		UnmakeSearchMove(move, undo);
+		if (m_isStopped)
+		{
+			return 0;
+		}
+
+		if (score > bestScore)
+		{
+			bestScore = score;
+			if (score > alpha)
+			{
+				alpha = score;
+				m_pvTable[ply][0] = move;
+				for (int childIndex = 0; childIndex < m_pvLength[ply + 1]; ++childIndex)
+				{
+					m_pvTable[ply][childIndex + 1] = m_pvTable[ply + 1][childIndex];
+				}
+				m_pvLength[ply] = m_pvLength[ply + 1] + 1;
+				if (score >= beta)
+				{
+					break;
+				}
+			}
+		}
+	}
+	return bestScore;
+}
+
+void ChessSearch::MakeSearchMove(int ply, ChessMove const& move, ChessUndoInfo& out_undo)
+{
+	// the child's accumulator is built from this position, before the move changes it
+	if (m_network != nullptr)
+	{
+		m_network->UpdateAccumulator(m_accumulators[ply], m_position, move, m_accumulators[ply + 1]);
+	}
+	m_movesMade[ply] = move;
+	m_keyStack[m_numKeys++] = m_position.m_key;
+	m_position.MakeMove(move, out_undo);
+}
+
+void ChessSearch::UnmakeSearchMove(ChessMove const& move, ChessUndoInfo const& undo)
+{
+	// the parent's accumulator was never touched, nothing to take back there
+	m_position.UnmakeMove(move, undo);
+	m_numKeys--;
+}
+
+int ChessSearch::Evaluate(int ply) const
+{
+	if (m_network == nullptr)
+	{
+		return EvaluatePosition(m_position);
+	}
+
+	// an untrained or odd network must never produce something that reads as a mate or tablebase score
+	int score = m_network->Evaluate(m_accumulators[ply], m_position.m_sideToMove);
+	int const maxScore = SCORE_TABLEBASE_WIN_IN_MAX_PLY - 1;
+	return (score > maxScore) ? maxScore : ((score < -maxScore) ? -maxScore : score);
+}
+
+bool ChessSearch::IsDrawByRule() const
+{
+	if (m_position.m_halfmoveClock >= 100 || m_position.IsInsufficientMaterial())
+	{
+		return true;
+	}
+
+	// A single repetition is scored as a draw, whoever could force the first one can force the third
+	int oldestIndex = m_numKeys - static_cast<int>(m_position.m_halfmoveClock);
+	for (int keyIndex = m_numKeys - 2; keyIndex >= 0 && keyIndex >= oldestIndex; keyIndex -= 2)
+	{
+		if (m_keyStack[keyIndex] == m_position.m_key)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ChessSearch::IsOutOfLimits() const
+{
+	if (m_limits.m_stopSignal != nullptr && m_limits.m_stopSignal->load(std::memory_order_relaxed))
+	{
+		return true;
+	}
+	if (m_limits.m_maxNodes != 0 && m_nodes >= m_limits.m_maxNodes)
+	{
+		return true;
+	}
+	return m_timeBudget.m_hardMs > 0 && GetElapsedMs() >= m_timeBudget.m_hardMs;
+}
+
+int64_t ChessSearch::GetElapsedMs() const
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+}
+
+void ChessSearch::UpdateQuietMoveStats(int depth, int ply, ChessMove const& cutoffMove, ChessMove const* failedQuiets, int numFailedQuiets)
+{
+	if (m_killers[ply][0] != cutoffMove)
+	{
+		m_killers[ply][1] = m_killers[ply][0];
+		m_killers[ply][0] = cutoffMove;
+	}
+	if (ply > 0)
+	{
+		m_counterMoves[m_movesMade[ply - 1].GetFromSquare()][m_movesMade[ply - 1].GetToSquare()] = cutoffMove;
+	}
+
+	// deeper cutoffs say more, and the quiet moves tried before this one are pushed down by as much
+	int bonus = depth * depth;
+	PlayerSide side = m_position.m_sideToMove;
+	m_history.Update(side, cutoffMove, bonus);
+	for (int failedIndex = 0; failedIndex < numFailedQuiets; ++failedIndex)
+	{
+		m_history.Update(side, failedQuiets[failedIndex], -bonus);
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "ChessCore/ChessPosition.hpp"
+#include "ChessCore/ChessTranspositionTable.hpp"
+#include "ChessCore/ChessMovePicker.hpp"
+#include "ChessCore/ChessNNUE.hpp"
+#include "ChessCore/ChessSyzygy.hpp"
+#include "ChessCore/ChessTimeManager.hpp"
+#include <atomic>
+#include <chrono>
+
+
+//-----------------------------------------------------------------------------------------------
+constexpr int MAX_SEARCH_PLY		= 128;
+constexpr int MAX_SEARCH_DEPTH		= 64;
+constexpr int MAX_SEARCH_GAME_KEYS	= 128; // reaches back past the 100 plies the fifty-move rule allows
+
+constexpr int SCORE_DRAW			= 0;
+constexpr int SCORE_MATE			= 32000; // mate at the root, mate in n plies scores SCORE_MATE - n
+constexpr int SCORE_INFINITE		= 32001;
+constexpr int SCORE_MATE_IN_MAX_PLY	= SCORE_MATE - MAX_SEARCH_PLY; // anything beyond this is a forced mate
+constexpr int SCORE_TABLEBASE_WIN	= SCORE_MATE_IN_MAX_PLY - 1; // tablebase win at the root, n plies away scores SCORE_TABLEBASE_WIN - n
+constexpr int SCORE_TABLEBASE_WIN_IN_MAX_PLY = SCORE_TABLEBASE_WIN - MAX_SEARCH_PLY; // anything beyond this is a proven win
+
+
+//-----------------------------------------------------------------------------------------------
+struct ChessSearchLimits
+{
+	int							m_maxDepth = MAX_SEARCH_DEPTH;
+	int							m_moveTimeMs = 0; // 0 for no fixed time per move
+	int							m_timeLeftMs[PLAYER_SIDE_NUM] = {}; // each side's clock, 0 when not playing on a clock
+	int							m_incrementMs[PLAYER_SIDE_NUM] = {}; // added to a side's clock after each of its moves
+	int							m_movesToGo = 0; // moves until the clock is topped up, 0 for sudden death
+	uint64_t					m_maxNodes = 0; // 0 for no node limit
+	std::atomic<bool> const*	m_stopSignal = nullptr; // owned by the caller, polled so another thread can cut the search short
+	std::chrono::steady_clock::time_point m_startTime; // when the clock started on this move, left default it starts in Search
+};
+
+struct ChessSearchResult
+{
+	uint64_t	m_rootKey = 0; // key of the searched position, lets the receiver drop results that went stale
+	ChessMove	m_bestMove = ChessMove::None(); // none only when the root has no legal move
+	int			m_score = 0; // centipawns for the side to move at the root
+	int			m_depth = 0; // deepest completed iteration
+	uint64_t	m_nodes = 0;
+	double		m_seconds = 0.0;
+	int			m_hashfullPermille = 0;
+	uint64_t	m_numBetaCutoffs = 0;
+	uint64_t	m_numFirstMoveCutoffs = 0; // cutoffs by the first move searched, the share of these measures move ordering
+	int			m_pvLength = 0;
+	ChessMove	m_pv[MAX_SEARCH_PLY];
+	bool		m_isBookMove = false; // taken from an opening book, nothing was searched
+	bool		m_isTablebaseMove = false; // taken from the endgame tablebases at the root, nothing was searched
+	uint64_t	m_tablebaseHits = 0; // positions the tablebases scored, root included
+
+	double		GetFirstMoveCutoffPercent() const { return (m_numBetaCutoffs > 0) ? 100.0 * static_cast<double>(m_numFirstMoveCutoffs) / static_cast<double>(m_numBetaCutoffs) : 0.0; }
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Negamax alpha-beta with iterative deepening. Every iteration searches the previous principal
+// variation first, and an interrupted iteration is thrown away so the result is always a complete one.
+// Leaves run a quiescence search that skips captures the static exchange says lose material.
+// With tablebases, endings they cover are played from them at the root and scored by them right
+// after every capture or pawn move inside the tree.
+// Moves come from a ChessMovePicker fed by the killer, counter move and history tables kept here.
+// One instance per thread, all working state is inline so a search never touches the heap.
+class ChessSearch
+{
+public:
+	ChessSearch();
+	ChessSearch(ChessSearch const& copy) = delete;
+
+	void SetTranspositionTable(ChessTranspositionTable* table); // not owned, may be shared with other threads
+	void SetHelperIndex(int helperIndex); // 0 searches every depth, Lazy SMP helpers skip some so threads spread over iterations
+	void SetEvalNetwork(ChessNNUENetwork const* network); // not owned, nullptr (the default) for the handcrafted evaluation
+	void SetTablebases(ChessSyzygyTablebases const* tablebases); // not owned, may be shared with other threads, nullptr to never probe
+
+	// gameKeys are the positions already played before this one, oldest first, for repetition draws
+	ChessSearchResult Search(ChessPosition const& position, uint64_t const* gameKeys, int numGameKeys, ChessSearchLimits const& limits);
+
+private:
+	int		SearchNode(int depth, int ply, int alpha, int beta);
+	int		SearchQuiescence(int ply, int alpha, int beta); // captures and promotions only, so leaves are never scored mid-exchange
+	void	MakeSearchMove(int ply, ChessMove const& move, ChessUndoInfo& out_undo);
+	void	UnmakeSearchMove(ChessMove const& move, ChessUndoInfo const& undo);
+	int		Evaluate(int ply) const;
+	bool	IsDrawByRule() const;
+	bool	IsOutOfLimits() const;
+	int64_t	GetElapsedMs() const;
+	void	UpdateQuietMoveStats(int depth, int ply, ChessMove const& cutoffMove, ChessMove const* failedQuiets, int numFailedQuiets);
+
+private:
+	ChessPosition		m_position;
+	ChessSearchLimits	m_limits;
+	ChessTranspositionTable* m_table = nullptr;
+	ChessNNUENetwork const* m_network = nullptr;
+	ChessSyzygyTablebases const* m_tablebases = nullptr;
+	int					m_helperIndex = 0;
+	std::chrono::steady_clock::time_point m_startTime;
+	ChessTimeBudget		m_timeBudget;
+	uint64_t			m_nodes = 0;
+	uint64_t			m_tablebaseHits = 0;
+	bool				m_isStopped = false; // latched once a limit hits, unwinds the whole tree
+
+	uint64_t			m_keyStack[MAX_SEARCH_GAME_KEYS + MAX_SEARCH_PLY]; // key before every move, game first then search
+	int					m_numKeys = 0;
+
+	ChessMove			m_pvTable[MAX_SEARCH_PLY][MAX_SEARCH_PLY]; // triangular, row ply holds the line from that ply on
+	int					m_pvLength[MAX_SEARCH_PLY] = {};
+	ChessMove			m_previousPv[MAX_SEARCH_PLY];
+	int					m_previousPvLength = 0;
+	bool				m_isFollowingPv = false; // still on the leftmost path of the previous iteration's line
+
+	ChessMove			m_movesMade[MAX_SEARCH_PLY]; // move played at each ply of the current line
+	ChessNNUEAccumulator m_accumulators[MAX_SEARCH_PLY + 1]; // network hidden layer per ply, only used with a network
+	ChessMove			m_killers[MAX_SEARCH_PLY][2]; // quiet moves that cut off at the same ply, most recent first
+	ChessMove			m_counterMoves[NUM_SQUARES][NUM_SQUARES]; // quiet reply that refuted a move, by that move's from/to
+	ChessHistory		m_history;
+	uint64_t			m_numBetaCutoffs = 0;
+	uint64_t			m_numFirstMoveCutoffs = 0;
+};
@@ -0,0 +1,1319 @@
+#include "ChessCore/ChessSyzygy.hpp"
+#include "ChessCore/ChessAttacks.hpp"
+#include "ChessCore/ChessMappedFile.hpp"
+#include "ChessCore/ChessMoveGen.hpp"
+#include <atomic>
+#include <filesystem>
+
+
+//-----------------------------------------------------------------------------------------------
+// File layout and position indexing follow Ronald de Man's format, the same one every engine that
+// reads these tables decodes. Values are Huffman coded and compressed by recursive pairing, blocks
+// are found through a sparse index. See the comments on DecompressPairs.
+static unsigned char const SYZYGY_WDL_MAGIC[4] = { 0x71, 0xE8, 0x23, 0x5D };
+static unsigned char const SYZYGY_DTZ_MAGIC[4] = { 0xD7, 0x66, 0x0C, 0xA5 };
+
+constexpr int SYZYGY_MAX_DTZ			= 1 << 18; // ranks root moves, above any real distance
+constexpr int SYZYGY_NUM_PAWN_FILES		= 4; // tables with pawns are split by the leading pawn's file, a to d after mirroring
+constexpr int SYZYGY_MAX_LEAD_PAWNS		= MAX_SYZYGY_PIECES - 2;
+constexpr int SYZYGY_NO_SYMBOL			= 0xFFF;
+
+enum ChessSyzygyTableFlag : uint8_t
+{
+	SYZYGY_FLAG_SPLIT			= 1, // file header: one table per side to move
+	SYZYGY_FLAG_HAS_PAWNS		= 2, // file header
+	SYZYGY_FLAG_SIDE_TO_MOVE	= 1, // per table: the side to move a DTZ table was stored for
+	SYZYGY_FLAG_MAPPED			= 2, // per table: DTZ values go through a remapping list
+	SYZYGY_FLAG_WIN_PLIES		= 4, // per table: DTZ of wins is in plies, not moves
+	SYZYGY_FLAG_LOSS_PLIES		= 8,
+	SYZYGY_FLAG_WIDE			= 16, // per table: the remapping list holds 16 bit values
+	SYZYGY_FLAG_SINGLE_VALUE	= 128, // per table: every position has the same value, nothing else is stored
+};
+
+enum ChessSyzygyProbeState
+{
+	SYZYGY_PROBE_FAILED,
+	SYZYGY_PROBE_OK,
+	SYZYGY_PROBE_OTHER_SIDE_TO_MOVE, // the DTZ file only holds the other side to move, one ply more is needed
+	SYZYGY_PROBE_ZEROING_IS_BEST, // the best move captures or moves a pawn, the DTZ file may hold anything for such positions
+};
+
+enum ChessSyzygyFileState
+{
+	SYZYGY_FILE_UNMAPPED,
+	SYZYGY_FILE_READY,
+	SYZYGY_FILE_BROKEN, // missing, unreadable or not a table, never tried again
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Everything needed to decode one table: a file holds one per side to move (WDL) and per leading pawn file
+struct ChessSyzygyPairsData
+{
+	uint8_t					m_flags = 0;
+	uint8_t					m_minSymbolLength = 0; // single value tables keep their value here
+	uint8_t					m_maxSymbolLength = 0;
+	uint64_t				m_blockSize = 0;
+	uint64_t				m_span = 0; // values between sparse index entries
+	uint32_t				m_numBlocks = 0;
+	uint32_t				m_numBlockLengths = 0; // padded past m_numBlocks so the sparse index never points outside
+	uint64_t				m_numSparseEntries = 0;
+	unsigned char const*	m_lowestSymbols = nullptr; // uint16 per code length, the lowest symbol of that length
+	unsigned char const*	m_symbolTree = nullptr; // 3 bytes per symbol, the left and right symbols it pairs
+	unsigned char const*	m_sparseIndex = nullptr; // 6 bytes per entry, block and offset of the value mid span
+	unsigned char const*	m_blockLengths = nullptr; // uint16 per block, values in the block minus one
+	unsigned char const*	m_blocks = nullptr;
+	std::vector<uint64_t>	m_codeBases; // lowest code of each length, left aligned in 64 bits
+	std::vector<uint8_t>	m_symbolLengths; // values a symbol expands to, minus one
+	uint8_t					m_pieces[MAX_SYZYGY_PIECES] = {}; // file piece codes in encoding order
+	uint64_t				m_groupFactors[MAX_SYZYGY_PIECES + 1] = {};
+	int						m_groupLengths[MAX_SYZYGY_PIECES + 1] = {}; // pieces per group, zero terminated
+	uint16_t				m_dtzMapIndex[4] = {}; // start of the remapping list for win, loss, cursed win and blessed loss
+};
+
+struct ChessSyzygyTableFile
+{
+	ChessMappedFile			m_file;
+	std::atomic<int>		m_state = SYZYGY_FILE_UNMAPPED;
+	bool					m_isPresent = false;
+	ChessSyzygyPairsData	m_pairs[PLAYER_SIDE_NUM][SYZYGY_NUM_PAWN_FILES]; // [side to move][leading pawn file], DTZ only has [0]
+	unsigned char const*	m_dtzMap = nullptr;
+};
+
+struct ChessSyzygyTable
+{
+	std::string				m_name; // KRPvKR, white is the side named first
+	std::string				m_directory;
+	uint64_t				m_key = 0; // material as named
+	uint64_t				m_mirroredKey = 0; // the same material with the colours swapped, equal for symmetric tables
+	int						m_numPieces = 0;
+	bool					m_hasPawns = false;
+	bool					m_hasUniquePieces = false; // some side has a lone piece other than the king
+	int						m_pawnCounts[2] = {}; // the leading colour first, the one with fewer pawns
+	ChessSyzygyTableFile	m_wdl;
+	ChessSyzygyTableFile	m_dtz;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// The square mappings that fold symmetric positions together, built at compile time
+struct ChessSyzygyIndexTables
+{
+	int m_mapB1H1H7[NUM_SQUARES] = {}; // squares below the a1-h8 diagonal to 0..27
+	int m_mapA1D1D4[NUM_SQUARES] = {}; // the a1-d1-d4 triangle to 0..9, diagonal last
+	int m_mapKK[10][NUM_SQUARES] = {}; // the 462 legal placements of two kings with the first in the triangle
+	int m_binomial[MAX_SYZYGY_PIECES - 1][NUM_SQUARES] = {}; // ways to choose k of n squares
+	int m_mapPawns[NUM_SQUARES] = {}; // a2-h7 to 47..0, the highest value is the leading pawn
+	int m_leadPawnIndex[SYZYGY_MAX_LEAD_PAWNS + 1][NUM_SQUARES] = {};
+	int m_leadPawnsSize[SYZYGY_MAX_LEAD_PAWNS + 1][SYZYGY_NUM_PAWN_FILES] = {};
+};
+
+// 0 on the a1-h8 diagonal, negative below it
+constexpr int GetDiagonalOffset(int square)
+{
+	return GetRankOfSquare(square) - GetFileOfSquare(square);
+}
+
+constexpr ChessSyzygyIndexTables GenerateSyzygyIndexTables()
+{
+	ChessSyzygyIndexTables tables;
+	int code = 0;
+	for (int square = 0; square < NUM_SQUARES; ++square)
+	{
+		if (GetDiagonalOffset(square) < 0)
+		{
+			tables.m_mapB1H1H7[square] = code++;
+		}
+	}
+
+	code = 0;
+	int diagonal[4] = {};
+	int numDiagonal = 0;
+	for (int square = 0; square <= GetSquareIndex(3, 3); ++square)
+	{
+		if (GetFileOfSquare(square) > 3)
+		{
+			continue;
+		}
+		if (GetDiagonalOffset(square) < 0)
+		{
+			tables.m_mapA1D1D4[square] = code++;
+		}
+		else if (GetDiagonalOffset(square) == 0)
+		{
+			diagonal[numDiagonal++] = square;
+		}
+	}
+	for (int diagonalIndex = 0; diagonalIndex < numDiagonal; ++diagonalIndex)
+	{
+		tables.m_mapA1D1D4[diagonal[diagonalIndex]] = code++;
+	}
+
+	// with the first king on the diagonal the second is kept on or below it, both on it are numbered last
+	code = 0;
+	int bothOnDiagonal[64][2] = {};
+	int numBothOnDiagonal = 0;
+	for (int triangleIndex = 0; triangleIndex < 10; ++triangleIndex)
+	{
+		for (int square1 = 0; square1 <= GetSquareIndex(3, 3); ++square1)
+		{
+			if (tables.m_mapA1D1D4[square1] != triangleIndex || (triangleIndex == 0 && square1 != GetSquareIndex(1, 0)))
+			{
+				continue;
+			}
+			for (int square2 = 0; square2 < NUM_SQUARES; ++square2)
+			{
+				if (GetSquareDistance(square1, square2) <= 1)
+				{
+					continue;
+				}
+				if (GetDiagonalOffset(square1) == 0 && GetDiagonalOffset(square2) > 0)
+				{
+					continue;
+				}
+				if (GetDiagonalOffset(square1) == 0 && GetDiagonalOffset(square2) == 0)
+				{
+					bothOnDiagonal[numBothOnDiagonal][0] = triangleIndex;
+					bothOnDiagonal[numBothOnDiagonal][1] = square2;
+					numBothOnDiagonal++;
+				}
+				else
+				{
+					tables.m_mapKK[triangleIndex][square2] = code++;
+				}
+			}
+		}
+	}
+	for (int pairIndex = 0; pairIndex < numBothOnDiagonal; ++pairIndex)
+	{
+		tables.m_mapKK[bothOnDiagonal[pairIndex][0]][bothOnDiagonal[pairIndex][1]] = code++;
+	}
+
+	tables.m_binomial[0][0] = 1;
+	for (int n = 1; n < NUM_SQUARES; ++n)
+	{
+		for (int k = 0; k < MAX_SYZYGY_PIECES - 1 && k <= n; ++k)
+		{
+			tables.m_binomial[k][n] = ((k > 0) ? tables.m_binomial[k - 1][n - 1] : 0) + ((k < n) ? tables.m_binomial[k][n - 1] : 0);
+		}
+	}
+
+	// A pawn on a square leaves m_mapPawns[square] squares for the other leading pawns, those nearer the edge or
+	// further back on the same file are taken by the rule that the leading pawn is the highest
+	int availableSquares = 47;
+	for (int numLeadPawns = 1; numLeadPawns <= SYZYGY_MAX_LEAD_PAWNS; ++numLeadPawns)
+	{
+		for (int file = 0; file < SYZYGY_NUM_PAWN_FILES; ++file)
+		{
+			int index = 0;
+			for (int rank = 1; rank <= 6; ++rank)
+			{
+				int square = GetSquareIndex(file, rank);
+				if (numLeadPawns == 1)
+				{
+					tables.m_mapPawns[square] = availableSquares--;
+					tables.m_mapPawns[square ^ 7] = availableSquares--;
+				}
+				tables.m_leadPawnIndex[numLeadPawns][square] = index;
+				index += tables.m_binomial[numLeadPawns - 1][tables.m_mapPawns[square]];
+			}
+			tables.m_leadPawnsSize[numLeadPawns][file] = index;
+		}
+	}
+	return tables;
+}
+
+static constexpr ChessSyzygyIndexTables s_syzygyIndex = GenerateSyzygyIndexTables();
+
+
+//-----------------------------------------------------------------------------------------------
+static uint64_t ReadLittleEndian(unsigned char const* bytes, int numBytes)
+{
+	uint64_t value = 0;
+	for (int byteIndex = numBytes - 1; byteIndex >= 0; --byteIndex)
+	{
+		value = (value << 8) | bytes[byteIndex];
+	}
+	return value;
+}
+
+static uint64_t ReadBigEndian(unsigned char const* bytes, int numBytes)
+{
+	uint64_t value = 0;
+	for (int byteIndex = 0; byteIndex < numBytes; ++byteIndex)
+	{
+		value = (value << 8) | bytes[byteIndex];
+	}
+	return value;
+}
+
+static int GetLeftSymbol(unsigned char const* symbolTree, int symbol)
+{
+	unsigned char const* node = symbolTree + 3 * symbol;
+	return ((node[1] & 0xF) << 8) | node[0];
+}
+
+static int GetRightSymbol(unsigned char const* symbolTree, int symbol)
+{
+	unsigned char const* node = symbolTree + 3 * symbol;
+	return (node[2] << 4) | (node[1] >> 4);
+}
+
+// Kings are left out, every table has one of each
+static uint64_t GetMaterialKey(int const (&counts)[PLAYER_SIDE_NUM][(int)PieceType::NUM], bool isMirrored)
+{
+	uint64_t key = 0;
+	for (int side = 0; side < PLAYER_SIDE_NUM; ++side)
+	{
+		int keySide = isMirrored ? 1 - side : side;
+		for (int type = (int)PieceType::QUEEN; type <= (int)PieceType::PAWN; ++type)
+		{
+			key |= static_cast<uint64_t>(counts[side][type]) << (4 * (keySide * 5 + type - 1));
+		}
+	}
+	return key;
+}
+
+static uint64_t GetMaterialKey(ChessPosition const& position)
+{
+	int counts[PLAYER_SIDE_NUM][(int)PieceType::NUM] = {};
+	for (int side = 0; side < PLAYER_SIDE_NUM; ++side)
+	{
+		for (int type = (int)PieceType::QUEEN; type <= (int)PieceType::PAWN; ++type)
+		{
+			counts[side][type] = GetBitCount(position.GetPieces(static_cast<PlayerSide>(side), static_cast<PieceType>(type)));
+		}
+	}
+	return GetMaterialKey(counts, false);
+}
+
+// Pieces are numbered 1 pawn .. 6 king, plus 8 for black
+static int GetSyzygyPieceCode(ChessPosition const& position, int square)
+{
+	return (6 - static_cast<int>(position.GetPieceTypeAt(square))) | ((position.GetPlayerSideAt(square) == PLAYER_BLACK) ? 8 : 0);
+}
+
+static bool IsPawnSquareHigher(int squareA, int squareB)
+{
+	return s_syzygyIndex.m_mapPawns[squareA] > s_syzygyIndex.m_mapPawns[squareB];
+}
+
+// Insertion sort, stable and allocation free for the handful of squares a group has
+static void SortSquares(int* squares, int numSquares, bool isByPawnMap)
+{
+	for (int sortedEnd = 1; sortedEnd < numSquares; ++sortedEnd)
+	{
+		int square = squares[sortedEnd];
+		int insertIndex = sortedEnd;
+		while (insertIndex > 0 && (isByPawnMap ? IsPawnSquareHigher(squares[insertIndex - 1], square) : squares[insertIndex - 1] > square))
+		{
+			squares[insertIndex] = squares[insertIndex - 1];
+			insertIndex--;
+		}
+		squares[insertIndex] = square;
+	}
+}
+
+static int GetWdlSign(int value)
+{
+	return (value > 0) - (value < 0);
+}
+
+// DTZ of a position whose best move zeroes the clock: one ply, past the fifty-move horizon when cursed
+static int GetDtzBeforeZeroing(int wdl)
+{
+	switch (wdl)
+	{
+	case WDL_WIN:			return 1;
+	case WDL_CURSED_WIN:	return 101;
+	case WDL_BLESSED_LOSS:	return -101;
+	case WDL_LOSS:			return -1;
+	default:				return 0;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Pieces are split into groups, each encoded as a combination, so the index of a position is
+//     g1 * N(g2) * N(g3) + g2 * N(g3) + g3
+// with N(g) the number of ways to place group g. The order of the groups is stored per table.
+static void SetUpGroups(ChessSyzygyTable const& table, ChessSyzygyPairsData& pairs, int const* order, int file)
+{
+	int numGroups = 0;
+	int firstGroupLength = table.m_hasPawns ? 0 : (table.m_hasUniquePieces ? 3 : 2);
+	pairs.m_groupLengths[0] = 1;
+	for (int pieceIndex = 1; pieceIndex < table.m_numPieces; ++pieceIndex)
+	{
+		if (--firstGroupLength > 0 || pairs.m_pieces[pieceIndex] == pairs.m_pieces[pieceIndex - 1])
+		{
+			pairs.m_groupLengths[numGroups]++;
+		}
+		else
+		{
+			pairs.m_groupLengths[++numGroups] = 1;
+		}
+	}
+	pairs.m_groupLengths[++numGroups] = 0;
+
+	bool hasPawnsOnBothSides = table.m_hasPawns && table.m_pawnCounts[1] > 0;
+	int nextGroup = hasPawnsOnBothSides ? 2 : 1;
+	int freeSquares = 64 - pairs.m_groupLengths[0] - (hasPawnsOnBothSides ? pairs.m_groupLengths[1] : 0);
+	uint64_t factor = 1;
+	for (int orderIndex = 0; nextGroup < numGroups || orderIndex == order[0] || orderIndex == order[1]; ++orderIndex)
+	{
+		if (orderIndex == order[0])
+		{
+			// leading pawns or leading pieces
+			pairs.m_groupFactors[0] = factor;
+			factor *= table.m_hasPawns ? s_syzygyIndex.m_leadPawnsSize[pairs.m_groupLengths[0]][file] : (table.m_hasUniquePieces ? 31332 : 462);
+		}
+		else if (orderIndex == order[1])
+		{
+			// the other side's pawns
+			pairs.m_groupFactors[1] = factor;
+			factor *= s_syzygyIndex.m_binomial[pairs.m_groupLengths[1]][48 - pairs.m_groupLengths[0]];
+		}
+		else
+		{
+			pairs.m_groupFactors[nextGroup] = factor;
+			factor *= s_syzygyIndex.m_binomial[pairs.m_groupLengths[nextGroup]][freeSquares];
+			freeSquares -= pairs.m_groupLengths[nextGroup++];
+		}
+	}
+	pairs.m_groupFactors[numGroups] = factor;
+}
+
+static void SetUpSymbolLength(ChessSyzygyPairsData& pairs, int symbol, std::vector<bool>& isVisited)
+{
+	// the tree is acyclic, marking first is safe
+	isVisited[symbol] = true;
+	int numSymbols = static_cast<int>(pairs.m_symbolLengths.size());
+	int right = GetRightSymbol(pairs.m_symbolTree, symbol);
+	int left = GetLeftSymbol(pairs.m_symbolTree, symbol);
+	if (right == SYZYGY_NO_SYMBOL || right >= numSymbols || left >= numSymbols)
+	{
+		pairs.m_symbolLengths[symbol] = 0;
+		return;
+	}
+	if (!isVisited[left])
+	{
+		SetUpSymbolLength(pairs, left, isVisited);
+	}
+	if (!isVisited[right])
+	{
+		SetUpSymbolLength(pairs, right, isVisited);
+	}
+	pairs.m_symbolLengths[symbol] = static_cast<uint8_t>(pairs.m_symbolLengths[left] + pairs.m_symbolLengths[right] + 1);
+}
+
+static unsigned char const* SetUpSizes(ChessSyzygyPairsData& pairs, unsigned char const* data, unsigned char const* dataEnd)
+{
+	if (data + 2 > dataEnd)
+	{
+		return nullptr;
+	}
+	pairs.m_flags = *data++;
+	if ((pairs.m_flags & SYZYGY_FLAG_SINGLE_VALUE) != 0)
+	{
+		pairs.m_minSymbolLength = *data++;
+		return data;
+	}
+
+	if (data + 9 > dataEnd)
+	{
+		return nullptr;
+	}
+	int numGroups = 0;
+	while (pairs.m_groupLengths[numGroups] != 0)
+	{
+		numGroups++;
+	}
+	uint64_t tableSize = pairs.m_groupFactors[numGroups];
+	pairs.m_blockSize = 1ULL << data[0];
+	pairs.m_span = 1ULL << data[1];
+	pairs.m_numSparseEntries = (tableSize + pairs.m_span - 1) / pairs.m_span;
+	int padding = data[2];
+	pairs.m_numBlocks = static_cast<uint32_t>(ReadLittleEndian(data + 3, 4));
+	pairs.m_numBlockLengths = pairs.m_numBlocks + padding;
+	pairs.m_maxSymbolLength = data[7];
+	pairs.m_minSymbolLength = data[8];
+	data += 9;
+	if (pairs.m_minSymbolLength < 1 || pairs.m_maxSymbolLength > 32 || pairs.m_maxSymbolLength < pairs.m_minSymbolLength)
+	{
+		return nullptr;
+	}
+
+	// Canonical Huffman: longer codes have lower values, and all codes of one length are consecutive. Left aligned
+	// in 64 bits, a code of length l lies between the bases of lengths l - 1 and l, which is how its length is found.
+	int numLengths = pairs.m_maxSymbolLength - pairs.m_minSymbolLength + 1;
+	pairs.m_lowestSymbols = data;
+	if (data + 2 * numLengths + 2 > dataEnd)
+	{
+		return nullptr;
+	}
+	pairs.m_codeBases.assign(numLengths, 0);
+	for (int lengthIndex = numLengths - 2; lengthIndex >= 0; --lengthIndex)
+	{
+		pairs.m_codeBases[lengthIndex] = (pairs.m_codeBases[lengthIndex + 1] + ReadLittleEndian(data + 2 * lengthIndex, 2) - ReadLittleEndian(data + 2 * (lengthIndex + 1), 2)) / 2;
+	}
+	for (int lengthIndex = 0; lengthIndex < numLengths; ++lengthIndex)
+	{
+		pairs.m_codeBases[lengthIndex] <<= 64 - lengthIndex - pairs.m_minSymbolLength;
+	}
+	data += 2 * numLengths;
+
+	// Recursive pairing replaced the most frequent pair of symbols by a new one over and over, the tree undoes it
+	int numSymbols = static_cast<int>(ReadLittleEndian(data, 2));
+	data += 2;
+	pairs.m_symbolTree = data;
+	if (data + 3 * numSymbols > dataEnd)
+	{
+		return nullptr;
+	}
+	pairs.m_symbolLengths.assign(numSymbols, 0);
+	std::vector<bool> isVisited(numSymbols, false);
+	for (int symbol = 0; symbol < numSymbols; ++symbol)
+	{
+		if (!isVisited[symbol])
+		{
+			SetUpSymbolLength(pairs, symbol, isVisited);
+		}
+	}
+	return data + 3 * numSymbols + (numSymbols & 1);
+}
+
+static unsigned char const* SetUpDtzMap(ChessSyzygyTableFile& tableFile, unsigned char const* fileStart, unsigned char const* data, int numFiles)
+{
+	tableFile.m_dtzMap = data;
+	for (int file = 0; file < numFiles; ++file)
+	{
+		ChessSyzygyPairsData& pairs = tableFile.m_pairs[0][file];
+		if ((pairs.m_flags & SYZYGY_FLAG_MAPPED) == 0)
+		{
+			continue;
+		}
+		if ((pairs.m_flags & SYZYGY_FLAG_WIDE) != 0)
+		{
+			data += (data - fileStart) & 1;
+			for (int listIndex = 0; listIndex < 4; ++listIndex)
+			{
+				pairs.m_dtzMapIndex[listIndex] = static_cast<uint16_t>((data - tableFile.m_dtzMap) / 2 + 1);
+				data += 2 * ReadLittleEndian(data, 2) + 2;
+			}
+		}
+		else
+		{
+			for (int listIndex = 0; listIndex < 4; ++listIndex)
+			{
+				pairs.m_dtzMapIndex[listIndex] = static_cast<uint16_t>(data - tableFile.m_dtzMap + 1);
+				data += *data + 1;
+			}
+		}
+	}
+	return data + ((data - fileStart) & 1);
+}
+
+static bool SetUpTableFile(ChessSyzygyTable const& table, ChessSyzygyTableFile& tableFile, bool isDtz)
+{
+	unsigned char const* fileStart = tableFile.m_file.GetData();
+	unsigned char const* fileEnd = fileStart + tableFile.m_file.GetSize();
+	unsigned char const* data = fileStart + 4;
+
+	bool isSplit = (*data & SYZYGY_FLAG_SPLIT) != 0;
+	bool hasPawns = (*data & SYZYGY_FLAG_HAS_PAWNS) != 0;
+	if (hasPawns != table.m_hasPawns || (!isDtz && isSplit != (table.m_key != table.m_mirroredKey)))
+	{
+		return false;
+	}
+	data++;
+
+	int numSides = (!isDtz && table.m_key != table.m_mirroredKey) ? 2 : 1;
+	int numFiles = table.m_hasPawns ? SYZYGY_NUM_PAWN_FILES : 1;
+	bool hasPawnsOnBothSides = table.m_hasPawns && table.m_pawnCounts[1] > 0;
+	for (int file = 0; file < numFiles; ++file)
+	{
+		if (data + 2 + table.m_numPieces > fileEnd)
+		{
+			return false;
+		}
+		int order[PLAYER_SIDE_NUM][2] =
+		{
+			{ data[0] & 0xF, hasPawnsOnBothSides ? (data[1] & 0xF) : 0xF },
+			{ data[0] >> 4, hasPawnsOnBothSides ? (data[1] >> 4) : 0xF },
+		};
+		data += hasPawnsOnBothSides ? 2 : 1;
+		for (int pieceIndex = 0; pieceIndex < table.m_numPieces; ++pieceIndex, ++data)
+		{
+			for (int side = 0; side < numSides; ++side)
+			{
+				tableFile.m_pairs[side][file].m_pieces[pieceIndex] = static_cast<uint8_t>((side == 0) ? (*data & 0xF) : (*data >> 4));
+			}
+		}
+		for (int side = 0; side < numSides; ++side)
+		{
+			SetUpGroups(table, tableFile.m_pairs[side][file], order[side], file);
+		}
+	}
+	data += (data - fileStart) & 1;
+
+	for (int file = 0; file < numFiles; ++file)
+	{
+		for (int side = 0; side < numSides; ++side)
+		{
+			data = SetUpSizes(tableFile.m_pairs[side][file], data, fileEnd);
+			if (data == nullptr)
+			{
+				return false;
+			}
+		}
+	}
+	if (isDtz)
+	{
+		data = SetUpDtzMap(tableFile, fileStart, data, numFiles);
+	}
+
+	// the tables' sparse indexes, then block lengths, then the compressed blocks, each table's blocks 64 byte aligned
+	for (int file = 0; file < numFiles; ++file)
+	{
+		for (int side = 0; side < numSides; ++side)
+		{
+			ChessSyzygyPairsData& pairs = tableFile.m_pairs[side][file];
+			pairs.m_sparseIndex = data;
+			data += 6 * pairs.m_numSparseEntries;
+		}
+	}
+	for (int file = 0; file < numFiles; ++file)
+	{
+		for (int side = 0; side < numSides; ++side)
+		{
+			ChessSyzygyPairsData& pairs = tableFile.m_pairs[side][file];
+			pairs.m_blockLengths = data;
+			data += 2 * static_cast<uint64_t>(pairs.m_numBlockLengths);
+		}
+	}
+	for (int file = 0; file < numFiles; ++file)
+	{
+		for (int side = 0; side < numSides; ++side)
+		{
+			ChessSyzygyPairsData& pairs = tableFile.m_pairs[side][file];
+			data += (64 - ((data - fileStart) & 63)) & 63;
+			pairs.m_blocks = data;
+			data += static_cast<uint64_t>(pairs.m_numBlocks) * pairs.m_blockSize;
+		}
+	}
+	return data <= fileEnd;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The value at index. A sparse index entry every span values says which block holds the value mid span and
+// where in it, the block lengths lead from there to the right block. Inside the block the Huffman codes are
+// read one by one, each symbol stands for symbolLength + 1 values, until the one holding the value is found,
+// then the pairing tree is walked down to it.
+static int DecompressPairs(ChessSyzygyPairsData const& pairs, uint64_t index)
+{
+	if ((pairs.m_flags & SYZYGY_FLAG_SINGLE_VALUE) != 0)
+	{
+		return pairs.m_minSymbolLength;
+	}
+
+	uint64_t sparseIndex = index / pairs.m_span;
+	unsigned char const* sparseEntry = pairs.m_sparseIndex + 6 * sparseIndex;
+	uint32_t block = static_cast<uint32_t>(ReadLittleEndian(sparseEntry, 4));
+	int offset = static_cast<int>(ReadLittleEndian(sparseEntry + 4, 2));
+	offset += static_cast<int>(index % pairs.m_span) - static_cast<int>(pairs.m_span / 2);
+	while (offset < 0)
+	{
+		offset += static_cast<int>(ReadLittleEndian(pairs.m_blockLengths + 2 * (--block), 2)) + 1;
+	}
+	while (offset > static_cast<int>(ReadLittleEndian(pairs.m_blockLengths + 2 * block, 2)))
+	{
+		offset -= static_cast<int>(ReadLittleEndian(pairs.m_blockLengths + 2 * (block++), 2)) + 1;
+	}
+
+	unsigned char const* blockData = pairs.m_blocks + static_cast<uint64_t>(block) * pairs.m_blockSize;
+	uint64_t buffer = ReadBigEndian(blockData, 8);
+	blockData += 8;
+	int numBufferBits = 64;
+	int symbol = 0;
+	for (;;)
+	{
+		int lengthIndex = 0;
+		while (buffer < pairs.m_codeBases[lengthIndex])
+		{
+			lengthIndex++;
+		}
+		symbol = static_cast<int>((buffer - pairs.m_codeBases[lengthIndex]) >> (64 - lengthIndex - pairs.m_minSymbolLength));
+		symbol += static_cast<int>(ReadLittleEndian(pairs.m_lowestSymbols + 2 * lengthIndex, 2));
+		if (offset < pairs.m_symbolLengths[symbol] + 1)
+		{
+			break;
+		}
+		offset -= pairs.m_symbolLengths[symbol] + 1;
+
+		int codeLength = lengthIndex + pairs.m_minSymbolLength;
+		buffer <<= codeLength;
+		numBufferBits -= codeLength;
+		if (numBufferBits <= 32)
+		{
+			numBufferBits += 32;
+			buffer |= ReadBigEndian(blockData, 4) << (64 - numBufferBits);
+			blockData += 4;
+		}
+	}
+
+	// the two halves of a pair are adjacent, so the offset says which one to go down
+	while (pairs.m_symbolLengths[symbol] != 0)
+	{
+		int left = GetLeftSymbol(pairs.m_symbolTree, symbol);
+		if (offset < pairs.m_symbolLengths[left] + 1)
+		{
+			symbol = left;
+		}
+		else
+		{
+			offset -= pairs.m_symbolLengths[left] + 1;
+			symbol = GetRightSymbol(pairs.m_symbolTree, symbol);
+		}
+	}
+	return GetLeftSymbol(pairs.m_symbolTree, symbol);
+}
+
+// DTZ files store moves or plies, some through a remapping list, the caller always gets plies
+static int GetDtzFromStoredValue(ChessSyzygyTableFile const& tableFile, int file, int value, ChessWdl wdl)
+{
+	static int const WDL_TO_MAP_LIST[5] = { 1, 3, 0, 2, 0 };
+
+	ChessSyzygyPairsData const& pairs = tableFile.m_pairs[0][file];
+	if ((pairs.m_flags & SYZYGY_FLAG_MAPPED) != 0)
+	{
+		int mapIndex = pairs.m_dtzMapIndex[WDL_TO_MAP_LIST[wdl + 2]] + value;
+		value = ((pairs.m_flags & SYZYGY_FLAG_WIDE) != 0) ? static_cast<int>(ReadLittleEndian(tableFile.m_dtzMap + 2 * mapIndex, 2)) : tableFile.m_dtzMap[mapIndex];
+	}
+
+	if ((wdl == WDL_WIN && (pairs.m_flags & SYZYGY_FLAG_WIN_PLIES) == 0) || (wdl == WDL_LOSS && (pairs.m_flags & SYZYGY_FLAG_LOSS_PLIES) == 0)
+		|| wdl == WDL_CURSED_WIN || wdl == WDL_BLESSED_LOSS)
+	{
+		value *= 2;
+	}
+	return value + 1;
+}
+
+// Maps the position onto the table's canonical form (stronger side white, leading piece in the a1-d1-d4
+// triangle or leading pawn on files a-d) and turns it into the table index
+static int ProbeTableFile(ChessPosition const& position, ChessSyzygyTable const& table, ChessSyzygyTableFile const& tableFile, bool isDtz, ChessWdl wdl, int& out_value)
+{
+	// Symmetric tables only hold white to move, and every table has the stronger side as white,
+	// so the colours are swapped and the board flipped vertically whenever the position is the other way round
+	bool isSymmetricBlackToMove = table.m_key == table.m_mirroredKey && position.m_sideToMove == PLAYER_BLACK;
+	bool isBlackStronger = GetMaterialKey(position) != table.m_key;
+	bool isFlipped = isSymmetricBlackToMove || isBlackStronger;
+	int flipPiece = isFlipped ? 8 : 0;
+	int flipSquare = isFlipped ? 56 : 0;
+	int sideToMove = (isFlipped ? 1 : 0) ^ ((position.m_sideToMove == PLAYER_BLACK) ? 1 : 0);
+
+	int squares[MAX_SYZYGY_PIECES];
+	int pieces[MAX_SYZYGY_PIECES];
+	int numPieces = 0;
+	int numLeadPawns = 0;
+	int file = 0;
+	Bitboard leadPawns = BITBOARD_EMPTY;
+	if (table.m_hasPawns)
+	{
+		// the leading colour's pawns come first in every sub table, the highest of them picks the sub table
+		int leadPiece = tableFile.m_pairs[0][0].m_pieces[0] ^ flipPiece;
+		leadPawns = position.GetPieces(((leadPiece & 8) != 0) ? PLAYER_BLACK : PLAYER_WHITE, PieceType::PAWN);
+		Bitboard pawns = leadPawns;
+		while (pawns != BITBOARD_EMPTY && numPieces < MAX_SYZYGY_PIECES)
+		{
+			squares[numPieces++] = PopLowestSquare(pawns) ^ flipSquare;
+		}
+		numLeadPawns = numPieces;
+		if (numLeadPawns == 0)
+		{
+			return SYZYGY_PROBE_FAILED;
+		}
+		int highestIndex = 0;
+		for (int pawnIndex = 1; pawnIndex < numLeadPawns; ++pawnIndex)
+		{
+			if (IsPawnSquareHigher(squares[pawnIndex], squares[highestIndex]))
+			{
+				highestIndex = pawnIndex;
+			}
+		}
+		int highestSquare = squares[highestIndex];
+		squares[highestIndex] = squares[0];
+		squares[0] = highestSquare;
+		int leadFile = GetFileOfSquare(squares[0]);
+		file = (leadFile < 4) ? leadFile : 7 - leadFile;
+	}
+
+	// DTZ files hold one side to move only
+	if (isDtz)
+	{
+		bool isStoredSide = (tableFile.m_pairs[0][file].m_flags & SYZYGY_FLAG_SIDE_TO_MOVE) == sideToMove;
+		if (!isStoredSide && !(table.m_key == table.m_mirroredKey && !table.m_hasPawns))
+		{
+			return SYZYGY_PROBE_OTHER_SIDE_TO_MOVE;
+		}
+	}
+
+	Bitboard others = position.GetOccupied() & ~leadPawns;
+	while (others != BITBOARD_EMPTY && numPieces < MAX_SYZYGY_PIECES)
+	{
+		int square = PopLowestSquare(others);
+		squares[numPieces] = square ^ flipSquare;
+		pieces[numPieces++] = GetSyzygyPieceCode(position, square) ^ flipPiece;
+	}
+	if (numPieces != table.m_numPieces || others != BITBOARD_EMPTY)
+	{
+		return SYZYGY_PROBE_FAILED;
+	}
+
+	// same piece order as the table was encoded with
+	ChessSyzygyPairsData const& pairs = tableFile.m_pairs[isDtz ? 0 : sideToMove][file];
+	for (int pieceIndex = numLeadPawns; pieceIndex < numPieces - 1; ++pieceIndex)
+	{
+		for (int otherIndex = pieceIndex + 1; otherIndex < numPieces; ++otherIndex)
+		{
+			if (pairs.m_pieces[pieceIndex] == pieces[otherIndex])
+			{
+				int swapPiece = pieces[pieceIndex];
+				pieces[pieceIndex] = pieces[otherIndex];
+				pieces[otherIndex] = swapPiece;
+				int swapSquare = squares[pieceIndex];
+				squares[pieceIndex] = squares[otherIndex];
+				squares[otherIndex] = swapSquare;
+				break;
+			}
+		}
+	}
+
+	// the leading piece goes to files a-d
+	if (GetFileOfSquare(squares[0]) > 3)
+	{
+		for (int pieceIndex = 0; pieceIndex < numPieces; ++pieceIndex)
+		{
+			squares[pieceIndex] ^= 7;
+		}
+	}
+
+	uint64_t index = 0;
+	if (table.m_hasPawns)
+	{
+		index = s_syzygyIndex.m_leadPawnIndex[numLeadPawns][squares[0]];
+		SortSquares(squares + 1, numLeadPawns - 1, true);
+		for (int pawnIndex = 1; pawnIndex < numLeadPawns; ++pawnIndex)
+		{
+			index += s_syzygyIndex.m_binomial[pawnIndex][s_syzygyIndex.m_mapPawns[squares[pawnIndex]]];
+		}
+	}
+	else
+	{
+		// without pawns the board also folds onto ranks 1-4 and across the a1-h8 diagonal
+		if (GetRankOfSquare(squares[0]) > 3)
+		{
+			for (int pieceIndex = 0; pieceIndex < numPieces; ++pieceIndex)
+			{
+				squares[pieceIndex] ^= 56;
+			}
+		}
+		for (int pieceIndex = 0; pieceIndex < pairs.m_groupLengths[0]; ++pieceIndex)
+		{
+			int diagonalOffset = GetDiagonalOffset(squares[pieceIndex]);
+			if (diagonalOffset == 0)
+			{
+				continue;
+			}
+			if (diagonalOffset > 0)
+			{
+				for (int flipIndex = pieceIndex; flipIndex < numPieces; ++flipIndex)
+				{
+					squares[flipIndex] = ((squares[flipIndex] >> 3) | (squares[flipIndex] << 3)) & 63;
+				}
+			}
+			break;
+		}
+
+		if (table.m_hasUniquePieces)
+		{
+			// three unique pieces together: the first below the diagonal in the triangle, or on the diagonal with the next ones
+			// on or below it, each later square skipping the ones taken before it
+			int adjust1 = (squares[1] > squares[0]) ? 1 : 0;
+			int adjust2 = ((squares[2] > squares[0]) ? 1 : 0) + ((squares[2] > squares[1]) ? 1 : 0);
+			if (GetDiagonalOffset(squares[0]) != 0)
+			{
+				index = (static_cast<uint64_t>(s_syzygyIndex.m_mapA1D1D4[squares[0]]) * 63 + (squares[1] - adjust1)) * 62 + squares[2] - adjust2;
+			}
+			else if (GetDiagonalOffset(squares[1]) != 0)
+			{
+				index = (6 * 63 + GetRankOfSquare(squares[0]) * 28 + static_cast<uint64_t>(s_syzygyIndex.m_mapB1H1H7[squares[1]])) * 62 + squares[2] - adjust2;
+			}
+			else if (GetDiagonalOffset(squares[2]) != 0)
+			{
+				index = 6 * 63 * 62 + 4 * 28 * 62 + GetRankOfSquare(squares[0]) * 7 * 28 + (GetRankOfSquare(squares[1]) - adjust1) * 28
+					+ static_cast<uint64_t>(s_syzygyIndex.m_mapB1H1H7[squares[2]]);
+			}
+			else
+			{
+				index = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + GetRankOfSquare(squares[0]) * 7 * 6 + (GetRankOfSquare(squares[1]) - adjust1) * 6
+					+ (GetRankOfSquare(squares[2]) - adjust2);
+			}
+		}
+		else
+		{
+			index = s_syzygyIndex.m_mapKK[s_syzygyIndex.m_mapA1D1D4[squares[0]]][squares[1]];
+		}
+	}
+	index *= pairs.m_groupFactors[0];
+
+	// the remaining groups each as a combination of the squares the earlier groups left free
+	int* groupSquares = squares + pairs.m_groupLengths[0];
+	bool isRemainingPawns = table.m_hasPawns && table.m_pawnCounts[1] > 0;
+	for (int groupIndex = 1; pairs.m_groupLengths[groupIndex] != 0; ++groupIndex)
+	{
+		int groupLength = pairs.m_groupLengths[groupIndex];
+		SortSquares(groupSquares, groupLength, false);
+		uint64_t combination = 0;
+		for (int pieceIndex = 0; pieceIndex < groupLength; ++pieceIndex)
+		{
+			int adjust = 0;
+			for (int const* earlierSquare = squares; earlierSquare < groupSquares; ++earlierSquare)
+			{
+				adjust += (groupSquares[pieceIndex] > *earlierSquare) ? 1 : 0;
+			}
+			combination += s_syzygyIndex.m_binomial[pieceIndex + 1][groupSquares[pieceIndex] - adjust - (isRemainingPawns ? 8 : 0)];
+		}
+		isRemainingPawns = false;
+		index += combination * pairs.m_groupFactors[groupIndex];
+		groupSquares += groupLength;
+	}
+
+	int value = DecompressPairs(pairs, index);
+	out_value = isDtz ? GetDtzFromStoredValue(tableFile, file, value, wdl) : value - 2;
+	return SYZYGY_PROBE_OK;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ChessSyzygyTablebases::~ChessSyzygyTablebases()
+{
+	Clear();
+}
+
+int ChessSyzygyTablebases::Initialize(std::string const& directories)
+{
+	static std::string const PIECE_LETTERS = "KQRBNP"; // PieceType order
+
+	Clear();
+	size_t directoryStart = 0;
+	while (directoryStart <= directories.size())
+	{
+		size_t directoryEnd = directories.find(';', directoryStart);
+		if (directoryEnd == std::string::npos)
+		{
+			directoryEnd = directories.size();
+		}
+		std::string directory = directories.substr(directoryStart, directoryEnd - directoryStart);
+		directoryStart = directoryEnd + 1;
+		if (directory.empty())
+		{
+			continue;
+		}
+
+		std::error_code error;
+		for (std::filesystem::directory_iterator entry(directory, error), end; !error && entry != end; entry.increment(error))
+		{
+			std::filesystem::path const& path = entry->path();
+			if (path.extension() != ".rtbw")
+			{
+				continue;
+			}
+
+			// KRPvKR: each side's pieces, one king each
+			std::string name = path.stem().string();
+			int counts[PLAYER_SIDE_NUM][(int)PieceType::NUM] = {};
+			int side = PLAYER_WHITE;
+			int numPieces = 0;
+			bool isValidName = true;
+			for (char letter : name)
+			{
+				size_t type = PIECE_LETTERS.find(letter);
+				if (letter == 'v' && side == PLAYER_WHITE)
+				{
+					side = PLAYER_BLACK;
+				}
+				else if (type != std::string::npos)
+				{
+					counts[side][type]++;
+					numPieces++;
+				}
+				else
+				{
+					isValidName = false;
+				}
+			}
+			if (!isValidName || side != PLAYER_BLACK || counts[PLAYER_WHITE][(int)PieceType::KING] != 1 || counts[PLAYER_BLACK][(int)PieceType::KING] != 1
+				|| numPieces > MAX_SYZYGY_PIECES)
+			{
+				continue;
+			}
+
+			// the first directory with a table wins
+			uint64_t key = GetMaterialKey(counts, false);
+			if (m_tablesByMaterial.find(key) != m_tablesByMaterial.end())
+			{
+				continue;
+			}
+
+			ChessSyzygyTable* table = new ChessSyzygyTable();
+			table->m_name = name;
+			table->m_directory = directory;
+			table->m_key = key;
+			table->m_mirroredKey = GetMaterialKey(counts, true);
+			table->m_numPieces = numPieces;
+			int whitePawns = counts[PLAYER_WHITE][(int)PieceType::PAWN];
+			int blackPawns = counts[PLAYER_BLACK][(int)PieceType::PAWN];
+			table->m_hasPawns = whitePawns + blackPawns > 0;
+			for (int countSide = 0; countSide < PLAYER_SIDE_NUM; ++countSide)
+			{
+				for (int type = (int)PieceType::QUEEN; type <= (int)PieceType::PAWN; ++type)
+				{
+					table->m_hasUniquePieces = table->m_hasUniquePieces || counts[countSide][type] == 1;
+				}
+			}
+			// with pawns on both sides the one with fewer leads, it compresses better
+			bool isWhiteLeading = blackPawns == 0 || (whitePawns > 0 && blackPawns >= whitePawns);
+			table->m_pawnCounts[0] = isWhiteLeading ? whitePawns : blackPawns;
+			table->m_pawnCounts[1] = isWhiteLeading ? blackPawns : whitePawns;
+			table->m_wdl.m_isPresent = true;
+			std::filesystem::path dtzPath = path;
+			dtzPath.replace_extension(".rtbz");
+			table->m_dtz.m_isPresent = std::filesystem::exists(dtzPath, error);
+			error.clear();
+
+			m_tables.push_back(table);
+			m_tablesByMaterial[table->m_key] = table;
+			m_tablesByMaterial[table->m_mirroredKey] = table;
+			m_maxPieces = (numPieces > m_maxPieces) ? numPieces : m_maxPieces;
+		}
+	}
+	return GetNumTables();
+}
+
+void ChessSyzygyTablebases::Clear()
+{
+	for (ChessSyzygyTable* table : m_tables)
+	{
+		delete table;
+	}
+	m_tables.clear();
+	m_tablesByMaterial.clear();
+	m_maxPieces = 0;
+}
+
+bool ChessSyzygyTablebases::CanProbe(ChessPosition const& position) const
+{
+	return m_maxPieces > 0 && position.m_castlingRights == CASTLE_NONE && GetBitCount(position.GetOccupied()) <= m_maxPieces;
+}
+
+bool ChessSyzygyTablebases::ProbeWdl(ChessPosition const& position, ChessWdl& out_wdl) const
+{
+	if (!CanProbe(position))
+	{
+		return false;
+	}
+	ChessPosition probePosition = position;
+	int state = SYZYGY_PROBE_OK;
+	ChessWdl wdl = SearchWdl(probePosition, false, state);
+	if (state == SYZYGY_PROBE_FAILED)
+	{
+		return false;
+	}
+	out_wdl = wdl;
+	return true;
+}
+
+bool ChessSyzygyTablebases::ProbeDtz(ChessPosition const& position, int& out_dtz) const
+{
+	if (!CanProbe(position))
+	{
+		return false;
+	}
+	ChessPosition probePosition = position;
+	int state = SYZYGY_PROBE_OK;
+	int dtz = SearchDtz(probePosition, state);
+	if (state == SYZYGY_PROBE_FAILED)
+	{
+		return false;
+	}
+	out_dtz = dtz;
+	return true;
+}
+
+bool ChessSyzygyTablebases::ProbeRoot(ChessPosition const& position, ChessMove& out_move, ChessWdl& out_wdl, int& out_dtz) const
+{
+	if (!CanProbe(position))
+	{
+		return false;
+	}
+	ChessPosition probePosition = position;
+	ChessMoveList moves;
+	GenerateLegalMoves(probePosition, moves);
+	if (moves.IsEmpty())
+	{
+		return false;
+	}
+
+	int halfmoveClock = position.m_halfmoveClock;
+	int bestRank = -SYZYGY_MAX_DTZ - 1;
+	int bestDtz = 0;
+	ChessMove bestMove = ChessMove::None();
+	for (ChessMove const& move : moves)
+	{
+		ChessUndoInfo undo;
+		probePosition.MakeMove(move, undo);
+		int state = SYZYGY_PROBE_OK;
+		int dtz = 0;
+		if (probePosition.m_halfmoveClock == 0)
+		{
+			dtz = GetDtzBeforeZeroing(-SearchWdl(probePosition, false, state));
+		}
+		else
+		{
+			// one ply further from the root than the position after the move
+			dtz = -SearchDtz(probePosition, state);
+			dtz = (dtz > 0) ? dtz + 1 : ((dtz < 0) ? dtz - 1 : 0);
+		}
+		if (dtz == 2 && probePosition.IsInCheck(probePosition.m_sideToMove) && !HasAnyLegalMove(probePosition))
+		{
+			dtz = 1;
+		}
+		probePosition.UnmakeMove(move, undo);
+		if (state == SYZYGY_PROBE_FAILED)
+		{
+			return false;
+		}
+
+		// Wins the fifty-move rule can't spoil rank equal, the rest by how far past the rule they go. The same for
+		// losses seen from the other side. Among equals the shortest win and the longest loss are taken.
+		int rank = 0;
+		if (dtz > 0)
+		{
+			rank = (dtz + halfmoveClock <= 99) ? SYZYGY_MAX_DTZ : SYZYGY_MAX_DTZ - (dtz + halfmoveClock);
+		}
+		else if (dtz < 0)
+		{
+			rank = (-dtz * 2 + halfmoveClock < 100) ? -SYZYGY_MAX_DTZ : -SYZYGY_MAX_DTZ + (-dtz + halfmoveClock);
+		}
+		bool isBetter = rank > bestRank || (rank == bestRank && ((dtz > 0 && dtz < bestDtz) || (dtz < 0 && dtz < bestDtz)));
+		if (isBetter)
+		{
+			bestRank = rank;
+			bestDtz = dtz;
+			bestMove = move;
+		}
+	}
+
+	out_move = bestMove;
+	out_dtz = bestDtz;
+	if (bestRank == SYZYGY_MAX_DTZ)
+	{
+		out_wdl = WDL_WIN;
+	}
+	else if (bestRank > 0)
+	{
+		out_wdl = WDL_CURSED_WIN;
+	}
+	else if (bestRank == 0)
+	{
+		out_wdl = WDL_DRAW;
+	}
+	else if (bestRank > -SYZYGY_MAX_DTZ)
+	{
+		out_wdl = WDL_BLESSED_LOSS;
+	}
+	else
+	{
+		out_wdl = WDL_LOSS;
+	}
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int ChessSyzygyTablebases::ProbeTable(ChessPosition const& position, bool isDtz, ChessWdl wdl, int& out_value) const
+{
+	// bare kings have no file
+	if (GetBitCount(position.GetOccupied()) == 2)
+	{
+		out_value = 0;
+		return SYZYGY_PROBE_OK;
+	}
+
+	auto found = m_tablesByMaterial.find(GetMaterialKey(position));
+	if (found == m_tablesByMaterial.end())
+	{
+		return SYZYGY_PROBE_FAILED;
+	}
+	ChessSyzygyTable& table = *found->second;
+	ChessSyzygyTableFile& tableFile = isDtz ? table.m_dtz : table.m_wdl;
+	int fileState = tableFile.m_state.load(std::memory_order_acquire);
+	if (fileState == SYZYGY_FILE_UNMAPPED)
+	{
+		// first probe of this table, any other thread wanting it waits until it is mapped once
+		std::lock_guard<std::mutex> lock(m_mappingMutex);
+		fileState = tableFile.m_state.load(std::memory_order_relaxed);
+		if (fileState == SYZYGY_FILE_UNMAPPED)
+		{
+			fileState = MapTableFile(table, tableFile, isDtz) ? SYZYGY_FILE_READY : SYZYGY_FILE_BROKEN;
+			tableFile.m_state.store(fileState, std::memory_order_release);
+		}
+	}
+	if (fileState != SYZYGY_FILE_READY)
+	{
+		return SYZYGY_PROBE_FAILED;
+	}
+	return ProbeTableFile(position, table, tableFile, isDtz, wdl, out_value);
+}
+
+bool ChessSyzygyTablebases::MapTableFile(ChessSyzygyTable& table, ChessSyzygyTableFile& tableFile, bool isDtz) const
+{
+	if (!tableFile.m_isPresent)
+	{
+		return false;
+	}
+
+	std::string errorMessage;
+	std::filesystem::path path = std::filesystem::path(table.m_directory) / (table.m_name + (isDtz ? ".rtbz" : ".rtbw"));
+	if (!tableFile.m_file.Open(path.string(), errorMessage))
+	{
+		return false;
+	}
+
+	// every table file is a multiple of 64 bytes plus the 16 byte header
+	unsigned char const* magic = isDtz ? SYZYGY_DTZ_MAGIC : SYZYGY_WDL_MAGIC;
+	unsigned char const* data = tableFile.m_file.GetData();
+	bool isValid = tableFile.m_file.GetSize() % 64 == 16 && data[0] == magic[0] && data[1] == magic[1] && data[2] == magic[2] && data[3] == magic[3];
+	if (!isValid || !SetUpTableFile(table, tableFile, isDtz))
+	{
+		tableFile.m_file.Close();
+		return false;
+	}
+	return true;
+}
+
+// The tables store "don't care" values where the side to move has a winning capture, whatever compressed best,
+// and know nothing of en passant. So captures are always tried first and the table only decides the rest.
+ChessWdl ChessSyzygyTablebases::SearchWdl(ChessPosition& position, bool isCheckingPawnMoves, int& out_state) const
+{
+	ChessMoveList moves;
+	GenerateLegalMoves(position, moves);
+	int bestValue = WDL_LOSS;
+	int numZeroingMoves = 0;
+	for (ChessMove const& move : moves)
+	{
+		bool isPawnMove = position.GetPieceTypeAt(move.GetFromSquare()) == PieceType::PAWN;
+		if (!move.IsCapture() && (!isCheckingPawnMoves || !isPawnMove))
+		{
+			continue;
+		}
+		numZeroingMoves++;
+
+		ChessUndoInfo undo;
+		position.MakeMove(move, undo);
+		int value = -SearchWdl(position, false, out_state);
+		position.UnmakeMove(move, undo);
+		if (out_state == SYZYGY_PROBE_FAILED)
+		{
+			return WDL_DRAW;
+		}
+		if (value > bestValue)
+		{
+			bestValue = value;
+			if (value >= WDL_WIN)
+			{
+				out_state = SYZYGY_PROBE_ZEROING_IS_BEST;
+				return WDL_WIN;
+			}
+		}
+	}
+
+	// with every legal move tried already the table has nothing to add, and may well be wrong
+	bool isAllMovesTried = numZeroingMoves > 0 && numZeroingMoves == moves.GetCount();
+	int value = bestValue;
+	if (!isAllMovesTried)
+	{
+		out_state = ProbeTable(position, false, WDL_DRAW, value);
+		if (out_state == SYZYGY_PROBE_FAILED)
+		{
+			return WDL_DRAW;
+		}
+	}
+
+	if (bestValue >= value)
+	{
+		out_state = (bestValue > WDL_DRAW || isAllMovesTried) ? SYZYGY_PROBE_ZEROING_IS_BEST : SYZYGY_PROBE_OK;
+		return static_cast<ChessWdl>(bestValue);
+	}
+	out_state = SYZYGY_PROBE_OK;
+	return static_cast<ChessWdl>(value);
+}
+
+int ChessSyzygyTablebases::SearchDtz(ChessPosition& position, int& out_state) const
+{
+	out_state = SYZYGY_PROBE_OK;
+	ChessWdl wdl = SearchWdl(position, true, out_state);
+	if (out_state == SYZYGY_PROBE_FAILED || wdl == WDL_DRAW)
+	{
+		return 0;
+	}
+	if (out_state == SYZYGY_PROBE_ZEROING_IS_BEST)
+	{
+		return GetDtzBeforeZeroing(wdl);
+	}
+
+	int dtz = 0;
+	out_state = ProbeTable(position, true, wdl, dtz);
+	if (out_state == SYZYGY_PROBE_FAILED)
+	{
+		return 0;
+	}
+	if (out_state != SYZYGY_PROBE_OTHER_SIDE_TO_MOVE)
+	{
+		bool isPastFiftyMoves = wdl == WDL_CURSED_WIN || wdl == WDL_BLESSED_LOSS;
+		return (dtz + (isPastFiftyMoves ? 100 : 0)) * GetWdlSign(wdl);
+	}
+
+	// the file is for the other side to move: the best DTZ after each move, one ply further away
+	int minDtz = 0xFFFF;
+	ChessMoveList moves;
+	GenerateLegalMoves(position, moves);
+	for (ChessMove const& move : moves)
+	{
+		bool isZeroing = move.IsCapture() || position.GetPieceTypeAt(move.GetFromSquare()) == PieceType::PAWN;
+		ChessUndoInfo undo;
+		position.MakeMove(move, undo);
+		// a zeroing move's DTZ is the one before it is made, the search after it only gives the sign
+		dtz = isZeroing ? -GetDtzBeforeZeroing(SearchWdl(position, false, out_state)) : -SearchDtz(position, out_state);
+		if (dtz == 1 && position.IsInCheck(position.m_sideToMove) && !HasAnyLegalMove(position))
+		{
+			minDtz = 1;
+		}
+		if (!isZeroing)
+		{
+			dtz += GetWdlSign(dtz);
+		}
+		if (dtz < minDtz && GetWdlSign(dtz) == GetWdlSign(wdl))
+		{
+			minDtz = dtz;
+		}
+		position.UnmakeMove(move, undo);
+		if (out_state == SYZYGY_PROBE_FAILED)
+		{
+			return 0;
+		}
+	}
+	// no legal move is mate
+	return (minDtz == 0xFFFF) ? -1 : minDtz;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "ChessCore/ChessPosition.hpp"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ChessSyzygyTable;
+struct ChessSyzygyTableFile;
+
+
+//-----------------------------------------------------------------------------------------------
+// Game theoretic value for the side to move. Cursed wins and blessed losses are wins and losses
+// that take more than fifty moves without a capture or pawn move, so the rule makes them draws.
+enum ChessWdl
+{
+	WDL_LOSS			= -2,
+	WDL_BLESSED_LOSS	= -1,
+	WDL_DRAW			= 0,
+	WDL_CURSED_WIN		= 1,
+	WDL_WIN				= 2,
+};
+
+constexpr int MAX_SYZYGY_PIECES = 7; // kings included, the largest tables ever generated
+
+
+//-----------------------------------------------------------------------------------------------
+// Syzygy endgame tablebases: .rtbw files hold win/draw/loss, .rtbz files the distance to the next
+// capture or pawn move (DTZ) that keeps the result. Initialize only scans the directories, each file
+// is memory-mapped (see ChessMappedFile) the first time a probe needs it, so a full set of tables
+// costs nothing until the game reaches those endings.
+// Probes are safe from any number of threads, they only lock while a file is being mapped.
+class ChessSyzygyTablebases
+{
+public:
+	ChessSyzygyTablebases() = default;
+	ChessSyzygyTablebases(ChessSyzygyTablebases const& copy) = delete;
+	~ChessSyzygyTablebases();
+
+	// directories are separated by ';', returns the number of tables found. Any tables from before are dropped.
+	int		Initialize(std::string const& directories);
+	void	Clear();
+	int		GetNumTables() const { return static_cast<int>(m_tables.size()); }
+	int		GetMaxPieces() const { return m_maxPieces; } // 0 without tables
+
+	// Few enough pieces for the tables found and no castling rights, which the tables don't know about
+	bool	CanProbe(ChessPosition const& position) const;
+
+	// Both are false when a table the probe needs is missing or unreadable. The result is the one right after
+	// a capture or pawn move, the halfmove clock is not taken into account.
+	bool	ProbeWdl(ChessPosition const& position, ChessWdl& out_wdl) const;
+	bool	ProbeDtz(ChessPosition const& position, int& out_dtz) const; // plies, positive when winning, 0 for a draw
+
+	// The move that keeps the best result with the halfmove clock already on the board and gets to the next
+	// capture or pawn move fastest when winning, slowest when losing. out_wdl is the result of the position.
+	bool	ProbeRoot(ChessPosition const& position, ChessMove& out_move, ChessWdl& out_wdl, int& out_dtz) const;
+
+private:
+	int		ProbeTable(ChessPosition const& position, bool isDtz, ChessWdl wdl, int& out_value) const;
+	bool	MapTableFile(ChessSyzygyTable& table, ChessSyzygyTableFile& tableFile, bool isDtz) const;
+	ChessWdl SearchWdl(ChessPosition& position, bool isCheckingPawnMoves, int& out_state) const;
+	int		SearchDtz(ChessPosition& position, int& out_state) const;
+
+private:
+	std::vector<ChessSyzygyTable*>						m_tables;
+	std::unordered_map<uint64_t, ChessSyzygyTable*>	m_tablesByMaterial; // each table is in twice, once per colour it can be seen with
+	int													m_maxPieces = 0;
+	mutable std::mutex									m_mappingMutex;
+};
@@ -0,0 +1,58 @@
+#include "ChessCore/ChessTimeManager.hpp"
+#include "ChessCore/ChessSearch.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+static int GetMinLimit(int limitA, int limitB)
+{
+	if (limitA == 0)
+	{
+		return limitB;
+	}
+	return (limitB != 0 && limitB < limitA) ? limitB : limitA;
+}
+
+ChessTimeBudget GetTimeBudget(ChessSearchLimits const& limits, PlayerSide sideToMove)
+{
+	ChessTimeBudget budget;
+	if (limits.m_moveTimeMs > 0)
+	{
+		// a very short movetime can't spare the whole overhead, it gives up half instead
+		int moveTimeMs = (limits.m_moveTimeMs > 2 * TIME_MOVE_OVERHEAD_MS) ? limits.m_moveTimeMs - TIME_MOVE_OVERHEAD_MS : limits.m_moveTimeMs / 2;
+		budget.m_softMs = (moveTimeMs > 0) ? moveTimeMs : 1;
+		budget.m_hardMs = budget.m_softMs;
+	}
+
+	if (sideToMove != PLAYER_WHITE && sideToMove != PLAYER_BLACK)
+	{
+		return budget;
+	}
+	int64_t timeLeftMs = limits.m_timeLeftMs[sideToMove];
+	if (timeLeftMs <= 0)
+	{
+		return budget;
+	}
+
+	int64_t incrementMs = (limits.m_incrementMs[sideToMove] > 0) ? limits.m_incrementMs[sideToMove] : 0;
+	int64_t movesToGo = (limits.m_movesToGo > 0) ? limits.m_movesToGo : TIME_DEFAULT_MOVES_TO_GO;
+	int64_t availableMs = (timeLeftMs > TIME_MOVE_OVERHEAD_MS) ? timeLeftMs - TIME_MOVE_OVERHEAD_MS : 1;
+
+	// an even share of what is left plus most of the increment, which comes back after the move anyway
+	int64_t targetMs = availableMs / movesToGo + incrementMs * 3 / 4;
+
+	// never so much that the next moves are left short, the last move before the time control may use it all
+	int64_t hardMs = targetMs * TIME_HARD_LIMIT_FACTOR;
+	int64_t hardCapMs = (movesToGo > 1) ? availableMs / 2 : availableMs;
+	hardMs = (hardMs < hardCapMs) ? hardMs : hardCapMs;
+	hardMs = (hardMs > 1) ? hardMs : 1;
+
+	// the next iteration usually takes as long as all the ones before it, so starting one past half the
+	// target tends to land the move close to the target
+	int64_t softMs = targetMs / 2;
+	softMs = (softMs < hardMs) ? softMs : hardMs;
+	softMs = (softMs > 1) ? softMs : 1;
+
+	budget.m_softMs = GetMinLimit(budget.m_softMs, static_cast<int>(softMs));
+	budget.m_hardMs = GetMinLimit(budget.m_hardMs, static_cast<int>(hardMs));
+	return budget;
+}
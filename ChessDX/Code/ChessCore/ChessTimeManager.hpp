@@ -0,0 +1,23 @@
+#pragma once
+#include "ChessCore/ChessTypes.hpp"
+
+struct ChessSearchLimits;
+
+
+//-----------------------------------------------------------------------------------------------
+constexpr int TIME_MOVE_OVERHEAD_MS		= 30; // kept back on every move for waking threads, the frame that plays the move and the network
+constexpr int TIME_DEFAULT_MOVES_TO_GO	= 30; // how many more moves a sudden death game is expected to need
+constexpr int TIME_HARD_LIMIT_FACTOR	= 4; // how far past its share of the clock a single move may run
+
+
+//-----------------------------------------------------------------------------------------------
+// Milliseconds from the start of the move, 0 when there is no time limit at all.
+// Iterative deepening starts no new iteration past the soft limit, the search is cut off at the hard one.
+struct ChessTimeBudget
+{
+	int m_softMs = 0;
+	int m_hardMs = 0;
+};
+
+// A fixed movetime is used in full, a clock is shared out over the moves still to play
+ChessTimeBudget GetTimeBudget(ChessSearchLimits const& limits, PlayerSide sideToMove);
@@ -0,0 +1,176 @@
+#include "ChessCore/ChessTranspositionTable.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+constexpr uint8_t TT_AGE_MASK = 0x3F;
+
+static uint64_t PackData(ChessMove const& move, int score, int depth, ChessBound bound, uint8_t age)
+{
+	return static_cast<uint64_t>(move.GetRawData())
+		| (static_cast<uint64_t>(static_cast<uint16_t>(static_cast<int16_t>(score))) << 16)
+		| (static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 32)
+		| (static_cast<uint64_t>(bound) << 40)
+		| (static_cast<uint64_t>(age & TT_AGE_MASK) << 42);
+}
+
+static int GetDepthFromData(uint64_t data)
+{
+	return static_cast<int>((data >> 32) & 0xFF);
+}
+
+static ChessBound GetBoundFromData(uint64_t data)
+{
+	return static_cast<ChessBound>((data >> 40) & 3);
+}
+
+static uint8_t GetAgeFromData(uint64_t data)
+{
+	return static_cast<uint8_t>((data >> 42) & TT_AGE_MASK);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ChessTranspositionTable::~ChessTranspositionTable()
+{
+	delete[] m_buckets;
+	m_buckets = nullptr;
+}
+
+void ChessTranspositionTable::Resize(int sizeMB)
+{
+	uint64_t maxBuckets = (static_cast<uint64_t>(sizeMB > 0 ? sizeMB : 1) << 20) / sizeof(ChessTTBucket);
+	uint64_t numBuckets = 1;
+	while (numBuckets * 2 <= maxBuckets)
+	{
+		numBuckets *= 2;
+	}
+
+	delete[] m_buckets;
+	m_buckets = new ChessTTBucket[numBuckets];
+	m_bucketMask = numBuckets - 1;
+	Clear();
+}
+
+void ChessTranspositionTable::Clear()
+{
+	for (uint64_t bucketIndex = 0; bucketIndex <= m_bucketMask && m_buckets != nullptr; ++bucketIndex)
+	{
+		for (ChessTTEntry& entry : m_buckets[bucketIndex].m_entries)
+		{
+			entry.m_keyXorData.store(0, std::memory_order_relaxed);
+			entry.m_data.store(0, std::memory_order_relaxed);
+		}
+	}
+	m_age = 0;
+}
+
+void ChessTranspositionTable::NewSearch()
+{
+	m_age = (m_age + 1) & TT_AGE_MASK;
+}
+
+bool ChessTranspositionTable::Probe(uint64_t key, ChessTTData& out_data) const
+{
+	if (m_buckets == nullptr)
+	{
+		return false;
+	}
+
+	for (ChessTTEntry const& entry : GetBucket(key).m_entries)
+	{
+		uint64_t data = entry.m_data.load(std::memory_order_relaxed);
+		uint64_t keyXorData = entry.m_keyXorData.load(std::memory_order_relaxed);
+		if ((keyXorData ^ data) != key || GetBoundFromData(data) == BOUND_NONE)
+		{
+			continue;
+		}
+		out_data.m_move = ChessMove::FromRawData(static_cast<uint16_t>(data));
+		out_data.m_score = static_cast<int16_t>(data >> 16);
+		out_data.m_depth = GetDepthFromData(data);
+		out_data.m_bound = GetBoundFromData(data);
+		return true;
+	}
+	return false;
+}
+
+void ChessTranspositionTable::Store(uint64_t key, ChessMove const& move, int score, int depth, ChessBound bound)
+{
+	if (m_buckets == nullptr)
+	{
+		return;
+	}
+
+	// Same position first, otherwise the entry that is shallowest once staleness is counted against it
+	ChessTTEntry* replaced = nullptr;
+	int replacedWorth = 0x7FFFFFFF;
+	uint64_t replacedData = 0;
+	for (ChessTTEntry& entry : GetBucket(key).m_entries)
+	{
+		uint64_t data = entry.m_data.load(std::memory_order_relaxed);
+		uint64_t keyXorData = entry.m_keyXorData.load(std::memory_order_relaxed);
+		if ((keyXorData ^ data) == key)
+		{
+			replaced = &entry;
+			replacedData = data;
+			break;
+		}
+
+		int ageDistance = (m_age - GetAgeFromData(data)) & TT_AGE_MASK;
+		int worth = GetDepthFromData(data) - 8 * ageDistance;
+		if (worth < replacedWorth)
+		{
+			replaced = &entry;
+			replacedWorth = worth;
+			replacedData = data;
+		}
+	}
+
+	bool isSamePosition = (replaced->m_keyXorData.load(std::memory_order_relaxed) ^ replacedData) == key;
+	if (isSamePosition)
+	{
+		// a shallow result doesn't wipe out a deeper one from this search, and a known best move is kept
+		if (bound != BOUND_EXACT && depth + 2 < GetDepthFromData(replacedData) && GetAgeFromData(replacedData) == m_age)
+		{
+			return;
+		}
+	}
+
+	ChessMove storedMove = (move.IsNone() && isSamePosition) ? ChessMove::FromRawData(static_cast<uint16_t>(replacedData)) : move;
+	uint64_t data = PackData(storedMove, score, (depth > 0) ? depth : 0, bound, m_age);
+	replaced->m_data.store(data, std::memory_order_relaxed);
+	replaced->m_keyXorData.store(key ^ data, std::memory_order_relaxed);
+}
+
+int ChessTranspositionTable::GetHashfullPermille() const
+{
+	if (m_buckets == nullptr)
+	{
+		return 0;
+	}
+
+	int numSampled = 0;
+	int numUsed = 0;
+	for (uint64_t bucketIndex = 0; bucketIndex <= m_bucketMask && numSampled < 1000; ++bucketIndex)
+	{
+		for (ChessTTEntry const& entry : m_buckets[bucketIndex].m_entries)
+		{
+			uint64_t data = entry.m_data.load(std::memory_order_relaxed);
+			if (GetBoundFromData(data) != BOUND_NONE && GetAgeFromData(data) == m_age)
+			{
+				numUsed++;
+			}
+			numSampled++;
+		}
+	}
+	return numUsed * 1000 / numSampled;
+}
+
+int ChessTranspositionTable::GetSizeMB() const
+{
+	return static_cast<int>(((m_bucketMask + 1) * sizeof(ChessTTBucket)) >> 20);
+}
+
+ChessTTBucket& ChessTranspositionTable::GetBucket(uint64_t key) const
+{
+	return m_buckets[key & m_bucketMask];
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "ChessCore/ChessMove.hpp"
+#include <atomic>
+#include <cstdint>
+
+
+//-----------------------------------------------------------------------------------------------
+enum ChessBound : uint8_t
+{
+	BOUND_NONE	= 0,
+	BOUND_UPPER	= 1, // every move failed low, score is at most this
+	BOUND_LOWER	= 2, // a move failed high, score is at least this
+	BOUND_EXACT	= 3,
+};
+
+struct ChessTTData
+{
+	ChessMove	m_move;
+	int			m_score;
+	int			m_depth;
+	ChessBound	m_bound;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// 16 bytes: the payload packed into one word and the key xor'd with it in the other. A reader that
+// catches the two words from different writes gets a key that doesn't verify, so no lock is needed.
+struct ChessTTEntry
+{
+	std::atomic<uint64_t>	m_keyXorData;
+	std::atomic<uint64_t>	m_data; // move 0-15, score 16-31, depth 32-39, bound 40-41, age 42-47
+};
+
+constexpr int CHESS_TT_BUCKET_SIZE = 4;
+
+struct alignas(64) ChessTTBucket
+{
+	ChessTTEntry	m_entries[CHESS_TT_BUCKET_SIZE];
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Shared by every search thread, all access is lock free with relaxed atomics.
+// Scores are stored as given, mate scores must be made relative to the node by the caller.
+class ChessTranspositionTable
+{
+public:
+	ChessTranspositionTable() = default;
+	ChessTranspositionTable(ChessTranspositionTable const& copy) = delete;
+	~ChessTranspositionTable();
+
+	void	Resize(int sizeMB); // rounded down to a power of two buckets, clears the table
+	void	Clear();
+	void	NewSearch(); // call once before every search, older entries then lose replacement fights
+
+	bool	Probe(uint64_t key, ChessTTData& out_data) const;
+	void	Store(uint64_t key, ChessMove const& move, int score, int depth, ChessBound bound);
+
+	int		GetHashfullPermille() const; // share of a sample of entries written by the current search
+	int		GetSizeMB() const;
+
+private:
+	ChessTTBucket&	GetBucket(uint64_t key) const;
+
+private:
+	ChessTTBucket*	m_buckets = nullptr;
+	uint64_t		m_bucketMask = 0; // bucket count minus one
+	uint8_t			m_age = 0;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+// Shared by ChessCore and the game, nothing in ChessCore may include Engine or Game headers
+enum PlayerSide
+{
+	PLAYER_UNKNOWN = -1,
+	PLAYER_WHITE, // White goes first
+	PLAYER_BLACK,
+	PLAYER_SIDE_NUM
+};
+
+enum class PieceType
+{
+	UNKNOWN = -1,
+	KING,	// K
+	QUEEN,	// Q
+	ROOK,	// R
+	BISHOP, // B
+	KNIGHT, // N
+	PAWN,	// P
+	NUM
+};
+
+inline PlayerSide GetOpponentPlayerSide(PlayerSide side)
+{
+	return (side == PLAYER_WHITE) ? PLAYER_BLACK : PLAYER_WHITE;
+}
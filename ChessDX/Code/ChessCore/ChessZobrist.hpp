@@ -0,0 +1,75 @@
+#pragma once
+#include "ChessCore/ChessTypes.hpp"
+#include "ChessCore/ChessBitboard.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Random keys for incremental position hashing, generated at compile time with splitmix64 so
+// every build (and both ends of a network match) agree on the same keys
+struct ChessZobristKeys
+{
+	uint64_t m_pieces[PLAYER_SIDE_NUM][(int)PieceType::NUM][NUM_SQUARES] = {};
+	uint64_t m_castlingRights[16] = {};
+	uint64_t m_enPassantFile[8] = {};
+	uint64_t m_blackToMove = 0;
+};
+
+constexpr uint64_t GetNextSplitMix64(uint64_t& state)
+{
+	state += 0x9E3779B97F4A7C15ULL;
+	uint64_t result = state;
+	result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	result = (result ^ (result >> 27)) * 0x94D049BB133111EBULL;
+	return result ^ (result >> 31);
+}
+
+constexpr ChessZobristKeys GenerateChessZobristKeys()
+{
+	ChessZobristKeys keys;
+	uint64_t state = 0x43484553535A4F42ULL;
+	for (int side = 0; side < PLAYER_SIDE_NUM; ++side)
+	{
+		for (int type = 0; type < (int)PieceType::NUM; ++type)
+		{
+			for (int square = 0; square < NUM_SQUARES; ++square)
+			{
+				keys.m_pieces[side][type][square] = GetNextSplitMix64(state);
+			}
+		}
+	}
+	// castling keys are per combination of rights, so a rights change is a single xor
+	for (int rights = 1; rights < 16; ++rights)
+	{
+		keys.m_castlingRights[rights] = GetNextSplitMix64(state);
+	}
+	for (int file = 0; file < 8; ++file)
+	{
+		keys.m_enPassantFile[file] = GetNextSplitMix64(state);
+	}
+	keys.m_blackToMove = GetNextSplitMix64(state);
+	return keys;
+}
+
+inline constexpr ChessZobristKeys g_chessZobristKeys = GenerateChessZobristKeys();
+
+
+//-----------------------------------------------------------------------------------------------
+inline uint64_t GetZobristPieceKey(PlayerSide side, PieceType type, int square)
+{
+	return g_chessZobristKeys.m_pieces[side][(int)type][square];
+}
+
+inline uint64_t GetZobristCastlingKey(uint8_t castlingRights)
+{
+	return g_chessZobristKeys.m_castlingRights[castlingRights];
+}
+
+inline uint64_t GetZobristEnPassantKey(int enPassantSquare)
+{
+	return (enPassantSquare == SQUARE_NONE) ? 0 : g_chessZobristKeys.m_enPassantFile[GetFileOfSquare(enPassantSquare)];
+}
+
+inline uint64_t GetZobristSideKey()
+{
+	return g_chessZobristKeys.m_blackToMove;
+}
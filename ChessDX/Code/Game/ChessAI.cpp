@@ -0,0 +1,225 @@
+#include "Game/ChessAI.hpp"
+#include "ChessCore/ChessZobrist.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+ChessAI::ChessAI(int transpositionTableMB, int numSearchThreads, std::string const& evalNetworkPath)
+{
+	m_table = new ChessTranspositionTable();
+	m_table->Resize(transpositionTableMB);
+	if (!evalNetworkPath.empty())
+	{
+		m_network = new ChessNNUENetwork();
+		if (!m_network->LoadFromFile(evalNetworkPath, m_networkError))
+		{
+			delete m_network;
+			m_network = nullptr;
+		}
+	}
+	m_search = new ChessParallelSearch();
+	m_search->SetNumThreads(numSearchThreads);
+	m_search->SetTranspositionTable(m_table);
+	m_search->SetEvalNetwork(m_network);
+	m_jobGameKeys.reserve(MAX_SEARCH_GAME_KEYS);
+	m_randomState = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+	m_thread = std::thread(&ChessAI::ThreadMain, this);
+}
+
+ChessAI::~ChessAI()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+		m_hasJob = false;
+		m_stopSignal = true;
+	}
+	m_jobCondition.notify_one();
+	m_thread.join();
+
+	delete m_search;
+	m_search = nullptr;
+	delete m_table;
+	m_table = nullptr;
+	delete m_network;
+	m_network = nullptr;
+}
+
+void ChessAI::StartThinking(ChessPosition const& position, std::vector<uint64_t> const& gameKeys, ChessSearchLimits const& limits)
+{
+	PostJob(position, gameKeys, limits, false);
+}
+
+void ChessAI::StopThinking()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_hasJob = false;
+	m_isSearchCancelled = true;
+	m_stopSignal = true;
+	DropPonder();
+	m_results.clear();
+}
+
+void ChessAI::StartPondering(ChessPosition const& position, std::vector<uint64_t> const& gameKeys, ChessSearchLimits const& limits)
+{
+	PostJob(position, gameKeys, limits, true);
+}
+
+bool ChessAI::PonderHit(uint64_t positionKey)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_isPondering)
+	{
+		return false;
+	}
+	if (positionKey != m_ponderKey)
+	{
+		// the search on the wrong position is only in the way of the real one
+		m_hasJob = false;
+		m_isSearchCancelled = true;
+		m_stopSignal = true;
+		DropPonder();
+		return false;
+	}
+
+	m_isPondering = false;
+	if (m_hasPonderResult)
+	{
+		m_results.push_back(m_ponderResult);
+		m_hasPonderResult = false;
+	}
+	else
+	{
+		m_isPonderHit = true;
+	}
+	return true;
+}
+
+bool ChessAI::IsThinking() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_hasJob || m_isSearching;
+}
+
+bool ChessAI::PopResult(ChessSearchResult& out_result)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_results.empty())
+	{
+		return false;
+	}
+	out_result = m_results.front();
+	m_results.pop_front();
+	return true;
+}
+
+void ChessAI::SetOpeningBook(ChessPolyglotBook const* book)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_book = book;
+}
+
+void ChessAI::PostJob(ChessPosition const& position, std::vector<uint64_t> const& gameKeys, ChessSearchLimits const& limits, bool isPonder)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		// a search already running is cut short, the worker picks this job up as soon as it returns
+		m_isSearchCancelled = true;
+		m_stopSignal = true;
+		DropPonder();
+		m_jobPosition = position;
+		m_jobGameKeys = gameKeys;
+		m_jobLimits = limits;
+		m_jobLimits.m_stopSignal = &m_stopSignal;
+		if (m_jobLimits.m_startTime == std::chrono::steady_clock::time_point())
+		{
+			// the move's time runs from now, not from when the worker is done winding down the last search
+			m_jobLimits.m_startTime = std::chrono::steady_clock::now();
+		}
+		m_isJobPonder = isPonder;
+		m_isPondering = isPonder;
+		m_ponderKey = position.m_key;
+		m_hasJob = true;
+	}
+	m_jobCondition.notify_one();
+}
+
+void ChessAI::DropPonder()
+{
+	m_isPondering = false;
+	m_isPonderHit = false;
+	m_hasPonderResult = false;
+}
+
+void ChessAI::SetTablebases(ChessSyzygyTablebases const* tablebases)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_tablebases = tablebases;
+}
+
+void ChessAI::ThreadMain()
+{
+	ChessPosition position;
+	std::vector<uint64_t> gameKeys;
+	gameKeys.reserve(MAX_SEARCH_GAME_KEYS);
+	ChessSearchLimits limits;
+	ChessPolyglotBook const* book = nullptr;
+	ChessSyzygyTablebases const* tablebases = nullptr;
+	bool isPonder = false;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobCondition.wait(lock, [this]() { return m_hasJob || m_isQuitting; });
+			if (m_isQuitting)
+			{
+				return;
+			}
+			position = m_jobPosition;
+			gameKeys.swap(m_jobGameKeys);
+			limits = m_jobLimits;
+			book = m_book;
+			tablebases = m_tablebases;
+			isPonder = m_isJobPonder;
+			m_hasJob = false;
+			m_isSearching = true;
+			m_isSearchCancelled = false;
+			m_stopSignal = false; // under the lock, so a StartThinking or StopThinking after this point still lands
+		}
+
+		// a known opening move costs one lookup instead of seconds of search
+		ChessSearchResult result;
+		ChessMove bookMove = (book != nullptr) ? book->PickMove(position, GetNextSplitMix64(m_randomState)) : ChessMove::None();
+		if (!bookMove.IsNone())
+		{
+			result.m_rootKey = position.m_key;
+			result.m_bestMove = bookMove;
+			result.m_pv[0] = bookMove;
+			result.m_pvLength = 1;
+			result.m_isBookMove = true;
+		}
+		else
+		{
+			m_table->NewSearch();
+			m_search->SetTablebases(tablebases);
+			result = m_search->Search(position, gameKeys.data(), static_cast<int>(gameKeys.size()), limits);
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_isSearchCancelled) // stopped or replaced, its result is worthless
+		{
+			if (!isPonder || m_isPonderHit)
+			{
+				m_results.push_back(result);
+				m_isPonderHit = false;
+			}
+			else if (m_isPondering)
+			{
+				// the opponent has yet to move, a hit picks it up from here
+				m_ponderResult = result;
+				m_hasPonderResult = true;
+			}
+		}
+		m_isSearching = false;
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "ChessCore/ChessParallelSearch.hpp"
+#include "ChessCore/ChessPolyglotBook.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+//-----------------------------------------------------------------------------------------------
+// Computer opponent. Owns one worker thread that searches a snapshot of the match position and
+// queues the result, the main thread only ever posts jobs and polls the queue so it never waits on a search.
+// The worker is the Lazy SMP main thread, helpers are started per search.
+// Pondering searches the position the AI expects after the opponent's reply while the opponent thinks.
+// Its clock runs from the start of the ponder, so a hit finishes within the budget a normal search has
+// and answers at once when the ponder already used it.
+class ChessAI
+{
+public:
+	// 0 threads for one per hardware thread, an empty or unloadable network path keeps the handcrafted evaluation
+	ChessAI(int transpositionTableMB, int numSearchThreads, std::string const& evalNetworkPath);
+	~ChessAI(); // stops any search and joins the worker
+
+	void StartThinking(ChessPosition const& position, std::vector<uint64_t> const& gameKeys, ChessSearchLimits const& limits); // replaces any job in flight
+	void StopThinking(); // the current search is abandoned and any result not yet popped is dropped
+	void StartPondering(ChessPosition const& position, std::vector<uint64_t> const& gameKeys, ChessSearchLimits const& limits); // position after the expected reply
+	bool PonderHit(uint64_t positionKey); // the actual position, true when the ponder becomes the real search, otherwise it is dropped
+	bool IsThinking() const;
+	bool PopResult(ChessSearchResult& out_result); // main thread, false when nothing is ready
+	bool IsUsingEvalNetwork() const { return m_network != nullptr; }
+	std::string const& GetEvalNetworkError() const { return m_networkError; } // why the network did not load
+	void SetOpeningBook(ChessPolyglotBook const* book); // not owned and must outlive the AI, nullptr to always search
+	void SetTablebases(ChessSyzygyTablebases const* tablebases); // not owned and must outlive the AI, nullptr to never probe
+
+private:
+	void PostJob(ChessPosition const& position, std::vector<uint64_t> const& gameKeys, ChessSearchLimits const& limits, bool isPonder);
+	void DropPonder(); // under m_mutex
+	void ThreadMain();
+
+private:
+	std::thread					m_thread;
+	mutable std::mutex			m_mutex; // guards everything below except m_stopSignal
+	std::condition_variable		m_jobCondition;
+	bool						m_isQuitting = false;
+	bool						m_hasJob = false;
+	bool						m_isSearching = false;
+	bool						m_isSearchCancelled = false; // the running search was stopped or replaced, its result is never queued
+	bool						m_isJobPonder = false;
+	bool						m_isPondering = false; // a ponder search is running or parked its result, no hit or miss yet
+	bool						m_isPonderHit = false; // the ponder search still running is the real search now
+	uint64_t					m_ponderKey = 0;
+	bool						m_hasPonderResult = false;
+	ChessSearchResult			m_ponderResult; // a ponder that finished before the opponent moved waits here for the hit
+
+	ChessPosition				m_jobPosition;
+	std::vector<uint64_t>		m_jobGameKeys;
+	ChessSearchLimits			m_jobLimits;
+	std::deque<ChessSearchResult> m_results;
+	ChessPolyglotBook const*	m_book = nullptr;
+	ChessSyzygyTablebases const* m_tablebases = nullptr;
+
+	std::atomic<bool>			m_stopSignal = false;
+	ChessParallelSearch*		m_search = nullptr; // worker only, its helper threads live only while it searches
+	ChessTranspositionTable*	m_table = nullptr; // worker only, kept between moves
+	ChessNNUENetwork*			m_network = nullptr; // read only once loaded, shared by every search thread
+	std::string					m_networkError;
+	uint64_t					m_randomState = 0; // worker only, picks between book moves
+};
@@ -4,12 +4,22 @@
 #include "Game/ChessBoard.hpp"
 #include "Game/ChessPiece.hpp"
 #include "Game/ChessPieceDefinition.hpp"
-#include "Game/ChessErrorCheck.hpp"
+#include "Game/ChessAI.hpp"
+#include "ChessCore/ChessErrorCheck.hpp"
+#include "ChessCore/ChessRules.hpp"
+#include "ChessCore/ChessMoveGen.hpp"
+#include "ChessCore/ChessPerft.hpp"
+#include "ChessCore/ChessNotation.hpp"
+#include "ChessCore/ChessSEE.hpp"
+#include "ChessCore/ChessEvaluate.hpp"
+#include "ChessCore/ChessPolyglotBook.hpp"
+#include "ChessCore/ChessSyzygy.hpp"
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Core/DebugRender.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/Input/InputSystem.hpp"
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/Vec3.hpp"
@@ -21,6 +31,7 @@
 #include "Engine/Network/NetworkSystem.hpp"
 
 #include "ThirdParty/imgui/imgui.h"
+#include <cstdlib>
 
 
 ChessMatch::ChessMatch()
@@ -35,13 +46,29 @@ ChessMatch::ChessMatch()
 	g_theEventSystem->SubscribeEventCallbackFunction("ChessDisconnect", ChessMatch::Command_ChessDisconnect);
 	g_theEventSystem->SubscribeEventCallbackFunction("ChessPlayerInfo", ChessMatch::Command_ChessPlayerInfo);
 	g_theEventSystem->SubscribeEventCallbackFunction("ChessResign", ChessMatch::Command_ChessResign);
+	g_theEventSystem->SubscribeEventCallbackFunction("ChessPerft", ChessMatch::Command_ChessPerft);
+	g_theEventSystem->SubscribeEventCallbackFunction("ChessLoadFen", ChessMatch::Command_ChessLoadFen);
+	g_theEventSystem->SubscribeEventCallbackFunction("ChessFen", ChessMatch::Command_ChessFen);
+	g_theEventSystem->SubscribeEventCallbackFunction("ChessAI", ChessMatch::Command_ChessAI);
+	g_theEventSystem->SubscribeEventCallbackFunction("ChessBookMoves", ChessMatch::Command_ChessBookMoves);
 	InitializeBoard();
 	InitializePieces();
 }
 
 ChessMatch::~ChessMatch()
 {
+	delete m_ai;
+	m_ai = nullptr;
+	delete m_openingBook; // after the AI, which reads it
+	m_openingBook = nullptr;
+	delete m_tablebases; // after the AI as well
+	m_tablebases = nullptr;
 	CleanBoardAndPieces();
+	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessBookMoves", ChessMatch::Command_ChessBookMoves);
+	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessAI", ChessMatch::Command_ChessAI);
+	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessFen", ChessMatch::Command_ChessFen);
+	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessLoadFen", ChessMatch::Command_ChessLoadFen);
+	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessPerft", ChessMatch::Command_ChessPerft);
 	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessResign", ChessMatch::Command_ChessResign);
 	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessPlayerInfo", ChessMatch::Command_ChessPlayerInfo);
 	g_theEventSystem->UnsubscribeEventCallbackFunction("ChessDisconnect", ChessMatch::Command_ChessDisconnect);
@@ -58,6 +85,7 @@ void ChessMatch::Update()
 {
 	SwitchToNextState();
 	UpdateCurrentState();
+	UpdateAI();
 	UpdateMouseBasedPieceMovement();
 
 	float deltaSeconds = (float)g_theGame->m_clock->GetDeltaSeconds();
@@ -115,6 +143,34 @@ void ChessMatch::Render() const
 		}
 	}
 
+	if (IsCoordsValid(m_selectedCoords))
+	{
+		// Legal destinations of the selected piece, straight from the per-turn cache; yellow where the
+		// static exchange says the piece would be lost for less than it is worth
+		std::vector<Vertex_PCU> verts;
+		int selectedSquare = GetPieceIndexFromBoardCoords(m_selectedCoords);
+		for (ChessMove const& move : m_legalMoves)
+		{
+			if (move.GetFromSquare() != selectedSquare || (move.IsPromotion() && move.GetPromotionType() != PieceType::QUEEN))
+			{
+				continue;
+			}
+			AABB3 targetBox = AABB3(Vec3::ZERO, Vec3(0.8f, 0.8f, 0.02f));
+			targetBox.SetCenter(GetSquareCenterFromBoardCoords(GetBoardCoordsFromPieceIndex(move.GetToSquare())));
+			AddVertsForAABB3D(verts, targetBox, IsStaticExchangeAtLeast(m_position, move, 0) ? Rgba8::GREEN : Rgba8::YELLOW);
+		}
+		if (!verts.empty())
+		{
+			g_theRenderer->SetModelConstants();
+			g_theRenderer->BindShader(nullptr);
+			g_theRenderer->BindTexture(nullptr);
+			g_theRenderer->SetBlendMode(BlendMode::OPAQUE);
+			g_theRenderer->SetRasterizerMode(RasterizerMode::WIREFRAME_CULL_BACK);
+			g_theRenderer->SetDepthMode(DepthMode::READ_WRITE_LESS_EQUAL);
+			g_theRenderer->DrawVertexArray(verts);
+		}
+	}
+
 	if (IsCoordsValid(m_currentImpactCoords))
 	{
 		AABB3 currentImpactBox = AABB3(Vec3::ZERO, Vec3(1.f, 1.f, 0.05f));
@@ -148,36 +204,41 @@ void ChessMatch::InitializeBoard()
 }
 
 void ChessMatch::InitializePieces()
+{
+	ChessPosition startingPosition;
+	startingPosition.SetToStartingPosition();
+	m_moveHistory.reserve(256);
+	SetPosition(startingPosition);
+}
+
+void ChessMatch::CreatePiecesFromPosition()
 {
 	m_piecesOnBoard.resize(64);
 	m_piecesCaught.reserve(32);
 
-
-	PieceType rowA[8] = { PieceType::ROOK , PieceType::KNIGHT , PieceType::BISHOP ,PieceType::QUEEN ,PieceType::KING ,PieceType::BISHOP ,PieceType::KNIGHT ,PieceType::ROOK };
-	PieceType rowB[8] = { PieceType::PAWN , PieceType::PAWN ,PieceType::PAWN ,PieceType::PAWN ,PieceType::PAWN ,PieceType::PAWN ,PieceType::PAWN ,PieceType::PAWN };
-
-	for (int i = 0; i < 8; ++i)
+	for (int square = 0; square < NUM_SQUARES; ++square)
 	{
-		m_piecesOnBoard[GetPieceIndexFromBoardCoords(IntVec2(i, 0))] =
-			new ChessPiece(this, m_board, rowA[i], PLAYER_WHITE, GetSquareCenterFromBoardCoords(IntVec2(i, 0)));
-	}
-
-	for (int i = 0; i < 8; ++i)
-	{
-		m_piecesOnBoard[GetPieceIndexFromBoardCoords(IntVec2(i, 1))] =
-			new ChessPiece(this, m_board, rowB[i], PLAYER_WHITE, GetSquareCenterFromBoardCoords(IntVec2(i, 1)));
-	}
-
-	for (int i = 0; i < 8; ++i)
-	{
-		m_piecesOnBoard[GetPieceIndexFromBoardCoords(IntVec2(i, 7))] =
-			new ChessPiece(this, m_board, rowA[i], PLAYER_BLACK, GetSquareCenterFromBoardCoords(IntVec2(i, 7)));
+		PieceType type = m_position.GetPieceTypeAt(square);
+		if (type == PieceType::UNKNOWN)
+		{
+			continue;
+		}
+		IntVec2 coords = IntVec2(GetFileOfSquare(square), GetRankOfSquare(square));
+		m_piecesOnBoard[square] = new ChessPiece(this, m_board, type, m_position.GetPlayerSideAt(square), GetSquareCenterFromBoardCoords(coords));
 	}
+}
 
-	for (int i = 0; i < 8; ++i)
+void ChessMatch::SetPosition(ChessPosition const& position)
+{
+	CleanPieces();
+	m_position = position;
+	m_moveHistory.clear();
+	m_selectedCoords = IntVec2(-1, -1);
+	CreatePiecesFromPosition();
+	CacheLegalMoves(); // the state may not change, so EnterState will not refresh it
+	if (IsAITurn())
 	{
-		m_piecesOnBoard[GetPieceIndexFromBoardCoords(IntVec2(i, 6))] =
-			new ChessPiece(this, m_board, rowB[i], PLAYER_BLACK, GetSquareCenterFromBoardCoords(IntVec2(i, 6)));
+		StartAIThinking();
 	}
 }
 
@@ -186,6 +247,11 @@ void ChessMatch::CleanBoardAndPieces()
 	delete m_board;
 	m_board = nullptr;
 
+	CleanPieces();
+}
+
+void ChessMatch::CleanPieces()
+{
 	for (ChessPiece* piece : m_piecesOnBoard)
 	{
 		delete piece;
@@ -234,6 +300,11 @@ STATIC int ChessMatch::GetPieceIndexFromBoardCoords(IntVec2 const& coords)
 	return coords.x + coords.y * 8;
 }
 
+STATIC IntVec2 ChessMatch::GetBoardCoordsFromPieceIndex(int pieceIndex)
+{
+	return IntVec2(pieceIndex % 8, pieceIndex / 8);
+}
+
 STATIC IntVec2 ChessMatch::GetBoardCoordsFromWorldPos(Vec3 const& worldPos)
 {
 	IntVec2 result;
@@ -253,12 +324,13 @@ Vec3 ChessMatch::GetNextEmptyWorldPosForCaughtPiece() const
 
 char ChessMatch::GetGlyghFromBoardCoords(IntVec2 const& coords) const
 {
-	ChessPiece* piece = m_piecesOnBoard[GetPieceIndexFromBoardCoords(coords)];
-	if (piece == nullptr)
+	int square = GetPieceIndexFromBoardCoords(coords);
+	PieceType type = m_position.GetPieceTypeAt(square);
+	if (type == PieceType::UNKNOWN)
 	{
 		return '.';
 	}
-	return piece->m_definition->m_glyph[piece->m_playerSide];
+	return GetGlyphCharFromPieceTypeAndPlayerSide(type, m_position.GetPlayerSideAt(square));
 }
 
 PlayerSide ChessMatch::GetCurrentPlayerSide() const
@@ -405,78 +477,51 @@ void ChessMatch::PrintBoardState() const
 //	return "";
 //}
 
-ChessMoveResult ChessMatch::TryToMoveChessPiece(IntVec2 fromCoords, IntVec2 toCoords, bool isTeleporting, PieceType promotionType /*= PieceType::UNKNOWN*/)
+ChessMoveResult ChessMatch::TryToMoveChessPiece(ChessMove const& move, bool isTeleporting)
 {
 	PlayerSide currentSide = GetCurrentPlayerSide();
-	if (currentSide < 0)
+	if (currentSide < 0 || currentSide != m_position.m_sideToMove)
 	{
+		// also rejects a second move before the state machine has switched turns
 		return ChessMoveResult::INVALID_GAME_NOT_PLAYING;
 	}
 
-	ChessPiece* pieceAtFromCoords = m_piecesOnBoard[GetPieceIndexFromBoardCoords(fromCoords)];
-	ChessPiece* pieceAtToCoords = m_piecesOnBoard[GetPieceIndexFromBoardCoords(toCoords)];
-
-	if (pieceAtFromCoords == nullptr)
-	{
-		return ChessMoveResult::INVALID_MOVE_NO_PIECE;
-	}
-
-	if (currentSide != pieceAtFromCoords->m_playerSide)
-	{
-		return ChessMoveResult::INVALID_MOVE_NOT_YOUR_PIECE;
-	}
-
-	if (fromCoords == toCoords)
-	{
-		return ChessMoveResult::INVALID_MOVE_ZERO_DISTANCE;
-	}
-
-	if (pieceAtToCoords != nullptr && pieceAtToCoords->m_playerSide == pieceAtFromCoords->m_playerSide)
-	{
-		return ChessMoveResult::INVALID_MOVE_DESTINATION_BLOCKED;
-	}
-
-	// Rules above is the basic rule, then check isTeleporting
-	// which is captured, have a helper function to move piece capture piece, all logic happens in chess piece
-	// remember capture first then move(should move check the destination is occupied? for safe?)
-
-	// #ToDo check moving rule
-
-
+	int fromSquare = move.GetFromSquare();
+	int toSquare = move.GetToSquare();
 
 	ChessMoveResult moveResult = ChessMoveResult::UNKNOWN;
-
-
-
 	if (isTeleporting)
 	{
-		MovePiece(fromCoords, toCoords); // cheating, no promotion
-		moveResult = ChessMoveResult::VALID_MOVE_NORMAL;
+		// cheating, only the basic rules, no promotion
+		moveResult = ValidateChessTeleport(m_position, fromSquare, toSquare);
 	}
 	else
 	{
-		moveResult = pieceAtFromCoords->TryToMove(fromCoords, toCoords, promotionType);
-		if (!IsValid(moveResult))
+		moveResult = ValidateChessMove(m_position, fromSquare, toSquare, move.GetPromotionType());
+
+		// a move decoded off the wire must carry the flags this position gives it
+		if (IsValid(moveResult) && move != m_position.CreateMove(fromSquare, toSquare, move.GetPromotionType()))
 		{
-			return moveResult;
+			moveResult = ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
 		}
 	}
 
-	bool isKingCaptured = false;
-	if (pieceAtToCoords != nullptr && pieceAtToCoords->m_definition->m_type == PieceType::KING)
+	if (!IsValid(moveResult))
 	{
-		isKingCaptured = true;
+		return moveResult;
 	}
 
-	// Switch State
-	if (isKingCaptured)
+	if (isTeleporting)
 	{
-		SetNextState((m_currentState == MatchState::WHITE_MOVE) ? MatchState::WHITE_WIN : MatchState::BLACK_WIN);
+		CommitTeleport(GetBoardCoordsFromPieceIndex(fromSquare), GetBoardCoordsFromPieceIndex(toSquare));
 	}
 	else
 	{
-		SetNextState((m_currentState == MatchState::WHITE_MOVE) ? MatchState::BLACK_MOVE : MatchState::WHITE_MOVE); // Assume game is playing
+		CommitMove(move);
 	}
+
+	// Switch State
+	SetNextState(AdjudicateWithTablebases(GetStateAfterCommittedMove()));
 	m_turnNumber++; // Add Turn
 
 	return moveResult;
@@ -540,6 +585,52 @@ ChessMoveResult ChessMatch::TryToMoveChessPiece(IntVec2 fromCoords, IntVec2 toCo
 
 }
 
+void ChessMatch::CommitMove(ChessMove const& move)
+{
+	// Rules state first, the visuals are synced from the committed move afterwards
+	ChessMoveRecord record;
+	record.m_move = move;
+	m_position.MakeMove(move, record.m_undo);
+	m_moveHistory.push_back(record);
+
+	SyncPiecesToCommittedMove(move);
+}
+
+void ChessMatch::CommitTeleport(IntVec2 fromCoords, IntVec2 toCoords)
+{
+	// not a chess move, so it can't be unmade and breaks the undo history
+	m_position.ApplyTeleport(GetPieceIndexFromBoardCoords(fromCoords), GetPieceIndexFromBoardCoords(toCoords));
+	m_moveHistory.clear();
+
+	MovePiece(fromCoords, toCoords);
+}
+
+void ChessMatch::SyncPiecesToCommittedMove(ChessMove const& move)
+{
+	IntVec2 fromCoords = IntVec2(GetFileOfSquare(move.GetFromSquare()), GetRankOfSquare(move.GetFromSquare()));
+	IntVec2 toCoords = IntVec2(GetFileOfSquare(move.GetToSquare()), GetRankOfSquare(move.GetToSquare()));
+
+	if (move.IsEnPassant())
+	{
+		CapturePiece(IntVec2(toCoords.x, fromCoords.y));
+	}
+
+	MovePiece(fromCoords, toCoords);
+
+	if (move.GetFlag() == MOVE_FLAG_CASTLE_KINGSIDE)
+	{
+		MovePiece(IntVec2(7, fromCoords.y), IntVec2(5, fromCoords.y));
+	}
+	else if (move.GetFlag() == MOVE_FLAG_CASTLE_QUEENSIDE)
+	{
+		MovePiece(IntVec2(0, fromCoords.y), IntVec2(3, fromCoords.y));
+	}
+	else if (move.IsPromotion())
+	{
+		m_piecesOnBoard[move.GetToSquare()]->LoadByType(move.GetPromotionType());
+	}
+}
+
 void ChessMatch::MovePiece(IntVec2 fromCoords, IntVec2 toCoords)
 {
 	std::string fromNotation = GetNotationFromBoardCoords(fromCoords);
@@ -593,6 +684,96 @@ void ChessMatch::CapturePiece(IntVec2 coords)
 		notation.c_str()));
 }
 
+MatchState ChessMatch::GetStateAfterCommittedMove() const
+{
+	PlayerSide sideToMove = m_position.m_sideToMove;
+	MatchState opponentWins = (sideToMove == PLAYER_WHITE) ? MatchState::BLACK_WIN : MatchState::WHITE_WIN;
+
+	// a teleport can still take a king
+	if (m_position.GetKingSquare(sideToMove) == SQUARE_NONE)
+	{
+		return opponentWins;
+	}
+
+	if (!HasAnyLegalMove(m_position))
+	{
+		return m_position.IsInCheck(sideToMove) ? opponentWins : MatchState::DRAW_STALEMATE;
+	}
+	if (m_position.IsInsufficientMaterial())
+	{
+		return MatchState::DRAW_INSUFFICIENT_MATERIAL;
+	}
+	if (m_position.m_halfmoveClock >= 100)
+	{
+		return MatchState::DRAW_FIFTY_MOVE_RULE;
+	}
+	if (GetRepetitionCount() >= 3)
+	{
+		return MatchState::DRAW_THREEFOLD_REPETITION;
+	}
+
+	return (sideToMove == PLAYER_WHITE) ? MatchState::WHITE_MOVE : MatchState::BLACK_MOVE;
+}
+
+MatchState ChessMatch::AdjudicateWithTablebases(MatchState state)
+{
+	// a networked game can't be ended by tables only one side may have
+	if ((state != MatchState::WHITE_MOVE && state != MatchState::BLACK_MOVE) || !IsPlayingLocally() || !g_gameConfigBlackboard.GetValue("syzygyAdjudication", false))
+	{
+		return state;
+	}
+	ChessSyzygyTablebases const* tablebases = GetTablebases();
+	if (tablebases == nullptr || !tablebases->CanProbe(m_position))
+	{
+		return state;
+	}
+
+	// The root probe counts the moves already played towards the fifty-move rule. Without DTZ tables only
+	// draws, and wins or losses right after a capture or pawn move, are certain.
+	ChessMove move = ChessMove::None();
+	ChessWdl wdl = WDL_DRAW;
+	int dtz = 0;
+	bool isKnown = tablebases->ProbeRoot(m_position, move, wdl, dtz);
+	if (!isKnown && tablebases->ProbeWdl(m_position, wdl))
+	{
+		isKnown = (wdl != WDL_WIN && wdl != WDL_LOSS) || m_position.m_halfmoveClock == 0;
+	}
+	if (!isKnown)
+	{
+		return state;
+	}
+
+	PlayerSide sideToMove = m_position.m_sideToMove;
+	if (wdl == WDL_WIN || wdl == WDL_LOSS)
+	{
+		PlayerSide winner = (wdl == WDL_WIN) ? sideToMove : ((sideToMove == PLAYER_WHITE) ? PLAYER_BLACK : PLAYER_WHITE);
+		g_theDevConsole->AddText(DevConsole::INFO_MINOR, Stringf("The tablebases adjudicate a win for %s", (winner == PLAYER_WHITE) ? "White" : "Black"));
+		return (winner == PLAYER_WHITE) ? MatchState::WHITE_WIN : MatchState::BLACK_WIN;
+	}
+	return MatchState::DRAW_TABLEBASE;
+}
+
+int ChessMatch::GetRepetitionCount() const
+{
+	// Only positions with the same side to move since the last capture or pawn move can repeat,
+	// each undo record holds the key of the position before its move
+	int count = 1;
+	int numRecords = static_cast<int>(m_moveHistory.size());
+	int oldestIndex = numRecords - static_cast<int>(m_position.m_halfmoveClock);
+	if (oldestIndex < 0)
+	{
+		oldestIndex = 0;
+	}
+	for (int recordIndex = numRecords - 2; recordIndex >= oldestIndex; recordIndex -= 2)
+	{
+		if (m_moveHistory[recordIndex].m_undo.m_key == m_position.m_key)
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
 int ChessMatch::GetTurnNumber() const
 {
 	return m_turnNumber;
@@ -600,16 +781,35 @@ int ChessMatch::GetTurnNumber() const
 
 bool ChessMatch::IsSquareOccupied(IntVec2 coords) const
 {
-	ChessPiece* pieceAtCoords = m_piecesOnBoard[GetPieceIndexFromBoardCoords(coords)];
-	return pieceAtCoords != nullptr;
+	return m_position.IsOccupied(GetPieceIndexFromBoardCoords(coords));
 }
 
 bool ChessMatch::IsSquareUnderAttack(IntVec2 coords, PlayerSide side) const
 {
-	// #ToDo 
-	UNUSED(coords);
-	UNUSED(side);
-	return false;
+	return m_position.IsSquareAttacked(GetPieceIndexFromBoardCoords(coords), side);
+}
+
+void ChessMatch::GenerateLegalMoves(ChessMoveList& moves) const
+{
+	::GenerateLegalMoves(m_position, moves);
+}
+
+void ChessMatch::CacheLegalMoves()
+{
+	GenerateLegalMoves(m_legalMoves);
+	for (Bitboard& targets : m_legalTargetsFromSquare)
+	{
+		targets = BITBOARD_EMPTY;
+	}
+	for (ChessMove const& move : m_legalMoves)
+	{
+		m_legalTargetsFromSquare[move.GetFromSquare()] |= GetSquareMask(move.GetToSquare());
+	}
+}
+
+Bitboard ChessMatch::GetLegalTargets(int fromSquare) const
+{
+	return m_legalTargetsFromSquare[fromSquare];
 }
 
 void ChessMatch::PrintMatchState() const
@@ -635,6 +835,31 @@ void ChessMatch::PrintMatchState() const
 		g_theDevConsole->AddText(color, "Black has won the match!");
 		g_theDevConsole->AddText(color, "#################################################");
 		break;
+	case MatchState::DRAW_STALEMATE:
+		g_theDevConsole->AddText(color, "#################################################");
+		g_theDevConsole->AddText(color, "The match is drawn by stalemate!");
+		g_theDevConsole->AddText(color, "#################################################");
+		break;
+	case MatchState::DRAW_THREEFOLD_REPETITION:
+		g_theDevConsole->AddText(color, "#################################################");
+		g_theDevConsole->AddText(color, "The match is drawn by threefold repetition!");
+		g_theDevConsole->AddText(color, "#################################################");
+		break;
+	case MatchState::DRAW_FIFTY_MOVE_RULE:
+		g_theDevConsole->AddText(color, "#################################################");
+		g_theDevConsole->AddText(color, "The match is drawn by the fifty-move rule!");
+		g_theDevConsole->AddText(color, "#################################################");
+		break;
+	case MatchState::DRAW_INSUFFICIENT_MATERIAL:
+		g_theDevConsole->AddText(color, "#################################################");
+		g_theDevConsole->AddText(color, "The match is drawn by insufficient material!");
+		g_theDevConsole->AddText(color, "#################################################");
+		break;
+	case MatchState::DRAW_TABLEBASE:
+		g_theDevConsole->AddText(color, "#################################################");
+		g_theDevConsole->AddText(color, "The match is drawn by tablebase adjudication!");
+		g_theDevConsole->AddText(color, "#################################################");
+		break;
 	}
 }
 
@@ -666,12 +891,22 @@ void ChessMatch::EnterState(MatchState state)
 		//StartNewMatch();
 		break;
 	case MatchState::WHITE_MOVE:
+		CacheLegalMoves();
 		PrintMatchState();
 		PrintBoardState();
+		if (IsAITurn())
+		{
+			StartAIThinking();
+		}
 		break;
 	case MatchState::BLACK_MOVE:
+		CacheLegalMoves();
 		PrintMatchState();
 		PrintBoardState();
+		if (IsAITurn())
+		{
+			StartAIThinking();
+		}
 		break;
 	case MatchState::WHITE_WIN:
 		PrintMatchState();
@@ -680,7 +915,13 @@ void ChessMatch::EnterState(MatchState state)
 		PrintMatchState();
 
 		break;
-
+	case MatchState::DRAW_STALEMATE:
+	case MatchState::DRAW_THREEFOLD_REPETITION:
+	case MatchState::DRAW_FIFTY_MOVE_RULE:
+	case MatchState::DRAW_INSUFFICIENT_MATERIAL:
+	case MatchState::DRAW_TABLEBASE:
+		PrintMatchState();
+		break;
 	}
 }
 
@@ -703,7 +944,13 @@ void ChessMatch::ExitState(MatchState state)
 	case MatchState::BLACK_WIN:
 
 		break;
+	case MatchState::DRAW_STALEMATE:
+	case MatchState::DRAW_THREEFOLD_REPETITION:
+	case MatchState::DRAW_FIFTY_MOVE_RULE:
+	case MatchState::DRAW_INSUFFICIENT_MATERIAL:
+	case MatchState::DRAW_TABLEBASE:
 
+		break;
 	}
 }
 
@@ -728,7 +975,13 @@ void ChessMatch::UpdateCurrentState()
 	case MatchState::BLACK_WIN:
 
 		break;
+	case MatchState::DRAW_STALEMATE:
+	case MatchState::DRAW_THREEFOLD_REPETITION:
+	case MatchState::DRAW_FIFTY_MOVE_RULE:
+	case MatchState::DRAW_INSUFFICIENT_MATERIAL:
+	case MatchState::DRAW_TABLEBASE:
 
+		break;
 	}
 }
 
@@ -833,14 +1086,14 @@ void ChessMatch::UpdateMouseInputForPieceMovement()
 					return;
 				}
 
-				ChessPiece* pieceAtFromCoords = m_piecesOnBoard[GetPieceIndexFromBoardCoords(m_currentImpactCoords)];
-
-				if (pieceAtFromCoords == nullptr)
+				int square = GetPieceIndexFromBoardCoords(m_currentImpactCoords);
+				if (m_position.GetPlayerSideAt(square) != currentSide || currentSide == m_aiSide)
 				{
 					return;
 				}
 
-				if (currentSide != pieceAtFromCoords->m_playerSide)
+				// a piece with nowhere to go can still be picked up to teleport
+				if (GetLegalTargets(square) == BITBOARD_EMPTY && !g_theInput->IsKeyDown(KEYCODE_CONTROL))
 				{
 					return;
 				}
@@ -864,13 +1117,44 @@ void ChessMatch::UpdateMouseInputForPieceMovement()
 		}
 		if (g_theInput->WasKeyJustPressed(KEYCODE_LEFT_MOUSE) && IsCoordsValid(m_currentImpactCoords))
 		{
-			// Move
-			char const* command = "ChessMove from=%s to=%s teleport=%s";
+			int fromSquare = GetPieceIndexFromBoardCoords(m_selectedCoords);
+			int toSquare = GetPieceIndexFromBoardCoords(m_currentImpactCoords);
 			bool isTeleporting = g_theInput->IsKeyDown(KEYCODE_CONTROL);
-			std::string fromNotation = GetNotationFromBoardCoords(m_selectedCoords);
-			std::string toNotation = GetNotationFromBoardCoords(m_currentImpactCoords);
+			if (isTeleporting)
+			{
+				char fromNotation[MAX_SQUARE_NAME_LENGTH];
+				char toNotation[MAX_SQUARE_NAME_LENGTH];
+				WriteSquareName(fromSquare, fromNotation, MAX_SQUARE_NAME_LENGTH);
+				WriteSquareName(toSquare, toNotation, MAX_SQUARE_NAME_LENGTH);
+				g_theDevConsole->Execute(Stringf("ChessMove from=%s to=%s teleport=true", fromNotation, toNotation));
+				m_selectedCoords = IntVec2(-1, -1);
+				return;
+			}
+
+			if (!IsSquareInMask(GetLegalTargets(fromSquare), toSquare))
+			{
+				// Clicking another movable piece of ours switches the selection, anything else is refused here
+				if (m_position.GetPlayerSideAt(toSquare) == GetCurrentPlayerSide() && GetLegalTargets(toSquare) != BITBOARD_EMPTY)
+				{
+					m_selectedCoords = m_currentImpactCoords;
+					return;
+				}
+				DebugAddMessage("Illegal move!", 3.f, Rgba8::RED);
+				m_selectedCoords = IntVec2(-1, -1);
+				return;
+			}
 
-			g_theDevConsole->Execute(Stringf(command, fromNotation.c_str(), toNotation.c_str(), isTeleporting ? "true" : "false"));
+			// Move, the first match is the queen for a promotion since generation adds it first
+			for (ChessMove const& move : m_legalMoves)
+			{
+				if (move.GetFromSquare() == fromSquare && move.GetToSquare() == toSquare)
+				{
+					char moveText[MAX_UCI_MOVE_LENGTH];
+					WriteUciMove(move, moveText, MAX_UCI_MOVE_LENGTH);
+					g_theDevConsole->Execute(Stringf("ChessMove uci=%s", moveText));
+					break;
+				}
+			}
 			// Deselect
 			m_selectedCoords = IntVec2(-1, -1);
 			return;
@@ -982,6 +1266,27 @@ void ChessMatch::ShowImGuiPanel()
 
 	}
 	ImGui::End();
+
+	if (ImGui::Begin("Evaluation"))
+	{
+		ChessEvalBreakdown breakdown;
+		ComputeEvalBreakdown(m_position, breakdown);
+		ImGui::Text("Game phase: %d / %d", breakdown.m_gamePhase, MAX_GAME_PHASE);
+		ImGui::SeparatorText("Midgame / Endgame");
+		ImGui::Text("%-14s %6s %6s   %6s %6s", "", "White", "", "Black", "");
+		ImGui::Text("%-14s %6d %6d   %6d %6d", "Material", breakdown.m_material[PLAYER_WHITE].m_midgame, breakdown.m_material[PLAYER_WHITE].m_endgame,
+			breakdown.m_material[PLAYER_BLACK].m_midgame, breakdown.m_material[PLAYER_BLACK].m_endgame);
+		ImGui::Text("%-14s %6d %6d   %6d %6d", "Piece-square", breakdown.m_pieceSquare[PLAYER_WHITE].m_midgame, breakdown.m_pieceSquare[PLAYER_WHITE].m_endgame,
+			breakdown.m_pieceSquare[PLAYER_BLACK].m_midgame, breakdown.m_pieceSquare[PLAYER_BLACK].m_endgame);
+		ImGui::Separator();
+		ImGui::Text("Score (white): %+d", breakdown.m_whiteScore);
+		ImGui::Text("Score (to move): %+d", EvaluatePosition(m_position));
+		if (!breakdown.m_isIncrementalInSync)
+		{
+			ImGui::TextColored(ImVec4(1.f, 0.f, 0.f, 1.f), "Incremental sums out of sync!");
+		}
+	}
+	ImGui::End();
 }
 
 bool ChessMatch::Command_Echo(EventArgs& args)
@@ -1087,6 +1392,8 @@ bool ChessMatch::Command_ChessDisconnect(EventArgs& args)
 		return true;
 	}
 
+	g_theGame->GetMatch()->StopAIThinking();
+
 	if (!args.GetValue("remote", false))
 	{
 		std::string reason = args.GetValue("reason", "");
@@ -1121,55 +1428,69 @@ bool ChessMatch::Command_ChessPlayerInfo(EventArgs& args)
 
 bool ChessMatch::Command_ChessMove(EventArgs& args)
 {
-	std::string fromNotation = args.GetValue("from", "??");
-	std::string toNotation = args.GetValue("to", "??");
+	ChessMatch* match = g_theGame->GetMatch();
+	bool isTeleporting = args.GetValue("teleport", false);
 
-	if (fromNotation == "??" || toNotation == "??")
+	// move= is the packed 16 bit move the remote side sends, uci= san= or from= to= is what players type
+	ChessMove move;
+	std::string moveData = args.GetValue("move", "");
+	std::string uciText = args.GetValue("uci", "");
+	std::string sanText = args.GetValue("san", "");
+	if (moveData != "")
 	{
-		g_theDevConsole->AddText(DevConsole::ERROR, "Illegal chess move! Must have from= and to= arguments.");
-		g_theDevConsole->AddText(DevConsole::WARNING, "	Example: ChessMove from=e2 to=e4");
-		return true;
+		move = ChessMove::FromRawData(static_cast<uint16_t>(strtoul(moveData.c_str(), nullptr, 16)));
 	}
-
-	if (fromNotation.length() != 2)
+	else if (uciText != "" || sanText != "")
 	{
-		g_theDevConsole->AddText(DevConsole::ERROR, Stringf("Illegal \"from\" square \"%s\"! Must be a two-letter [Column][Rank] ", fromNotation.c_str()));
-		g_theDevConsole->AddText(DevConsole::WARNING, "	Example: E2, E4; A1 is bottom left and H8 is top-right");
-		return true;
+		ChessMoveList legalMoves;
+		match->GenerateLegalMoves(legalMoves);
+		bool isParsed = (uciText != "") ? ParseUciMove(uciText, legalMoves, move) : ParseSanMove(match->m_position, sanText, legalMoves, move);
+		if (!isParsed)
+		{
+			g_theDevConsole->AddText(DevConsole::ERROR, Stringf("Illegal or ambiguous move \"%s\"!", (uciText != "") ? uciText.c_str() : sanText.c_str()));
+			g_theDevConsole->AddText(DevConsole::WARNING, "	Example: ChessMove uci=e7e8q, ChessMove san=Nxf3");
+			return true;
+		}
 	}
-
-	if (toNotation.length() != 2)
+	else
 	{
-		g_theDevConsole->AddText(DevConsole::ERROR, Stringf("Illegal \"to\" square \"%s\"! Must be a two-letter [Column][Rank] ", toNotation.c_str()));
-		g_theDevConsole->AddText(DevConsole::WARNING, "	Example: E2, E4; A1 is bottom left and H8 is top-right");
-		return true;
-	}
+		std::string fromNotation = args.GetValue("from", "??");
+		std::string toNotation = args.GetValue("to", "??");
 
-	IntVec2 fromCoords;
-	IntVec2 toCoords;
+		if (fromNotation == "??" || toNotation == "??")
+		{
+			g_theDevConsole->AddText(DevConsole::ERROR, "Illegal chess move! Must have from= and to=, uci= or san= arguments.");
+			g_theDevConsole->AddText(DevConsole::WARNING, "	Example: ChessMove from=e2 to=e4");
+			return true;
+		}
 
-	fromCoords.x = std::toupper(fromNotation[0]) - 'A';
-	fromCoords.y = fromNotation[1] - '1';
-	toCoords.x = std::toupper(toNotation[0]) - 'A';
-	toCoords.y = toNotation[1] - '1';
+		int fromSquare = ParseSquareName(fromNotation);
+		if (fromSquare == SQUARE_NONE)
+		{
+			g_theDevConsole->AddText(DevConsole::ERROR, Stringf("Illegal \"from\" square \"%s\"! Must be a two-letter [Column][Rank] ", fromNotation.c_str()));
+			g_theDevConsole->AddText(DevConsole::WARNING, "	Example: E2, E4; A1 is bottom left and H8 is top-right");
+			return true;
+		}
 
-	if (fromCoords.x < 0 || fromCoords.x >= 8 || fromCoords.y < 0 || fromCoords.y >=8)
-	{
-		g_theDevConsole->AddText(DevConsole::ERROR, Stringf("Illegal \"from\" square \"%s\"! Must be a two-letter [Column][Rank] ", fromNotation.c_str()));
-		g_theDevConsole->AddText(DevConsole::WARNING, "	Example: E2, E4; A1 is bottom left and H8 is top-right");
-		return true;
-	}
+		int toSquare = ParseSquareName(toNotation);
+		if (toSquare == SQUARE_NONE)
+		{
+			g_theDevConsole->AddText(DevConsole::ERROR, Stringf("Illegal \"to\" square \"%s\"! Must be a two-letter [Column][Rank] ", toNotation.c_str()));
+			g_theDevConsole->AddText(DevConsole::WARNING, "	Example: E2, E4; A1 is bottom left and H8 is top-right");
+			return true;
+		}
 
-	if (toCoords.x < 0 || toCoords.x >= 8 || toCoords.y < 0 || toCoords.y >= 8)
-	{
-		g_theDevConsole->AddText(DevConsole::ERROR, Stringf("Illegal \"to\" square \"%s\"! Must be a two-letter [Column][Rank] ", toNotation.c_str()));
-		g_theDevConsole->AddText(DevConsole::WARNING, "	Example: E2, E4; A1 is bottom left and H8 is top-right");
-		return true;
+		if (isTeleporting)
+		{
+			move = ChessMove(fromSquare, toSquare, MOVE_FLAG_QUIET);
+		}
+		else
+		{
+			PieceType promotionType = GetPieceTypeFromString(args.GetValue("promoteTo", ""));
+			move = match->m_position.CreateMove(fromSquare, toSquare, promotionType);
+		}
 	}
 
-	bool isTeleporting = args.GetValue("teleport", false);
-	PieceType promotionType = GetPieceTypeFromString(args.GetValue("promoteTo", ""));
-
 
 	// Check if valid for local player to move
 	// first check if it is network mode
@@ -1200,7 +1521,7 @@ bool ChessMatch::Command_ChessMove(EventArgs& args)
 	}
 
 
-	ChessMoveResult result = g_theGame->GetMatch()->TryToMoveChessPiece(fromCoords, toCoords, isTeleporting, promotionType);
+	ChessMoveResult result = match->TryToMoveChessPiece(move, isTeleporting);
 	if (!IsValid(result))
 	{
 		//	give arguments? namedstrings
@@ -1215,16 +1536,28 @@ bool ChessMatch::Command_ChessMove(EventArgs& args)
 	}
 
 	//-----------------------------------------------------------------------------------------------
+	// key= carries the sender's position hash after the move, both sides must agree on it
+	uint64_t positionKey = g_theGame->GetMatch()->m_position.m_key;
 	if (!args.GetValue("remote", false))
 	{
-		std::string remoteCmd = "Remotecmd cmd=ChessMove";
-
-		for (const auto& kv : args.m_keyValuePairs)
+		std::string remoteCmd = Stringf("Remotecmd cmd=ChessMove move=%04x", move.GetRawData());
+		if (isTeleporting)
 		{
-			remoteCmd += " " + kv.first + "=" + kv.second;
+			remoteCmd += " teleport=true";
 		}
+		remoteCmd += Stringf(" key=%016llx", positionKey);
 		g_theDevConsole->Execute(remoteCmd);
 	}
+	else
+	{
+		std::string remoteKey = args.GetValue("key", "");
+		if (remoteKey != "" && strtoull(remoteKey.c_str(), nullptr, 16) != positionKey)
+		{
+			g_theDevConsole->AddText(DevConsole::ERROR, Stringf("Board desync! Opponent's position key %s, ours %016llx", remoteKey.c_str(), positionKey));
+			DebugAddMessage("Board desync with opponent!", 3.f, Rgba8::RED);
+		}
+		g_theGame->GetMatch()->ResolveAIPonder();
+	}
 
 	return true;
 }
@@ -1238,6 +1571,8 @@ bool ChessMatch::Command_ChessResign(EventArgs& args)
 			return true;
 		}
 
+		g_theGame->GetMatch()->StopAIThinking();
+
 		if (!args.GetValue("remote", false))
 		{
 
@@ -1276,6 +1611,105 @@ bool ChessMatch::Command_RemoteCmd(EventArgs& args)
 	return true;
 }
 
+bool ChessMatch::Command_ChessLoadFen(EventArgs& args)
+{
+	std::string fen = args.GetValue("fen", "");
+	ChessPosition position;
+	if (!position.SetFromFen(fen))
+	{
+		g_theDevConsole->AddText(DevConsole::ERROR, Stringf("Illegal fen \"%s\"!", fen.c_str()));
+		g_theDevConsole->AddText(DevConsole::WARNING, "	Example: ChessLoadFen fen=\"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1\"");
+		return true;
+	}
+
+	ChessMatch* match = g_theGame->GetMatch();
+	match->SetPosition(position);
+	match->SetNextState(match->AdjudicateWithTablebases(match->GetStateAfterCommittedMove()));
+	match->PrintBoardState();
+
+	if (IsPlayingLocally())
+	{
+		return true;
+	}
+
+	// same key= check as ChessMove, the fen goes with underscores so it stays one argument
+	if (!args.GetValue("remote", false))
+	{
+		char fenText[MAX_FEN_LENGTH];
+		position.WriteFen(fenText, MAX_FEN_LENGTH);
+		for (char* glyph = fenText; *glyph != '\0'; ++glyph)
+		{
+			if (*glyph == ' ')
+			{
+				*glyph = '_';
+			}
+		}
+		g_theDevConsole->Execute(Stringf("Remotecmd cmd=ChessLoadFen fen=%s key=%016llx", fenText, position.m_key));
+	}
+	else
+	{
+		std::string remoteKey = args.GetValue("key", "");
+		if (remoteKey != "" && strtoull(remoteKey.c_str(), nullptr, 16) != position.m_key)
+		{
+			g_theDevConsole->AddText(DevConsole::ERROR, Stringf("Board desync! Opponent's position key %s, ours %016llx", remoteKey.c_str(), position.m_key));
+			DebugAddMessage("Board desync with opponent!", 3.f, Rgba8::RED);
+		}
+	}
+	return true;
+}
+
+bool ChessMatch::Command_ChessFen(EventArgs& args)
+{
+	UNUSED(args);
+
+	char fenText[MAX_FEN_LENGTH];
+	g_theGame->GetMatch()->m_position.WriteFen(fenText, MAX_FEN_LENGTH);
+	g_theDevConsole->AddText(DevConsole::INFO_MAJOR, fenText);
+	return true;
+}
+
+bool ChessMatch::Command_ChessPerft(EventArgs& args)
+{
+	int depth = args.GetValue("depth", 4);
+	std::string fen = args.GetValue("fen", "");
+	bool isDivide = args.GetValue("divide", false);
+
+	if (depth < 1 || depth > 8)
+	{
+		g_theDevConsole->AddText(DevConsole::ERROR, Stringf("Illegal perft depth %d! Must be between 1 and 8.", depth));
+		g_theDevConsole->AddText(DevConsole::WARNING, "	Example: ChessPerft depth=5 fen=\"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1\" divide=true");
+		return true;
+	}
+
+	// Without fen= the current match position is used
+	ChessPosition position = g_theGame->GetMatch()->m_position;
+	if (fen != "" && !position.SetFromFen(fen))
+	{
+		g_theDevConsole->AddText(DevConsole::ERROR, Stringf("Illegal fen \"%s\"!", fen.c_str()));
+		return true;
+	}
+
+	ChessMoveList rootMoves;
+	uint64_t nodesPerMove[MAX_CHESS_MOVES];
+	double startTime = GetCurrentTimeSeconds();
+	uint64_t nodes = RunPerftDivide(position, depth, rootMoves, nodesPerMove);
+	double elapsedSeconds = GetCurrentTimeSeconds() - startTime;
+
+	if (isDivide)
+	{
+		char moveText[MAX_UCI_MOVE_LENGTH];
+		for (int moveIndex = 0; moveIndex < rootMoves.GetCount(); ++moveIndex)
+		{
+			WriteUciMove(rootMoves[moveIndex], moveText, MAX_UCI_MOVE_LENGTH);
+			g_theDevConsole->AddText(DevConsole::INFO_MINOR, Stringf("%s: %llu", moveText, nodesPerMove[moveIndex]));
+		}
+	}
+
+	double nodesPerSecond = (elapsedSeconds > 0.0) ? static_cast<double>(nodes) / elapsedSeconds : 0.0;
+	g_theDevConsole->AddText(DevConsole::INFO_MAJOR, Stringf("Perft depth %d: %llu nodes in %.3fs (%.0f nps)", depth, nodes, elapsedSeconds, nodesPerSecond));
+	return true;
+}
+
 void ChessMatch::ButtonChessConnect()
 {
 	g_theDevConsole->Execute("ChessConnect");
@@ -1307,6 +1741,8 @@ bool ChessMatch::Command_ChessBegin(EventArgs& args)
 {
 	UNUSED(args);
 
+	g_theGame->GetMatch()->StopAIThinking();
+
 	if (IsPlayingLocally())
 	{
 		g_theGame->GetMatch()->SetNextState(MatchState::DEFAULT);
@@ -1329,3 +1765,337 @@ bool ChessMatch::Command_ChessBegin(EventArgs& args)
 
 	return true;
 }
+
+//-----------------------------------------------------------------------------------------------
+bool ChessMatch::Command_ChessAI(EventArgs& args)
+{
+	ChessMatch* match = g_theGame->GetMatch();
+	std::string sideName = args.GetValue("side", "");
+	int depth = args.GetValue("depth", MAX_SEARCH_DEPTH);
+	int moveTimeMs = args.GetValue("movetime", 0);
+	int clockMs = args.GetValue("time", 0);
+	int incrementMs = args.GetValue("inc", 0);
+	int maxNodes = args.GetValue("nodes", 0);
+
+	PlayerSide side = PLAYER_UNKNOWN;
+	if (sideName == "white" || sideName == "White")
+	{
+		side = PLAYER_WHITE;
+	}
+	else if (sideName == "black" || sideName == "Black")
+	{
+		side = PLAYER_BLACK;
+	}
+	else if (sideName != "none" && sideName != "None")
+	{
+		g_theDevConsole->AddText(DevConsole::ERROR, "Illegal ChessAI command! Must have side=white, side=black or side=none.");
+		g_theDevConsole->AddText(DevConsole::WARNING, "	Example: ChessAI side=black depth=6 movetime=2000, ChessAI side=white time=300000 inc=2000");
+		return true;
+	}
+
+	if (depth < 1 || depth > MAX_SEARCH_DEPTH || moveTimeMs < 0 || clockMs < 0 || incrementMs < 0 || maxNodes < 0)
+	{
+		g_theDevConsole->AddText(DevConsole::ERROR, Stringf("Illegal search limits! depth must be between 1 and %d, movetime, time, inc and nodes must not be negative.", MAX_SEARCH_DEPTH));
+		return true;
+	}
+
+	// the remote player would reject every move made for a side we don't own
+	if (side != PLAYER_UNKNOWN && !IsPlayingLocally() && side != match->m_localPlayerSide)
+	{
+		g_theDevConsole->AddText(DevConsole::ERROR, "The AI can only play the local player's side in a network match!");
+		return true;
+	}
+
+	match->StopAIThinking();
+	match->m_aiSide = side;
+	if (side == PLAYER_UNKNOWN)
+	{
+		g_theDevConsole->AddText(DevConsole::INFO_MAJOR, "ChessAI is off");
+		return true;
+	}
+
+	// with no limit given the search would never end on its own
+	bool hasLimit = depth != MAX_SEARCH_DEPTH || moveTimeMs != 0 || clockMs != 0 || maxNodes != 0;
+	match->m_aiLimits = ChessSearchLimits();
+	match->m_aiLimits.m_maxDepth = depth;
+	match->m_aiLimits.m_moveTimeMs = hasLimit ? moveTimeMs : 1000;
+	match->m_aiLimits.m_maxNodes = static_cast<uint64_t>(maxNodes);
+	match->m_isAIOnClock = clockMs > 0;
+	match->m_aiClockSeconds = 0.001 * clockMs;
+	match->m_aiIncrementSeconds = 0.001 * incrementMs;
+
+	if (match->m_ai == nullptr)
+	{
+		match->m_ai = new ChessAI(g_gameConfigBlackboard.GetValue("transpositionTableMB", 64), g_gameConfigBlackboard.GetValue("searchThreads", 0),
+			g_gameConfigBlackboard.GetValue("evalNetwork", ""));
+		if (match->m_ai->IsUsingEvalNetwork())
+		{
+			g_theDevConsole->AddText(DevConsole::INFO_MINOR, "ChessAI evaluates with the network");
+		}
+		else if (!match->m_ai->GetEvalNetworkError().empty())
+		{
+			g_theDevConsole->AddText(DevConsole::WARNING, Stringf("ChessAI network not loaded (%s), using the handcrafted evaluation", match->m_ai->GetEvalNetworkError().c_str()));
+		}
+		match->m_ai->SetOpeningBook(match->GetOpeningBook());
+		match->m_ai->SetTablebases(match->GetTablebases());
+	}
+	g_theDevConsole->AddText(DevConsole::INFO_MAJOR, Stringf("ChessAI plays %s, depth %d, movetime %dms, nodes %d, clock %dms + %dms", (side == PLAYER_WHITE) ? "White" : "Black",
+		match->m_aiLimits.m_maxDepth, match->m_aiLimits.m_moveTimeMs, maxNodes, clockMs, (clockMs > 0) ? incrementMs : 0));
+
+	if (match->IsAITurn())
+	{
+		match->StartAIThinking();
+	}
+	return true;
+}
+
+bool ChessMatch::IsAITurn() const
+{
+	return m_ai != nullptr && m_aiSide != PLAYER_UNKNOWN && GetCurrentPlayerSide() == m_aiSide && m_position.m_sideToMove == m_aiSide;
+}
+
+void ChessMatch::StartAIThinking()
+{
+	// a ponder hit is already searching this position, and its time runs from the start of the ponder
+	bool isPonderHit = m_aiPonderHitKey == m_position.m_key;
+	m_aiPonderHitKey = 0;
+	if (isPonderHit)
+	{
+		return;
+	}
+
+	std::vector<uint64_t> gameKeys;
+	GetGameKeys(gameKeys);
+	m_ai->StartThinking(m_position, gameKeys, GetAILimits());
+}
+
+void ChessMatch::StopAIThinking()
+{
+	m_isAIPondering = false;
+	m_aiPonderHitKey = 0;
+	if (m_ai != nullptr)
+	{
+		m_ai->StopThinking();
+	}
+}
+
+void ChessMatch::StartAIPondering(ChessMove const& expectedReply)
+{
+	// nothing to ponder once the AI's move ended the match
+	if (m_nextState != MatchState::WHITE_MOVE && m_nextState != MatchState::BLACK_MOVE)
+	{
+		return;
+	}
+	ChessMoveList legalMoves;
+	GenerateLegalMoves(legalMoves);
+	bool isLegal = false;
+	for (ChessMove const& move : legalMoves)
+	{
+		isLegal = isLegal || move == expectedReply;
+	}
+	if (!isLegal)
+	{
+		return;
+	}
+
+	std::vector<uint64_t> gameKeys;
+	GetGameKeys(gameKeys);
+	gameKeys.push_back(m_position.m_key);
+	ChessPosition ponderPosition = m_position;
+	ChessUndoInfo undo;
+	ponderPosition.MakeMove(expectedReply, undo);
+	m_ai->StartPondering(ponderPosition, gameKeys, GetAILimits());
+	m_isAIPondering = true;
+	m_aiPonderMove = expectedReply;
+}
+
+void ChessMatch::ResolveAIPonder()
+{
+	if (!m_isAIPondering)
+	{
+		return;
+	}
+	m_isAIPondering = false;
+
+	char moveText[MAX_UCI_MOVE_LENGTH];
+	WriteUciMove(m_aiPonderMove, moveText, MAX_UCI_MOVE_LENGTH);
+	bool isAIToMove = m_nextState == MatchState::WHITE_MOVE || m_nextState == MatchState::BLACK_MOVE;
+	if (isAIToMove && m_ai->PonderHit(m_position.m_key))
+	{
+		m_aiPonderHitKey = m_position.m_key;
+		g_theDevConsole->AddText(DevConsole::INFO_MINOR, Stringf("ChessAI: ponder hit on %s", moveText));
+		return;
+	}
+	if (!isAIToMove)
+	{
+		m_ai->StopThinking();
+	}
+	g_theDevConsole->AddText(DevConsole::INFO_MINOR, Stringf("ChessAI: ponder miss, expected %s", moveText));
+}
+
+ChessSearchLimits ChessMatch::GetAILimits() const
+{
+	ChessSearchLimits limits = m_aiLimits;
+	if (m_isAIOnClock)
+	{
+		// a flag that has fallen still gets a move out of it, as fast as the search can give one
+		int clockMs = static_cast<int>(m_aiClockSeconds * 1000.0);
+		limits.m_timeLeftMs[m_aiSide] = (clockMs > 1) ? clockMs : 1;
+		limits.m_incrementMs[m_aiSide] = static_cast<int>(m_aiIncrementSeconds * 1000.0);
+	}
+	return limits;
+}
+
+void ChessMatch::UpdateAI()
+{
+	if (m_ai == nullptr)
+	{
+		return;
+	}
+
+	// the AI's clock runs on game time, it stops with the game clock when the game is paused
+	if (m_isAIOnClock && IsAITurn())
+	{
+		m_aiClockSeconds -= g_theGame->m_clock->GetDeltaSeconds();
+		m_aiClockSeconds = (m_aiClockSeconds > 0.0) ? m_aiClockSeconds : 0.0;
+	}
+
+	ChessSearchResult result;
+	while (m_ai->PopResult(result))
+	{
+		// the match may have moved on while the worker was busy
+		if (result.m_rootKey != m_position.m_key || !IsAITurn() || result.m_bestMove.IsNone())
+		{
+			continue;
+		}
+
+		char moveText[MAX_UCI_MOVE_LENGTH];
+		WriteUciMove(result.m_bestMove, moveText, MAX_UCI_MOVE_LENGTH);
+		if (result.m_isBookMove)
+		{
+			g_theDevConsole->AddText(DevConsole::INFO_MINOR, Stringf("ChessAI: %s from the opening book, clock %.1fs", moveText, m_aiClockSeconds));
+		}
+		else if (result.m_isTablebaseMove)
+		{
+			g_theDevConsole->AddText(DevConsole::INFO_MINOR, Stringf("ChessAI: %s from the tablebases, score %d, clock %.1fs", moveText, result.m_score, m_aiClockSeconds));
+		}
+		else
+		{
+			g_theDevConsole->AddText(DevConsole::INFO_MINOR, Stringf("ChessAI: %s, depth %d, score %d, %llu nodes in %.2fs, hashfull %d, clock %.1fs", moveText, result.m_depth,
+				result.m_score, result.m_nodes, result.m_seconds, result.m_hashfullPermille, m_aiClockSeconds));
+		}
+		g_theDevConsole->Execute(Stringf("ChessMove uci=%s", moveText));
+		if (m_isAIOnClock)
+		{
+			m_aiClockSeconds += m_aiIncrementSeconds;
+		}
+
+		// the second move of the line is the reply the search expects
+		if (!IsPlayingLocally() && result.m_pvLength >= 2 && g_gameConfigBlackboard.GetValue("aiPonder", false))
+		{
+			StartAIPondering(result.m_pv[1]);
+		}
+	}
+}
+
+ChessPolyglotBook const* ChessMatch::GetOpeningBook()
+{
+	if (!m_hasTriedOpeningBook)
+	{
+		m_hasTriedOpeningBook = true;
+		std::string bookPath = g_gameConfigBlackboard.GetValue("openingBook", "");
+		if (bookPath != "")
+		{
+			std::string errorMessage;
+			m_openingBook = new ChessPolyglotBook();
+			if (m_openingBook->Open(bookPath, errorMessage))
+			{
+				g_theDevConsole->AddText(DevConsole::INFO_MINOR, Stringf("Opening book %s, %llu entries", bookPath.c_str(), m_openingBook->GetNumEntries()));
+			}
+			else
+			{
+				g_theDevConsole->AddText(DevConsole::WARNING, Stringf("Opening book not loaded (%s)", errorMessage.c_str()));
+				delete m_openingBook;
+				m_openingBook = nullptr;
+			}
+		}
+	}
+	return m_openingBook;
+}
+
+ChessSyzygyTablebases const* ChessMatch::GetTablebases()
+{
+	if (!m_hasTriedTablebases)
+	{
+		m_hasTriedTablebases = true;
+		std::string syzygyPath = g_gameConfigBlackboard.GetValue("syzygyPath", "");
+		if (syzygyPath != "")
+		{
+			// only the directories are scanned here, each table is mapped when a probe first needs it
+			m_tablebases = new ChessSyzygyTablebases();
+			if (m_tablebases->Initialize(syzygyPath) > 0)
+			{
+				g_theDevConsole->AddText(DevConsole::INFO_MINOR, Stringf("Syzygy tablebases %s, %d tables up to %d pieces", syzygyPath.c_str(), m_tablebases->GetNumTables(),
+					m_tablebases->GetMaxPieces()));
+			}
+			else
+			{
+				g_theDevConsole->AddText(DevConsole::WARNING, Stringf("No Syzygy tablebases found in %s", syzygyPath.c_str()));
+				delete m_tablebases;
+				m_tablebases = nullptr;
+			}
+		}
+	}
+	return m_tablebases;
+}
+
+bool ChessMatch::Command_ChessBookMoves(EventArgs& args)
+{
+	UNUSED(args);
+
+	ChessMatch* match = g_theGame->GetMatch();
+	ChessPolyglotBook const* book = match->GetOpeningBook();
+	if (book == nullptr)
+	{
+		g_theDevConsole->AddText(DevConsole::ERROR, "No opening book! Set openingBook in GameConfig.xml to a Polyglot .bin file.");
+		return true;
+	}
+
+	ChessBookMove bookMoves[MAX_CHESS_BOOK_MOVES];
+	int numBookMoves = book->FindMoves(match->m_position, bookMoves, MAX_CHESS_BOOK_MOVES);
+	if (numBookMoves == 0)
+	{
+		g_theDevConsole->AddText(DevConsole::INFO_MAJOR, "The opening book has no moves for this position");
+		return true;
+	}
+
+	int totalWeight = 0;
+	for (int moveIndex = 0; moveIndex < numBookMoves; ++moveIndex)
+	{
+		totalWeight += bookMoves[moveIndex].m_weight;
+	}
+
+	ChessMoveList legalMoves;
+	match->GenerateLegalMoves(legalMoves);
+	g_theDevConsole->AddText(DevConsole::INFO_MAJOR, Stringf("%d book moves:", numBookMoves));
+	for (int moveIndex = 0; moveIndex < numBookMoves; ++moveIndex)
+	{
+		char sanText[MAX_SAN_MOVE_LENGTH];
+		WriteSanMove(match->m_position, bookMoves[moveIndex].m_move, legalMoves, sanText, MAX_SAN_MOVE_LENGTH);
+		g_theDevConsole->AddText(DevConsole::INFO_MINOR, Stringf("	%-8s weight %5d  %5.1f%%", sanText, bookMoves[moveIndex].m_weight,
+			100.0 * static_cast<double>(bookMoves[moveIndex].m_weight) / static_cast<double>(totalWeight)));
+	}
+	return true;
+}
+
+void ChessMatch::GetGameKeys(std::vector<uint64_t>& out_keys) const
+{
+	// nothing before the last capture or pawn move can repeat, the search only needs that far back
+	out_keys.clear();
+	int numRecords = static_cast<int>(m_moveHistory.size());
+	int firstIndex = numRecords - static_cast<int>(m_position.m_halfmoveClock);
+	for (int recordIndex = (firstIndex > 0) ? firstIndex : 0; recordIndex < numRecords; ++recordIndex)
+	{
+		out_keys.push_back(m_moveHistory[recordIndex].m_undo.m_key);
+	}
+}
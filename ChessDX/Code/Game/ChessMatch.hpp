@@ -1,13 +1,24 @@
 #pragma once
 #include "Game/GameCommon.hpp"
+#include "ChessCore/ChessPosition.hpp"
+#include "ChessCore/ChessSearch.hpp"
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Math/IntVec2.hpp"
 #include <vector>
 #include <string>
 
 
+class ChessAI;
+class ChessPolyglotBook;
+class ChessSyzygyTablebases;
 enum class ChessMoveResult;
 
+struct ChessMoveRecord
+{
+	ChessMove		m_move;
+	ChessUndoInfo	m_undo;
+};
+
 enum class MatchState
 {
 	DEFAULT, // enter default will reset the match
@@ -15,6 +26,11 @@ enum class MatchState
 	BLACK_MOVE,
 	WHITE_WIN,
 	BLACK_WIN,
+	DRAW_STALEMATE,
+	DRAW_THREEFOLD_REPETITION,
+	DRAW_FIFTY_MOVE_RULE,
+	DRAW_INSUFFICIENT_MATERIAL,
+	DRAW_TABLEBASE,
 };
 
 
@@ -25,6 +41,7 @@ public:
 	static IntVec2		GetBoardCoordsFromNotation(std::string const& notation); // not validate the input
 	static Vec3			GetSquareCenterFromBoardCoords(IntVec2 const& coords);
 	static int			GetPieceIndexFromBoardCoords(IntVec2 const& coords);
+	static IntVec2		GetBoardCoordsFromPieceIndex(int pieceIndex);
 	static IntVec2		GetBoardCoordsFromWorldPos(Vec3 const& worldPos);
 
 
@@ -38,8 +55,11 @@ public:
 
 	void InitializeBoard();
 	void InitializePieces();
+	void CreatePiecesFromPosition();
+	void SetPosition(ChessPosition const& position); // replaces the rules position and rebuilds the pieces, history is lost
 
 	void CleanBoardAndPieces();
+	void CleanPieces();
 
 	void StartNewMatch();
 
@@ -51,17 +71,32 @@ public:
 	void PrintBoardState() const;
 
 	//std::string TryToMoveChessPiece(IntVec2 fromCoords, IntVec2 toCoords);
-	ChessMoveResult TryToMoveChessPiece(IntVec2 fromCoords, IntVec2 toCoords, bool isTeleporting, PieceType promotionType = PieceType::UNKNOWN);
+	ChessMoveResult TryToMoveChessPiece(ChessMove const& move, bool isTeleporting);
 
 	// Helper function without check
-	void MovePiece(IntVec2 fromCoords, IntVec2 toCoords);
-	void CapturePiece(IntVec2 coords);
+	void CommitMove(ChessMove const& move);
+	void CommitTeleport(IntVec2 fromCoords, IntVec2 toCoords);
+	void SyncPiecesToCommittedMove(ChessMove const& move); // visual only
+	void MovePiece(IntVec2 fromCoords, IntVec2 toCoords); // visual only
+	void CapturePiece(IntVec2 coords); // visual only
 
 	int GetTurnNumber() const;
 
+	MatchState	GetStateAfterCommittedMove() const; // mate, draws, or the next side's turn
+	MatchState	AdjudicateWithTablebases(MatchState state); // a local game in a tablebase ending ends with its result
+	int			GetRepetitionCount() const; // times the current position has occurred, including now
+
 	bool IsSquareOccupied(IntVec2 coords) const;
-	bool IsSquareUnderAttack(IntVec2 coords, PlayerSide side) const;
+	bool IsSquareUnderAttack(IntVec2 coords, PlayerSide side) const; // attacked by side
+	void GenerateLegalMoves(ChessMoveList& moves) const; // for the side to move
+	void CacheLegalMoves(); // once per turn, the mouse UI reads the cache instead of regenerating
+	Bitboard GetLegalTargets(int fromSquare) const;
 public:
+	ChessPosition m_position; // rules state, pieces below are synced from it
+	std::vector<ChessMoveRecord> m_moveHistory; // committed moves, enough to unmake back to the start
+
+	ChessMoveList m_legalMoves; // for the side to move, rebuilt by CacheLegalMoves
+	Bitboard m_legalTargetsFromSquare[NUM_SQUARES] = {}; // to squares of m_legalMoves by from square
 
 	std::vector<ChessPiece*> m_piecesOnBoard; // size 64, do not push_back
 	std::vector<ChessPiece*> m_piecesCaught;
@@ -117,6 +152,11 @@ public:
 	static bool	Command_ChessMove(EventArgs& args); // remote
 	static bool Command_ChessResign(EventArgs& args); // remote
 	static bool Command_RemoteCmd(EventArgs& args); // local
+	static bool Command_ChessPerft(EventArgs& args); // local
+	static bool Command_ChessLoadFen(EventArgs& args); // remote
+	static bool Command_ChessFen(EventArgs& args); // local
+	static bool Command_ChessAI(EventArgs& args); // local
+	static bool Command_ChessBookMoves(EventArgs& args); // local
 
 
 	void ButtonChessConnect();
@@ -134,5 +174,34 @@ public:
 	std::string m_localPlayerName = "UNKNOWN";
 	std::string m_remotePlayerName = "UNKNOWN";
 	PlayerSide m_localPlayerSide = PLAYER_UNKNOWN;
+
+//-----------------------------------------------------------------------------------------------
+// Computer opponent
+public:
+	bool IsAITurn() const;
+	void StartAIThinking();
+	void StopAIThinking(); // the match is over or gone, whatever the worker is searching is no longer wanted
+	void StartAIPondering(ChessMove const& expectedReply); // networked matches, searches on the opponent's time
+	void ResolveAIPonder(); // the opponent's move is in, the ponder becomes the AI's search or is dropped
+	ChessSearchLimits GetAILimits() const; // the configured limits with the AI's clock as it stands
+	void UpdateAI(); // plays the worker's move once it is ready, never waits for it
+	void GetGameKeys(std::vector<uint64_t>& out_keys) const; // keys of the positions before the current one, oldest first
+	ChessPolyglotBook const* GetOpeningBook(); // opens the configured book on first use, nullptr when there is none
+	ChessSyzygyTablebases const* GetTablebases(); // scans the configured directories on first use, nullptr when they hold no tables
+
+public:
+	ChessAI* m_ai = nullptr; // created by the first ChessAI command
+	PlayerSide m_aiSide = PLAYER_UNKNOWN;
+	ChessSearchLimits m_aiLimits;
+	bool m_isAIOnClock = false;
+	double m_aiClockSeconds = 0.0; // AI's time left, charged by the game clock on its turns
+	double m_aiIncrementSeconds = 0.0;
+	bool m_isAIPondering = false;
+	ChessMove m_aiPonderMove = ChessMove::None(); // the reply the AI expects
+	uint64_t m_aiPonderHitKey = 0; // position the hit ponder is already searching, StartAIThinking leaves it alone
+	ChessPolyglotBook* m_openingBook = nullptr;
+	bool m_hasTriedOpeningBook = false; // a missing book is reported once, not on every lookup
+	ChessSyzygyTablebases* m_tablebases = nullptr;
+	bool m_hasTriedTablebases = false;
 };
 
@@ -2,10 +2,8 @@
 #include "Game/ChessPieceDefinition.hpp"
 #include "Game/Game.hpp"
 #include "Game/ChessMatch.hpp"
-#include "Game/ChessErrorCheck.hpp"
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Math/MathUtils.hpp"
-#include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/FloatRange.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/VertexBuffer.hpp"
@@ -126,233 +124,6 @@ void ChessPiece::SetAnimation(Vec3 const& startPos, Vec3 const& endPos, bool isJ
 	m_secondsSinceMoved = 0.f;
 }
 
-ChessMoveResult ChessPiece::TryToMove(IntVec2 fromCoords, IntVec2 toCoords, PieceType promotionType /*= PieceType::UNKNOWN*/)
-{
-	if (fromCoords == toCoords)
-	{
-		return ChessMoveResult::INVALID_MOVE_ZERO_DISTANCE;
-	}
-
-	int taxiCabLength = (toCoords - fromCoords).GetTaxicabLength();
-	bool hasNeverMoved = m_turnLastMoved < 0;
-	int forwardDirection = (m_playerSide == PlayerSide::PLAYER_WHITE) ? 1 : -1;
-	int endRank = (m_playerSide == PlayerSide::PLAYER_WHITE) ? 7 : 0;
-	int startRank = (m_playerSide == PlayerSide::PLAYER_WHITE) ? 0 : 7;
-
-	bool isForward = ((toCoords.y - fromCoords.y) * forwardDirection) > 0;
-	bool isAxial = ((toCoords.x - fromCoords.x) == 0) || ((toCoords.y - fromCoords.y) == 0);
-	bool isDiagonal = abs(fromCoords.x - toCoords.x) == abs(fromCoords.y - toCoords.y);
-	bool isBlocked = IsPathBlocked(fromCoords, toCoords);
-
-	if (m_definition->m_type == PieceType::KING)
-	{
-		IntVec2 delta = toCoords - fromCoords;
-		if (abs(delta.x) > 1 || abs(delta.y) > 1)
-		{
-			// Check castling
-			if (m_turnLastMoved >= 0 || fromCoords.y != startRank)
-			{
-				return ChessMoveResult::INVALID_CASTLE_KING_HAS_MOVED;
-			}
-			if (delta.y != 0 || abs(delta.x) != 2)
-			{
-				return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
-			}
-			if (m_match->IsSquareUnderAttack(fromCoords, GetOpponentPlayerSide()))
-			{
-				return ChessMoveResult::INVALID_CASTLE_OUT_OF_CHECK;
-			}
-
-			IntVec2 rookCoords = IntVec2((delta.x > 0) ? 7 : 0, startRank);
-			ChessPiece* rookPiece = m_match->m_piecesOnBoard[m_match->GetPieceIndexFromBoardCoords(rookCoords)];
-			if (rookPiece == nullptr)
-			{
-				return ChessMoveResult::INVALID_CASTLE_ROOK_HAS_MOVED;
-			}
-			if (rookPiece->m_playerSide != m_playerSide || rookPiece->m_definition->m_type != PieceType::ROOK || rookPiece->m_turnLastMoved >= 0)
-			{
-				return ChessMoveResult::INVALID_CASTLE_ROOK_HAS_MOVED;
-			}
-			IntVec2 step = IntVec2((delta.x > 0) ? 1 : -1, 0);
-			IntVec2 tempCoords = fromCoords + step;
-			while (tempCoords != rookCoords)
-			{
-				if (m_match->IsSquareOccupied(tempCoords))
-				{
-					return ChessMoveResult::INVALID_CASTLE_PATH_BLOCKED;
-				}
-
-				tempCoords = tempCoords + step;
-			}
-
-			if (m_match->IsSquareUnderAttack(fromCoords + step, GetOpponentPlayerSide()) || m_match->IsSquareUnderAttack(fromCoords + step + step, GetOpponentPlayerSide()))
-			{
-				return ChessMoveResult::INVALID_CASTLE_THROUGH_CHECK;
-			}
-			
-			m_match->MovePiece(fromCoords, fromCoords + step + step);
-			m_match->MovePiece(rookCoords, fromCoords + step);
-			//m_turnLastMoved = m_match->GetTurnNumber();
-			//rookPiece->m_turnLastMoved = m_match->GetTurnNumber();
-			if (delta.x > 0)
-			{
-				return ChessMoveResult::VALID_CASTLE_KINGSIDE;
-			}
-			else
-			{
-				return ChessMoveResult::VALID_CASTLE_QUEENSIDE;
-			}
-		}
-		if (m_match->IsSquareUnderAttack(toCoords, GetOpponentPlayerSide()))
-		{
-			return ChessMoveResult::INVALID_MOVE_ENDS_IN_CHECK;
-		}
-		m_match->MovePiece(fromCoords, toCoords);
-		//m_turnLastMoved = m_match->GetTurnNumber();
-		return ChessMoveResult::VALID_MOVE_NORMAL;
-	}
-	else if (m_definition->m_type == PieceType::QUEEN)
-	{
-		if (!isAxial && !isDiagonal)
-		{
-			return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
-		}
-		if (isBlocked)
-		{
-			return ChessMoveResult::INVALID_MOVE_PATH_BLOCKED;
-		}
-		m_match->MovePiece(fromCoords, toCoords);
-		//m_turnLastMoved = m_match->GetTurnNumber();
-		return ChessMoveResult::VALID_MOVE_NORMAL;
-	}
-	else if (m_definition->m_type == PieceType::ROOK)
-	{
-		if (!isAxial)
-		{
-			return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
-		}
-		if (isBlocked)
-		{
-			return ChessMoveResult::INVALID_MOVE_PATH_BLOCKED;
-		}
-		m_match->MovePiece(fromCoords, toCoords);
-		//m_turnLastMoved = m_match->GetTurnNumber();
-		return ChessMoveResult::VALID_MOVE_NORMAL;
-	}
-	else if (m_definition->m_type == PieceType::BISHOP)
-	{
-		if (!isDiagonal)
-		{
-			return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
-		}
-		if (isBlocked)
-		{
-			return ChessMoveResult::INVALID_MOVE_PATH_BLOCKED;
-		}
-		m_match->MovePiece(fromCoords, toCoords);
-		//m_turnLastMoved = m_match->GetTurnNumber();
-		return ChessMoveResult::VALID_MOVE_NORMAL;
-	}
-	else if (m_definition->m_type == PieceType::KNIGHT)
-	{
-		if (taxiCabLength != 3)
-		{
-			return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
-		}
-		m_match->MovePiece(fromCoords, toCoords);
-		//m_turnLastMoved = m_match->GetTurnNumber();
-		return ChessMoveResult::VALID_MOVE_NORMAL;
-	}
-	else if (m_definition->m_type == PieceType::PAWN)
-	{
-		// pawn must go forward
-		if (!isForward)
-		{
-			return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
-		}
-		IntVec2 delta = toCoords - fromCoords;
-		int x = GetIntSign(toCoords.x - fromCoords.x);
-		int y = GetIntSign(toCoords.y - fromCoords.y);
-		IntVec2 step = IntVec2(x, y);
-		if (delta.x == 0)
-		{
-			// Move Forward
-			int forwardY = abs(delta.y);
-			if (forwardY == 0 || forwardY > 2)
-			{
-				return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
-			}
-			if (forwardY == 2)
-			{
-				if (!hasNeverMoved)
-				{
-					return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
-				}
-
-				if (m_match->IsSquareOccupied(fromCoords + step))
-				{
-					return ChessMoveResult::INVALID_MOVE_PATH_BLOCKED;
-				}
-			}
-			if (m_match->IsSquareOccupied(toCoords))
-			{
-				return ChessMoveResult::INVALID_MOVE_DESTINATION_BLOCKED;
-			}
-			// Then you can move
-		}
-		else
-		{
-			// Move Diagonal
-			if (abs(delta.x) != 1 || abs(delta.y) != 1)
-			{
-				return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
-			}
-			if (!m_match->IsSquareOccupied(fromCoords + step))
-			{
-				// Check en passant
-				int enpassantRank = (m_playerSide == PlayerSide::PLAYER_WHITE) ? 4 : 3;
-				if (enpassantRank != fromCoords.y)
-				{
-					return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
-				}
-				IntVec2 capturedCoords = fromCoords + IntVec2(delta.x, 0);
-				ChessPiece* capturedPiece = m_match->m_piecesOnBoard[m_match->GetPieceIndexFromBoardCoords(capturedCoords)];
-				if (capturedPiece == nullptr)
-				{
-					return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
-				}
-				if (capturedPiece->m_definition->m_type != PieceType::PAWN || capturedPiece->m_playerSide == m_playerSide)
-				{
-					// not pawn, not opponent
-					return ChessMoveResult::INVALID_MOVE_WRONG_MOVE_SHAPE;
-				}
-				if (capturedPiece->m_turnLastMoved != (m_match->GetTurnNumber() - 1))
-				{
-					return ChessMoveResult::INVALID_ENPASSANT_STALE;
-				}
-				m_match->CapturePiece(capturedCoords);
-			}
-
-		}
-		// Check Promotion type
-		if (toCoords.y == endRank)
-		{
-			if (promotionType != PieceType::QUEEN && promotionType != PieceType::BISHOP && promotionType != PieceType::ROOK && promotionType != PieceType::KNIGHT)
-			{
-				return ChessMoveResult::INVALID_MOVE_PAWN_WRONG_PROMOTION;
-			}
-			LoadByType(promotionType);
-		}
-
-		m_match->MovePiece(fromCoords, toCoords);
-		//m_turnLastMoved = m_match->GetTurnNumber();
-		return ChessMoveResult::VALID_MOVE_NORMAL;
-
-	}
-
-	return ChessMoveResult::UNKNOWN;
-}
-
 void ChessPiece::GetZCylinderCollider(Vec2& out_centerXY, FloatRange& out_minMaxZ, float& out_radiusXY) const
 {
 	out_centerXY = Vec2(m_position.x, m_position.y);
@@ -360,37 +131,6 @@ void ChessPiece::GetZCylinderCollider(Vec2& out_centerXY, FloatRange& out_minMax
 	out_radiusXY = m_definition->m_colliderRadius;
 }
 
-bool ChessPiece::IsPathBlocked(IntVec2 fromCoords, IntVec2 toCoords)
-{
-	bool isAxial = ((toCoords.x - fromCoords.x) == 0) || ((toCoords.y - fromCoords.y) == 0);
-	bool isDiagonal = abs(fromCoords.x - toCoords.x) == abs(fromCoords.y - toCoords.y);
-	if (!isAxial && !isDiagonal)
-	{
-		return false;
-	}
-
-	int x = GetIntSign(toCoords.x - fromCoords.x);
-	int y = GetIntSign(toCoords.y - fromCoords.y);
-	IntVec2 step = IntVec2(x, y);
-	IntVec2 tempPos = fromCoords + step;
-	int tries = 0;
-	while (tempPos != toCoords)
-	{
-		if (m_match->IsSquareOccupied(tempPos))
-		{
-			return true;
-		}
-
-		tempPos = tempPos + step;
-		tries++;
-		if (tries > 15)
-		{
-			ERROR_AND_DIE("Infinite loops");
-		}
-	}
-	return false;
-}
-
 void ChessPiece::LoadByType(PieceType type)
 {
 	m_definition = ChessPieceDefinition::GetByType(type);
@@ -400,8 +140,3 @@ void ChessPiece::LoadByType(PieceType type)
 	m_normalTexture = m_definition->m_normalTextureByPlayer[m_playerSide];
 	m_sgeTexture = m_definition->m_sgeTextureByPlayer[m_playerSide];
 }
-
-PlayerSide ChessPiece::GetOpponentPlayerSide() const
-{
-	return (m_playerSide == PlayerSide::PLAYER_WHITE) ? PlayerSide::PLAYER_BLACK : PlayerSide::PLAYER_WHITE;
-}
@@ -3,7 +3,6 @@
 
 
 class ChessBoard;
-enum class ChessMoveResult;
 
 class ChessPiece : public ChessObject
 {
@@ -17,8 +16,7 @@ public:
 	void UpdatePosition();
 
 	void SetAnimation(Vec3 const& startPos, Vec3 const& endPos, bool isJumping);
-
-	ChessMoveResult TryToMove(IntVec2 fromCoords, IntVec2 toCoords, PieceType promotionType = PieceType::UNKNOWN);
+	void LoadByType(PieceType type);
 
 	void GetZCylinderCollider(Vec2& out_centerXY, FloatRange& out_minMaxZ, float& out_radiusXY) const;
 
@@ -35,10 +33,5 @@ public:
 	Vec3 m_endPosition;
 	float m_secondsSinceMoved = 0.f;
 	bool m_isJumping = false; // Animation type
-
-private:
-	bool IsPathBlocked(IntVec2 fromCoords, IntVec2 toCoords);
-	void LoadByType(PieceType type);
-	PlayerSide GetOpponentPlayerSide() const;
 };
 
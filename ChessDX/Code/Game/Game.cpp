@@ -3,6 +3,7 @@
 #include "Game/Player.hpp"
 #include "Game/ChessMatch.hpp"
 #include "Game/ChessPieceDefinition.hpp"
+#include "ChessCore/ChessAttacks.hpp"
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/DebugRender.hpp"
 #include "Engine/Core/DevConsole.hpp"
@@ -38,6 +39,7 @@ Game::Game()
 {
 	m_clock = new Clock();
 	m_playerController = new Player();
+	InitializeChessAttackTables();
 	ChessPieceDefinition::InitializeDefinitions();
 	
 	m_diffuseShader = g_theRenderer->CreateOrGetShader(ShaderConfig("Data/Shaders/Diffuse"), VertexType::VERTEX_PCUTBN);
@@ -308,6 +310,21 @@ void Game::DebugDrawUpdate()
 		case MatchState::BLACK_WIN:
 			stateStr = "Black wins";
 			break;
+		case MatchState::DRAW_STALEMATE:
+			stateStr = "Draw (stalemate)";
+			break;
+		case MatchState::DRAW_THREEFOLD_REPETITION:
+			stateStr = "Draw (repetition)";
+			break;
+		case MatchState::DRAW_FIFTY_MOVE_RULE:
+			stateStr = "Draw (fifty-move rule)";
+			break;
+		case MatchState::DRAW_INSUFFICIENT_MATERIAL:
+			stateStr = "Draw (insufficient material)";
+			break;
+		case MatchState::DRAW_TABLEBASE:
+			stateStr = "Draw (tablebase)";
+			break;
 		default:
 			break;
 		}
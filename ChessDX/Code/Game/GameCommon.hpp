@@ -1,5 +1,6 @@
 #pragma once
 #include "Engine/Core/EngineCommon.hpp"
+#include "ChessCore/ChessTypes.hpp"
 
 //-----------------------------------------------------------------------------------------------
 class AudioSystem;
@@ -57,26 +58,6 @@ constexpr float CHESS_BOARD_THINKNESS = 0.4f;
 constexpr float	CHESS_MOVE_DURATION = 1.f;
 constexpr float CHESS_JUMP_HEIGHT = 1.f;
 //-----------------------------------------------------------------------------------------------
-enum PlayerSide
-{
-	PLAYER_UNKNOWN = -1,
-	PLAYER_WHITE, // White goes first
-	PLAYER_BLACK,
-	PLAYER_SIDE_NUM
-};
-
-enum class PieceType
-{
-	UNKNOWN = -1,
-	KING,	// K
-	QUEEN,	// Q
-	ROOK,	// R
-	BISHOP, // B
-	KNIGHT, // N
-	PAWN,	// P
-	NUM
-};
-
 int GetIntSign(int value);
 
 bool IsPlayingLocally();